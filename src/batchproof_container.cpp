@@ -1,6 +1,6 @@
 #include "batchproof_container.h"
 #include "liblelantus/sigmaextended_verifier.h"
-#include "liblelantus/threadpool.h"
+#include "proofthreadpool.h"
 #include "liblelantus/range_verifier.h"
 #include "sigma/sigmaplus_verifier.h"
 #include "sigma.h"
@@ -9,6 +9,14 @@
 
 std::unique_ptr<BatchProofContainer> BatchProofContainer::instance;
 
+void StartProofThreads(int nThreads) {
+    ProofThreadPool::GetInstance().Start(nThreads);
+}
+
+void StopProofThreads() {
+    ProofThreadPool::GetInstance().Stop();
+}
+
 BatchProofContainer* BatchProofContainer::get_instance() {
     if (instance) {
         return instance.get();
@@ -22,6 +30,9 @@ void BatchProofContainer::init() {
     tempSigmaProofs.clear();
     tempLelantusSigmaProofs.clear();
     tempRangeProofs.clear();
+    // checks left by a block which failed to connect, the tasks own everything they use
+    deferredChecks.clear();
+    fDeferredCheckFailed = false;
 }
 
 void BatchProofContainer::finalize() {
@@ -39,6 +50,7 @@ void BatchProofContainer::finalize() {
         }
     }
     fCollectProofs = false;
+    fDeferProofs = false;
 }
 
 void BatchProofContainer::verify() {
@@ -50,7 +62,7 @@ void BatchProofContainer::verify() {
     fCollectProofs = false;
 }
 
-void BatchProofContainer::add(sigma::CoinSpend* spend,
+void BatchProofContainer::add(const sigma::CoinSpend* spend,
                               bool fPadding,
                               int group_id,
                               size_t setSize,
@@ -60,7 +72,7 @@ void BatchProofContainer::add(sigma::CoinSpend* spend,
     tempSigmaProofs[denominationAndId].push_back(SigmaProofData(spend->getProof(), spend->getCoinSerialNumber(), fPadding, setSize));
 }
 
-void BatchProofContainer::add(lelantus::JoinSplit* joinSplit,
+void BatchProofContainer::add(const lelantus::JoinSplit* joinSplit,
                               const std::map<uint32_t, size_t>& setSizes,
                               const Scalar& challenge,
                               bool fStartLelantusBlacklist) {
@@ -82,7 +94,7 @@ void BatchProofContainer::add(lelantus::JoinSplit* joinSplit,
 }
 
 
-void BatchProofContainer::add(lelantus::JoinSplit* joinSplit, const std::vector<lelantus::PublicCoin>& Cout) {
+void BatchProofContainer::add(const lelantus::JoinSplit* joinSplit, const std::vector<lelantus::PublicCoin>& Cout) {
     tempRangeProofs[joinSplit->getVersion()].push_back(std::make_pair(joinSplit->getLelantusProof().bulletproofs, Cout));
 }
 
@@ -167,69 +179,61 @@ void BatchProofContainer::batch_sigma() {
         return;
 
     DoNotDisturb dnd;
-    std::size_t threadsMaxCount = std::min((unsigned int)sigmaProofs.size(), boost::thread::hardware_concurrency());
-    std::vector<boost::future<bool>> parallelTasks;
-    parallelTasks.reserve(threadsMaxCount);
-    ParallelOpThreadPool<bool> threadPool(threadsMaxCount);
+    ProofThreadPool& threadPool = ProofThreadPool::GetInstance();
+    std::vector<std::future<bool>> parallelTasks;
+    parallelTasks.reserve(sigmaProofs.size());
 
     auto params = sigma::Params::get_default();
     sigma::SigmaPlusVerifier<Scalar, GroupElement> sigmaVerifier(params->get_g(), params->get_h(), params->get_n(), params->get_m());
 
-    auto itr = sigmaProofs.begin();
-    for (std::size_t j = 0; j < sigmaProofs.size(); j += threadsMaxCount) {
-        for (std::size_t i = j; i < j + threadsMaxCount; ++i) {
-            if (i < sigmaProofs.size()) {
-                std::vector<GroupElement> anonymity_set;
-                sigma::CSigmaState* sigmaState = sigma::CSigmaState::GetState();
-                sigmaState->GetAnonymitySet(
-                        itr->first.first,
-                        itr->first.second.first,
-                        itr->first.second.second,
-                        anonymity_set);
-
-                size_t m = itr->second.size();
-                std::vector<Scalar> serials;
-                serials.reserve(m);
-                std::vector<bool> fPadding;
-                fPadding.reserve(m);
-                std::vector<size_t> setSizes;
-                setSizes.reserve(m);
-                std::vector<sigma::SigmaPlusProof<Scalar, GroupElement>> proofs;
-                proofs.reserve(m);
-
-                for (auto& proofData : itr->second) {
-                    serials.emplace_back(proofData.coinSerialNumber);
-                    fPadding.emplace_back(proofData.fPadding);
-                    setSizes.emplace_back(proofData.anonymitySetSize);
-                    proofs.emplace_back(proofData.sigmaProof);
-                }
-
-                parallelTasks.emplace_back(threadPool.PostTask([=]() {
-                    try {
-                        if (!sigmaVerifier.batch_verify(anonymity_set, serials, fPadding, setSizes, proofs))
-                            return false;
-                    } catch (...) {
-                        return false;
-                    }
-                    return true;
-                }));
+    for (const auto& itr : sigmaProofs) {
+        std::vector<GroupElement> anonymity_set;
+        sigma::CSigmaState* sigmaState = sigma::CSigmaState::GetState();
+        sigmaState->GetAnonymitySet(
+                itr.first.first,
+                itr.first.second.first,
+                itr.first.second.second,
+                anonymity_set);
+
+        size_t m = itr.second.size();
+        std::vector<Scalar> serials;
+        serials.reserve(m);
+        std::vector<bool> fPadding;
+        fPadding.reserve(m);
+        std::vector<size_t> setSizes;
+        setSizes.reserve(m);
+        std::vector<sigma::SigmaPlusProof<Scalar, GroupElement>> proofs;
+        proofs.reserve(m);
+
+        for (auto& proofData : itr.second) {
+            serials.emplace_back(proofData.coinSerialNumber);
+            fPadding.emplace_back(proofData.fPadding);
+            setSizes.emplace_back(proofData.anonymitySetSize);
+            proofs.emplace_back(proofData.sigmaProof);
+        }
 
-                ++itr;
+        parallelTasks.emplace_back(threadPool.PostTask([=]() {
+            try {
+                if (!sigmaVerifier.batch_verify(anonymity_set, serials, fPadding, setSizes, proofs))
+                    return false;
+            } catch (...) {
+                return false;
             }
-        }
+            return true;
+        }));
+    }
 
-        bool isFail = false;
-        for (auto& th : parallelTasks) {
-            if (!th.get())
-                isFail = true;
-        }
-        if (isFail) {
-            LogPrintf("Sigma batch verification failed.");
-            throw std::invalid_argument(
-                    "Sigma batch verification failed, please run Firo with -reindex -batching=0");
-        }
-        parallelTasks.clear();
+    bool isFail = false;
+    for (auto& th : parallelTasks) {
+        if (!threadPool.WaitFor(th))
+            isFail = true;
     }
+    if (isFail) {
+        LogPrintf("Sigma batch verification failed.");
+        throw std::invalid_argument(
+                "Sigma batch verification failed, please run Firo with -reindex -batching=0");
+    }
+
     if (!sigmaProofs.empty())
         LogPrintf("Sigma batch verification finished successfully.\n");
     sigmaProofs.clear();
@@ -243,99 +247,91 @@ void BatchProofContainer::batch_lelantus() {
     else
         return;
 
+    if (!verify_lelantus()) {
+        LogPrintf("Lelantus batch verification failed.");
+        throw std::invalid_argument("Lelantus batch verification failed, please run Firo with -reindex -batching=0");
+    }
+
+    LogPrintf("Lelantus batch verification finished successfully.\n");
+    lelantusSigmaProofs.clear();
+}
+
+bool BatchProofContainer::verify_lelantus() {
     auto params = lelantus::Params::get_default();
 
     DoNotDisturb dnd;
-    std::size_t threadsMaxCount = std::min((unsigned int)lelantusSigmaProofs.size(), boost::thread::hardware_concurrency());
-    std::vector<boost::future<bool>> parallelTasks;
-    parallelTasks.reserve(threadsMaxCount);
-    ParallelOpThreadPool<bool> threadPool(threadsMaxCount);
-    auto itr = lelantusSigmaProofs.begin();
+    ProofThreadPool& threadPool = ProofThreadPool::GetInstance();
+    std::vector<std::future<bool>> parallelTasks;
+    parallelTasks.reserve(lelantusSigmaProofs.size());
 
     lelantus::SigmaExtendedVerifier sigmaVerifier(params->get_g(), params->get_sigma_h(), params->get_sigma_n(),
                                                   params->get_sigma_m());
-    for (std::size_t j = 0; j < lelantusSigmaProofs.size(); j += threadsMaxCount) {
-        for (std::size_t i = j; i < j + threadsMaxCount; ++i) {
-            if (i < lelantusSigmaProofs.size()) {
-                std::vector<GroupElement> anonymity_set;
-                if (!itr->first.second) {
-                    lelantus::CLelantusState* state = lelantus::CLelantusState::GetState();
-                    std::vector<lelantus::PublicCoin> coins;
-                    state->GetAnonymitySet(
-                            itr->first.first.first,
-                            itr->first.first.second,
-                            coins);
-                    anonymity_set.reserve(coins.size());
-                    for (auto& coin : coins)
-                        anonymity_set.emplace_back(coin.getValue());
-                } else {
-                    int coinGroupId = itr->first.first.first % (CENT / 1000);
-                    int64_t intDenom = (itr->first.first.first - coinGroupId);
-                    intDenom *= 1000;
-                    sigma::CoinDenomination denomination;
-                    sigma::IntegerToDenomination(intDenom, denomination);
-
-                    std::vector<GroupElement> coins;
-                    sigma::CSigmaState* sigmaState = sigma::CSigmaState::GetState();
-                    sigmaState->GetAnonymitySet(
-                            denomination,
-                            coinGroupId,
-                            true,
-                            coins);
-
-                    anonymity_set.reserve(coins.size());
-                    for (auto& coin : coins)
-                        anonymity_set.emplace_back(coin + params->get_h1() * intDenom);
-                }
-
-                size_t m = itr->second.size();
-                std::vector<Scalar> serials;
-                serials.reserve(m);
-                std::vector<size_t> setSizes;
-                setSizes.reserve(m);
-                std::vector<lelantus::SigmaExtendedProof> proofs;
-                proofs.reserve(m);
-                std::vector<Scalar> challenges;
-                challenges.reserve(m);
-
-                for (auto& proofData : itr->second) {
-                    serials.emplace_back(proofData.serialNumber);
-                    setSizes.emplace_back(proofData.anonymitySetSize);
-                    proofs.emplace_back(proofData.lelantusSigmaProof);
-                    challenges.emplace_back(proofData.challenge);
-                }
-
-
-
-                parallelTasks.emplace_back(threadPool.PostTask([=]() {
-                    try {
-                        if (!sigmaVerifier.batchverify(anonymity_set, challenges, serials, setSizes, proofs))
-                            return false;
-                    } catch (...) {
-                        return false;
-                    }
-                    return true;
-                }));
-                
-                ++itr;
-            }
-        }
-        bool isFail = false;
-        for (auto& th : parallelTasks) {
-            if (!th.get())
-                isFail = true;
+    for (const auto& itr : lelantusSigmaProofs) {
+        std::vector<GroupElement> anonymity_set;
+        if (!itr.first.second) {
+            lelantus::CLelantusState* state = lelantus::CLelantusState::GetState();
+            std::vector<lelantus::PublicCoin> coins;
+            state->GetAnonymitySet(
+                    itr.first.first.first,
+                    itr.first.first.second,
+                    coins);
+            anonymity_set.reserve(coins.size());
+            for (auto& coin : coins)
+                anonymity_set.emplace_back(coin.getValue());
+        } else {
+            int coinGroupId = itr.first.first.first % (CENT / 1000);
+            int64_t intDenom = (itr.first.first.first - coinGroupId);
+            intDenom *= 1000;
+            sigma::CoinDenomination denomination;
+            sigma::IntegerToDenomination(intDenom, denomination);
+
+            std::vector<lelantus::PublicCoin> coins;
+            sigma::CSigmaState* sigmaState = sigma::CSigmaState::GetState();
+            sigmaState->GetConvertedAnonymitySet(
+                    denomination,
+                    coinGroupId,
+                    true,
+                    coins);
+
+            anonymity_set.reserve(coins.size());
+            for (auto& coin : coins)
+                anonymity_set.emplace_back(coin.getValue());
         }
 
-        if (isFail) {
-            LogPrintf("Lelantus batch verification failed.");
-            throw std::invalid_argument("Lelantus batch verification failed, please run Firo with -reindex -batching=0");
+        size_t m = itr.second.size();
+        std::vector<Scalar> serials;
+        serials.reserve(m);
+        std::vector<size_t> setSizes;
+        setSizes.reserve(m);
+        std::vector<lelantus::SigmaExtendedProof> proofs;
+        proofs.reserve(m);
+        std::vector<Scalar> challenges;
+        challenges.reserve(m);
+
+        for (auto& proofData : itr.second) {
+            serials.emplace_back(proofData.serialNumber);
+            setSizes.emplace_back(proofData.anonymitySetSize);
+            proofs.emplace_back(proofData.lelantusSigmaProof);
+            challenges.emplace_back(proofData.challenge);
         }
 
-        parallelTasks.clear();
+        parallelTasks.emplace_back(threadPool.PostTask([=]() {
+            try {
+                if (!sigmaVerifier.batchverify(anonymity_set, challenges, serials, setSizes, proofs))
+                    return false;
+            } catch (...) {
+                return false;
+            }
+            return true;
+        }));
     }
-    if (!lelantusSigmaProofs.empty())
-        LogPrintf("Lelantus batch verification finished successfully.\n");
-    lelantusSigmaProofs.clear();
+
+    bool isFail = false;
+    for (auto& th : parallelTasks) {
+        if (!threadPool.WaitFor(th))
+            isFail = true;
+    }
+    return !isFail;
 }
 
 void BatchProofContainer::batch_rangeProofs() {
@@ -344,7 +340,27 @@ void BatchProofContainer::batch_rangeProofs() {
         uiInterface.UpdateProgressBarLabel("Batch verifying Range Proofs...");
     }
 
+    if (!verify_rangeProofs()) {
+        LogPrintf("RangeProof batch verification failed.\n");
+        throw std::invalid_argument("RangeProof batch verification failed, please run Firo with -reindex -batching=0");
+    }
+
+    if (!rangeProofs.empty())
+        LogPrintf("RangeProof batch verification finished successfully.\n");
+
+    rangeProofs.clear();
+}
+
+bool BatchProofContainer::verify_rangeProofs() {
+    if (rangeProofs.empty())
+        return true;
+
+    int64_t nTimeStart = GetTimeMicros();
+    std::size_t nProofs = 0;
+
+    // proofs of all versions are folded into a single multiexponentiation
     auto params = lelantus::Params::get_default();
+    lelantus::RangeProofBatch batch;
     for (const auto& itr : rangeProofs) {
         lelantus::RangeVerifier  rangeVerifier(params->get_h1(), params->get_h0(), params->get_g(), params->get_bulletproofs_g(), params->get_bulletproofs_h(), params->get_bulletproofs_n(), itr.first);
         std::vector<std::vector<GroupElement>> V;
@@ -376,14 +392,62 @@ void BatchProofContainer::batch_rangeProofs() {
                 V[i].push_back(GroupElement());
         }
 
-        if (!rangeVerifier.verify(V, commitments, proofs)) {
-            LogPrintf("RangeProof batch verification failed.\n");
-            throw std::invalid_argument("RangeProof batch verification failed, please run Firo with -reindex -batching=0");
-        }
+        if (!rangeVerifier.add_to_batch(V, commitments, proofs, batch))
+            return false;
+        nProofs += proofSize;
     }
 
-    if (!rangeProofs.empty())
-        LogPrintf("RangeProof batch verification finished successfully.\n");
+    // the generators are the same for every version
+    lelantus::RangeVerifier rangeVerifier(params->get_h1(), params->get_h0(), params->get_g(), params->get_bulletproofs_g(), params->get_bulletproofs_h(), params->get_bulletproofs_n(), rangeProofs.rbegin()->first);
+    bool fValid = rangeVerifier.verify_batch(batch);
 
+    int64_t nTime = GetTimeMicros() - nTimeStart;
+    LogPrint("bench", "RangeProof batch of %d proofs verified in %.2fms (%.2f proofs/s)\n", nProofs, nTime * 0.001, nProofs * 1000000.0 / std::max<int64_t>(nTime, 1));
+    return fValid;
+}
+
+bool BatchProofContainer::verify_joinsplits() {
+    bool fValid = false;
+    try {
+        fValid = verify_lelantus() && verify_rangeProofs();
+    } catch (...) {
+        fValid = false;
+    }
+
+    lelantusSigmaProofs.clear();
     rangeProofs.clear();
+    return fValid;
+}
+
+void BatchProofContainer::defer(std::function<bool()> check) {
+    ProofThreadPool& threadPool = ProofThreadPool::GetInstance();
+
+    // every queued check holds its anonymity sets, so don't run too far ahead of the proof threads
+    std::size_t maxDeferred = std::max<std::size_t>(2 * threadPool.GetNumberOfThreads(), 2);
+    while (deferredChecks.size() >= maxDeferred) {
+        if (!threadPool.WaitFor(deferredChecks.front()))
+            fDeferredCheckFailed = true;
+        deferredChecks.pop_front();
+    }
+
+    deferredChecks.emplace_back(threadPool.PostTask([check]() {
+        try {
+            return check();
+        } catch (...) {
+            return false;
+        }
+    }));
+}
+
+bool BatchProofContainer::wait_deferred() {
+    ProofThreadPool& threadPool = ProofThreadPool::GetInstance();
+    for (auto& check : deferredChecks) {
+        if (!threadPool.WaitFor(check))
+            fDeferredCheckFailed = true;
+    }
+
+    bool fValid = !fDeferredCheckFailed;
+    deferredChecks.clear();
+    fDeferredCheckFailed = false;
+    return fValid;
 }
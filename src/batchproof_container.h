@@ -1,6 +1,9 @@
 #ifndef FIRO_BATCHPROOF_CONTAINER_H
 #define FIRO_BATCHPROOF_CONTAINER_H
 
+#include <deque>
+#include <functional>
+#include <future>
 #include <memory>
 #include "chain.h"
 #include "sigma/coinspend.h"
@@ -51,18 +54,18 @@ public:
 
     void verify();
 
-    void add(sigma::CoinSpend* spend,
+    void add(const sigma::CoinSpend* spend,
              bool fPadding,
              int group_id,
              size_t setSize,
              bool fStartSigmaBlacklist);
 
-    void add(lelantus::JoinSplit* joinSplit,
+    void add(const lelantus::JoinSplit* joinSplit,
              const std::map<uint32_t, size_t>& setSizes,
              const Scalar& challenge,
              bool fStartLelantusBlacklist);
 
-    void add(lelantus::JoinSplit* joinSplit, const std::vector<lelantus::PublicCoin>& Cout);
+    void add(const lelantus::JoinSplit* joinSplit, const std::vector<lelantus::PublicCoin>& Cout);
 
     void removeSigma(const sigma::spend_info_container& spendSerials);
     void removeLelantus(std::unordered_map<Scalar, int> spentSerials);
@@ -73,8 +76,22 @@ public:
     void batch_lelantus();
     void batch_rangeProofs();
 
+    // Verify the collected Lelantus proofs and drop them, returns false instead of throwing if any is invalid
+    bool verify_joinsplits();
+
+    // Queue a proof check on the proof threads, used while connecting a block at the tip when fDeferProofs is set
+    void defer(std::function<bool()> check);
+    // Wait for the deferred checks, returns false if any of them failed
+    bool wait_deferred();
+
 public:
     bool fCollectProofs = 0;
+    // verify proofs in parallel with the rest of the block connection instead of one after another
+    bool fDeferProofs = 0;
+
+private:
+    bool verify_lelantus();
+    bool verify_rangeProofs();
 
 private:
     static std::unique_ptr<BatchProofContainer> instance;
@@ -91,6 +108,14 @@ private:
     std::map<std::pair<std::pair<uint32_t, bool>, bool>, std::vector<LelantusSigmaProofData>> lelantusSigmaProofs;
     std::map<unsigned int, std::vector<std::pair<lelantus::RangeProof, std::vector<lelantus::PublicCoin>>>> rangeProofs;
 
+    // checks queued by defer() and not waited for yet
+    std::deque<std::future<bool>> deferredChecks;
+    bool fDeferredCheckFailed = false;
 };
 
+/** Start the shared proof verification thread pool (see ProofThreadPool) */
+void StartProofThreads(int nThreads);
+/** Finish queued proof verification tasks and stop the pool */
+void StopProofThreads();
+
 #endif //FIRO_BATCHPROOF_CONTAINER_H
@@ -0,0 +1,351 @@
+#include "bench.h"
+
+#include "liblelantus/challenge_generator_impl.h"
+#include "liblelantus/innerproduct_proof_generator.h"
+#include "liblelantus/innerproduct_proof_verifier.h"
+#include "liblelantus/lelantus_prover.h"
+#include "liblelantus/lelantus_verifier.h"
+#include "liblelantus/range_prover.h"
+#include "liblelantus/range_verifier.h"
+#include "liblelantus/schnorr_prover.h"
+#include "liblelantus/schnorr_verifier.h"
+#include "liblelantus/sigmaextended_prover.h"
+#include "liblelantus/sigmaextended_verifier.h"
+
+#include <map>
+#include <memory>
+
+using namespace lelantus;
+
+namespace {
+
+// number of proofs verified together by the batch benchmarks
+const std::size_t BATCH_SIZE = 10;
+
+std::vector<GroupElement> RandomGroupElements(std::size_t size)
+{
+    std::vector<GroupElement> result(size);
+    for (auto& e : result)
+        e.randomize();
+    return result;
+}
+
+std::vector<Scalar> RandomScalars(std::size_t size)
+{
+    std::vector<Scalar> result(size);
+    for (auto& s : result)
+        s.randomize();
+    return result;
+}
+
+std::unique_ptr<ChallengeGenerator> NewChallengeGenerator()
+{
+    return std::make_unique<ChallengeGeneratorImpl<CHash256>>(1);
+}
+
+// Anonymity set of n^m coins and BATCH_SIZE one-of-many proofs over the full set, sharing one challenge
+struct SigmaExtendedBenchData {
+    std::size_t n, m;
+    GroupElement g;
+    std::vector<GroupElement> h;
+    std::vector<GroupElement> commits;
+    Scalar x;
+
+    std::vector<std::size_t> indexes;
+    std::vector<Scalar> serials, values, randomness;
+    std::vector<SigmaExtendedProof> proofs;
+
+    SigmaExtendedBenchData(std::size_t n_, std::size_t m_) : n(n_), m(m_) {
+        g.randomize();
+        h = RandomGroupElements(n * m);
+
+        std::size_t N = 1;
+        for (std::size_t i = 0; i < m; ++i)
+            N *= n;
+        commits = RandomGroupElements(N);
+        x.randomize();
+
+        serials = RandomScalars(BATCH_SIZE);
+        values = RandomScalars(BATCH_SIZE);
+        randomness = RandomScalars(BATCH_SIZE);
+        for (std::size_t i = 0; i < BATCH_SIZE; ++i) {
+            indexes.push_back(i * N / BATCH_SIZE);
+            commits[indexes.back()] = LelantusPrimitives::double_commit(g, serials[i], h[1], values[i], h[0], randomness[i]);
+        }
+
+        SigmaExtendedProver prover(g, h, n, m);
+        for (std::size_t i = 0; i < BATCH_SIZE; ++i) {
+            proofs.emplace_back();
+            Prove(prover, i, proofs.back());
+        }
+    }
+
+    void Prove(SigmaExtendedProver& prover, std::size_t i, SigmaExtendedProof& proof) const {
+        GroupElement gs = g * serials[i].negate();
+        std::vector<GroupElement> shifted(commits);
+        for (auto& c : shifted)
+            c += gs;
+
+        Scalar rA, rB, rC, rD;
+        rA.randomize();
+        rB.randomize();
+        rC.randomize();
+        rD.randomize();
+
+        std::vector<Scalar> sigma, Tk(m), Pk(m), Yk(m), a(n * m);
+        prover.sigma_commit(shifted, indexes[i], rA, rB, rC, rD, a, Tk, Pk, Yk, sigma, proof);
+        prover.sigma_response(sigma, a, rA, rB, rC, rD, values[i], randomness[i], Tk, Pk, x, proof);
+    }
+};
+
+// setup is shared by the benchmarks using the same parameters
+const SigmaExtendedBenchData& GetSigmaExtendedBenchData(std::size_t n, std::size_t m)
+{
+    static std::map<std::pair<std::size_t, std::size_t>, std::unique_ptr<SigmaExtendedBenchData>> cache;
+    std::unique_ptr<SigmaExtendedBenchData>& data = cache[std::make_pair(n, m)];
+    if (!data)
+        data.reset(new SigmaExtendedBenchData(n, m));
+    return *data;
+}
+
+void LelantusSigmaProve(benchmark::State& state, std::size_t n, std::size_t m)
+{
+    const SigmaExtendedBenchData& data = GetSigmaExtendedBenchData(n, m);
+    SigmaExtendedProver prover(data.g, data.h, n, m);
+
+    while (state.KeepRunning()) {
+        SigmaExtendedProof proof;
+        data.Prove(prover, 0, proof);
+    }
+}
+
+void LelantusSigmaVerify(benchmark::State& state, std::size_t n, std::size_t m)
+{
+    const SigmaExtendedBenchData& data = GetSigmaExtendedBenchData(n, m);
+    SigmaExtendedVerifier verifier(data.g, data.h, n, m);
+
+    while (state.KeepRunning()) {
+        assert(verifier.singleverify(data.commits, data.x, data.serials[0], data.proofs[0]));
+    }
+}
+
+void LelantusSigmaBatchVerify(benchmark::State& state, std::size_t n, std::size_t m)
+{
+    const SigmaExtendedBenchData& data = GetSigmaExtendedBenchData(n, m);
+    SigmaExtendedVerifier verifier(data.g, data.h, n, m);
+
+    while (state.KeepRunning()) {
+        assert(verifier.batchverify(data.commits, data.x, data.serials, data.proofs));
+    }
+}
+
+// Aggregated bulletproofs for two outputs, both the value and its distance to the limit are proven per output
+struct RangeBenchData {
+    static const std::size_t n = 64;
+    static const std::size_t m = 4;
+
+    GroupElement g, h1, h2;
+    std::vector<GroupElement> g_, h_;
+
+    std::vector<Scalar> values, serials, randomness;
+    std::vector<std::vector<GroupElement>> V;
+    std::vector<RangeProof> proofs;
+
+    RangeBenchData() {
+        g.randomize();
+        h1.randomize();
+        h2.randomize();
+        g_ = RandomGroupElements(n * m);
+        h_ = RandomGroupElements(n * m);
+
+        serials = RandomScalars(m);
+        randomness = RandomScalars(m);
+        for (std::size_t i = 0; i < m; ++i)
+            values.emplace_back(uint64_t(i + 1));
+
+        RangeProver prover(g, h1, h2, g_, h_, n, LELANTUS_TX_TPAYLOAD);
+        for (std::size_t i = 0; i < BATCH_SIZE; ++i) {
+            V.emplace_back();
+            for (std::size_t j = 0; j < m; ++j)
+                V.back().push_back(g * values[j] + h1 * randomness[j] + h2 * serials[j]);
+
+            proofs.emplace_back();
+            prover.proof(values, serials, randomness, V.back(), proofs.back());
+        }
+    }
+};
+
+const RangeBenchData& GetRangeBenchData()
+{
+    static RangeBenchData data;
+    return data;
+}
+
+} // namespace
+
+// one-of-many proofs over 2^14 coins
+static void LelantusSigmaProve_4_7(benchmark::State& state) { LelantusSigmaProve(state, 4, 7); }
+static void LelantusSigmaVerify_4_7(benchmark::State& state) { LelantusSigmaVerify(state, 4, 7); }
+static void LelantusSigmaBatchVerify_4_7(benchmark::State& state) { LelantusSigmaBatchVerify(state, 4, 7); }
+
+// one-of-many proofs over 2^16 coins, the parameters used on chain
+static void LelantusSigmaProve_16_4(benchmark::State& state) { LelantusSigmaProve(state, 16, 4); }
+static void LelantusSigmaVerify_16_4(benchmark::State& state) { LelantusSigmaVerify(state, 16, 4); }
+static void LelantusSigmaBatchVerify_16_4(benchmark::State& state) { LelantusSigmaBatchVerify(state, 16, 4); }
+
+static void RangeProve(benchmark::State& state)
+{
+    const RangeBenchData& data = GetRangeBenchData();
+    RangeProver prover(data.g, data.h1, data.h2, data.g_, data.h_, data.n, LELANTUS_TX_TPAYLOAD);
+
+    while (state.KeepRunning()) {
+        RangeProof proof;
+        prover.proof(data.values, data.serials, data.randomness, data.V[0], proof);
+    }
+}
+
+static void RangeVerify(benchmark::State& state)
+{
+    const RangeBenchData& data = GetRangeBenchData();
+    RangeVerifier verifier(data.g, data.h1, data.h2, data.g_, data.h_, data.n, LELANTUS_TX_TPAYLOAD);
+
+    while (state.KeepRunning()) {
+        assert(verifier.verify(data.V[0], data.V[0], data.proofs[0]));
+    }
+}
+
+static void RangeBatchVerify(benchmark::State& state)
+{
+    const RangeBenchData& data = GetRangeBenchData();
+    RangeVerifier verifier(data.g, data.h1, data.h2, data.g_, data.h_, data.n, LELANTUS_TX_TPAYLOAD);
+
+    while (state.KeepRunning()) {
+        assert(verifier.verify(data.V, data.V, data.proofs));
+    }
+}
+
+// inner product argument of the aggregated range proof above
+static void InnerProductVerify(benchmark::State& state)
+{
+    const std::size_t n = RangeBenchData::n * RangeBenchData::m;
+    std::vector<GroupElement> g_ = RandomGroupElements(n), h_ = RandomGroupElements(n);
+    std::vector<Scalar> a = RandomScalars(n), b = RandomScalars(n);
+    GroupElement u;
+    u.randomize();
+    Scalar x;
+    x.randomize();
+
+    InnerProductProof proof;
+    InnerProductProofGenerator generator(g_, h_, u, 2);
+    std::unique_ptr<ChallengeGenerator> challengeGenerator = NewChallengeGenerator();
+    generator.generate_proof(a, b, x, challengeGenerator, proof);
+    GroupElement P = generator.get_P();
+
+    while (state.KeepRunning()) {
+        // the verifier consumes its state
+        InnerProductProofVerifier verifier(g_, h_, u, P, 2);
+        challengeGenerator = NewChallengeGenerator();
+        assert(verifier.verify_fast(n, x, proof, challengeGenerator));
+    }
+}
+
+static void SchnorrProve(benchmark::State& state)
+{
+    GroupElement g, h, a, b;
+    g.randomize();
+    h.randomize();
+    a.randomize();
+    b.randomize();
+    Scalar P, T;
+    P.randomize();
+    T.randomize();
+    GroupElement y = LelantusPrimitives::commit(g, P, h, T);
+    SchnorrProver prover(g, h, true);
+
+    while (state.KeepRunning()) {
+        std::unique_ptr<ChallengeGenerator> challengeGenerator = NewChallengeGenerator();
+        SchnorrProof proof;
+        prover.proof(P, T, y, a, b, challengeGenerator, proof);
+    }
+}
+
+static void SchnorrVerify(benchmark::State& state)
+{
+    GroupElement g, h, a, b;
+    g.randomize();
+    h.randomize();
+    a.randomize();
+    b.randomize();
+    Scalar P, T;
+    P.randomize();
+    T.randomize();
+    GroupElement y = LelantusPrimitives::commit(g, P, h, T);
+
+    SchnorrProof proof;
+    std::unique_ptr<ChallengeGenerator> challengeGenerator = NewChallengeGenerator();
+    SchnorrProver(g, h, true).proof(P, T, y, a, b, challengeGenerator, proof);
+    SchnorrVerifier verifier(g, h, true);
+
+    while (state.KeepRunning()) {
+        challengeGenerator = NewChallengeGenerator();
+        assert(verifier.verify(y, a, b, proof, challengeGenerator));
+    }
+}
+
+// Complete JoinSplit proof with one input over an anonymity set of 2^16 coins and two outputs
+static void LelantusJoinSplit(benchmark::State& state, bool fVerify)
+{
+    const Params* params = Params::get_default();
+
+    PrivateCoin input(params, 5);
+    std::vector<std::pair<PrivateCoin, uint32_t>> Cin = {{input, 0}};
+    std::vector<size_t> indexes = {12345};
+
+    std::map<uint32_t, std::vector<PublicCoin>> anonymity_sets;
+    std::vector<PublicCoin>& set = anonymity_sets[0];
+    for (const GroupElement& e : RandomGroupElements(1 << 16))
+        set.emplace_back(e);
+    set[indexes[0]] = input.getPublicCoin();
+
+    Scalar Vin(uint64_t(5));
+    uint64_t Vout = 6, fee = 1;
+    std::vector<PrivateCoin> Cout = {{params, 2}, {params, 1}};
+
+    LelantusProver prover(params, LELANTUS_TX_VERSION_4_5);
+    LelantusProof proof;
+    SchnorrProof qkSchnorrProof;
+    if (!fVerify) {
+        while (state.KeepRunning()) {
+            prover.proof(anonymity_sets, {}, Vin, Cin, indexes, {}, Vout, Cout, fee, proof, qkSchnorrProof);
+        }
+        return;
+    }
+    prover.proof(anonymity_sets, {}, Vin, Cin, indexes, {}, Vout, Cout, fee, proof, qkSchnorrProof);
+
+    std::vector<Scalar> serials = {input.getSerialNumber()};
+    std::vector<uint32_t> groupIds = {0};
+    std::vector<PublicCoin> CoutPublic = {Cout[0].getPublicCoin(), Cout[1].getPublicCoin()};
+    LelantusVerifier verifier(params, LELANTUS_TX_VERSION_4_5);
+
+    while (state.KeepRunning()) {
+        assert(verifier.verify(anonymity_sets, {}, serials, {}, groupIds, Vin, Vout, fee, CoutPublic, proof, qkSchnorrProof));
+    }
+}
+
+static void LelantusJoinSplitProve(benchmark::State& state) { LelantusJoinSplit(state, false); }
+static void LelantusJoinSplitVerify(benchmark::State& state) { LelantusJoinSplit(state, true); }
+
+BENCHMARK(LelantusSigmaProve_4_7);
+BENCHMARK(LelantusSigmaVerify_4_7);
+BENCHMARK(LelantusSigmaBatchVerify_4_7);
+BENCHMARK(LelantusSigmaProve_16_4);
+BENCHMARK(LelantusSigmaVerify_16_4);
+BENCHMARK(LelantusSigmaBatchVerify_16_4);
+BENCHMARK(RangeProve);
+BENCHMARK(RangeVerify);
+BENCHMARK(RangeBatchVerify);
+BENCHMARK(InnerProductVerify);
+BENCHMARK(SchnorrProve);
+BENCHMARK(SchnorrVerify);
+BENCHMARK(LelantusJoinSplitProve);
+BENCHMARK(LelantusJoinSplitVerify);
@@ -0,0 +1,70 @@
+#include "bench.h"
+
+#include "proofthreadpool.h"
+#include "secp256k1/include/FixedBaseTable.h"
+#include "secp256k1/include/MultiExponent.h"
+
+using namespace secp_primitives;
+
+namespace {
+
+void MultiExponentiation(benchmark::State& state, std::size_t size, bool fParallel)
+{
+    std::vector<GroupElement> generators(size);
+    std::vector<Scalar> powers(size);
+    for (std::size_t i = 0; i < size; ++i) {
+        generators[i].randomize();
+        powers[i].randomize();
+    }
+
+    MultiExponent multiExponent(generators, powers);
+    ProofThreadPool& threadPool = ProofThreadPool::GetInstance();
+    MultiExponent::TaskRunner runner = [&threadPool](const std::vector<std::function<void()>>& jobs) {
+        threadPool.RunAll(jobs);
+    };
+
+    while (state.KeepRunning()) {
+        if (fParallel)
+            multiExponent.get_multiple_parallel(threadPool.GetNumberOfThreads(), runner);
+        else
+            multiExponent.get_multiple();
+    }
+}
+
+} // namespace
+
+// sizes of the multiexponentiation verifying a one-of-many proof over 2^14 and 2^16 coins
+static void MultiExponent_16384(benchmark::State& state) { MultiExponentiation(state, 1 << 14, false); }
+static void MultiExponent_65536(benchmark::State& state) { MultiExponentiation(state, 1 << 16, false); }
+static void MultiExponentParallel_65536(benchmark::State& state) { MultiExponentiation(state, 1 << 16, true); }
+
+static void FixedBaseMultiply(benchmark::State& state)
+{
+    std::vector<GroupElement> generators(1);
+    generators[0].randomize();
+    FixedBaseTable table(generators);
+    Scalar s;
+    s.randomize();
+
+    while (state.KeepRunning()) {
+        table.multiply(0, s);
+    }
+}
+
+static void VariableBaseMultiply(benchmark::State& state)
+{
+    GroupElement g;
+    g.randomize();
+    Scalar s;
+    s.randomize();
+
+    while (state.KeepRunning()) {
+        g * s;
+    }
+}
+
+BENCHMARK(MultiExponent_16384);
+BENCHMARK(MultiExponent_65536);
+BENCHMARK(MultiExponentParallel_65536);
+BENCHMARK(FixedBaseMultiply);
+BENCHMARK(VariableBaseMultiply);
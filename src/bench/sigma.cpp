@@ -0,0 +1,120 @@
+#include "bench.h"
+
+#include "sigma/sigmaplus_prover.h"
+#include "sigma/sigmaplus_verifier.h"
+
+#include <map>
+#include <memory>
+
+namespace {
+
+typedef sigma::SigmaPlusProof<Scalar, GroupElement> SigmaProof;
+
+// number of proofs verified together by the batch benchmarks
+const std::size_t BATCH_SIZE = 10;
+
+// Anonymity set of n^m coins and BATCH_SIZE proofs over the full set
+struct SigmaBenchData {
+    std::size_t n, m;
+    GroupElement g;
+    std::vector<GroupElement> h;
+    std::vector<GroupElement> commits;
+    std::vector<Scalar> randomness;
+    std::vector<std::size_t> indexes;
+
+    std::vector<SigmaProof> proofs;
+    std::vector<Scalar> serials;
+    std::vector<bool> fPadding;
+    std::vector<size_t> setSizes;
+
+    SigmaBenchData(std::size_t n_, std::size_t m_) : n(n_), m(m_) {
+        g.randomize();
+        h.resize(n * m);
+        for (auto& h_i : h)
+            h_i.randomize();
+
+        std::size_t N = 1;
+        for (std::size_t i = 0; i < m; ++i)
+            N *= n;
+
+        commits.resize(N);
+        for (auto& c : commits)
+            c.randomize();
+
+        for (std::size_t i = 0; i < BATCH_SIZE; ++i) {
+            indexes.push_back(i * N / BATCH_SIZE);
+            randomness.emplace_back();
+            randomness.back().randomize();
+            commits[indexes.back()] = h[0] * randomness.back();
+        }
+
+        sigma::SigmaPlusProver<Scalar, GroupElement> prover(g, h, n, m);
+        for (std::size_t i = 0; i < BATCH_SIZE; ++i) {
+            proofs.emplace_back(n, m);
+            prover.proof(commits, indexes[i], randomness[i], true, proofs.back());
+            serials.emplace_back(uint64_t(0));
+            fPadding.push_back(true);
+            setSizes.push_back(N);
+        }
+    }
+};
+
+// setup is shared by the benchmarks using the same parameters
+const SigmaBenchData& GetSigmaBenchData(std::size_t n, std::size_t m)
+{
+    static std::map<std::pair<std::size_t, std::size_t>, std::unique_ptr<SigmaBenchData>> cache;
+    std::unique_ptr<SigmaBenchData>& data = cache[std::make_pair(n, m)];
+    if (!data)
+        data.reset(new SigmaBenchData(n, m));
+    return *data;
+}
+
+void SigmaPlusProve(benchmark::State& state, std::size_t n, std::size_t m)
+{
+    const SigmaBenchData& data = GetSigmaBenchData(n, m);
+    sigma::SigmaPlusProver<Scalar, GroupElement> prover(data.g, data.h, n, m);
+
+    while (state.KeepRunning()) {
+        SigmaProof proof(n, m);
+        prover.proof(data.commits, data.indexes[0], data.randomness[0], true, proof);
+    }
+}
+
+void SigmaPlusVerify(benchmark::State& state, std::size_t n, std::size_t m)
+{
+    const SigmaBenchData& data = GetSigmaBenchData(n, m);
+    sigma::SigmaPlusVerifier<Scalar, GroupElement> verifier(data.g, data.h, n, m);
+
+    while (state.KeepRunning()) {
+        assert(verifier.verify(data.commits, data.proofs[0], true));
+    }
+}
+
+void SigmaPlusBatchVerify(benchmark::State& state, std::size_t n, std::size_t m)
+{
+    const SigmaBenchData& data = GetSigmaBenchData(n, m);
+    sigma::SigmaPlusVerifier<Scalar, GroupElement> verifier(data.g, data.h, n, m);
+
+    while (state.KeepRunning()) {
+        assert(verifier.batch_verify(data.commits, data.serials, data.fPadding, data.setSizes, data.proofs));
+    }
+}
+
+} // namespace
+
+// anonymity set of 2^14 coins
+static void SigmaPlusProve_4_7(benchmark::State& state) { SigmaPlusProve(state, 4, 7); }
+static void SigmaPlusVerify_4_7(benchmark::State& state) { SigmaPlusVerify(state, 4, 7); }
+static void SigmaPlusBatchVerify_4_7(benchmark::State& state) { SigmaPlusBatchVerify(state, 4, 7); }
+
+// anonymity set of 2^16 coins, the parameters used on chain
+static void SigmaPlusProve_16_4(benchmark::State& state) { SigmaPlusProve(state, 16, 4); }
+static void SigmaPlusVerify_16_4(benchmark::State& state) { SigmaPlusVerify(state, 16, 4); }
+static void SigmaPlusBatchVerify_16_4(benchmark::State& state) { SigmaPlusBatchVerify(state, 16, 4); }
+
+BENCHMARK(SigmaPlusProve_4_7);
+BENCHMARK(SigmaPlusVerify_4_7);
+BENCHMARK(SigmaPlusBatchVerify_4_7);
+BENCHMARK(SigmaPlusProve_16_4);
+BENCHMARK(SigmaPlusVerify_16_4);
+BENCHMARK(SigmaPlusBatchVerify_16_4);
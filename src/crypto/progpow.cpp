@@ -7,10 +7,17 @@
 #include <chainparams.h>
 #include <crypto/progpow/helpers.hpp>
 #include <crypto/progpow/lib/ethash/endianness.hpp>
+#include <crypto/progpow/lib/ethash/ethash-internal.hpp>
 #include <crypto/progpow/include/ethash/ethash.hpp>
+#include <crypto/sha256.h>
 #include <hash.h>
 #include <primitives/block.h>
+#include <tinyformat.h>
 
+#include <cstdio>
+#include <future>
+#include <map>
+#include <mutex>
 #include <sstream>
 
 static inline ethash::hash256 U256ToH256(const uint256& in) {
@@ -38,17 +45,217 @@ static inline uint256 H256ToU256(const ethash::hash256& in) {
     return ret;
 }
 
-uint256 progpow_hash_full(const CProgPowHeader& header, uint256& mix_hash)
+namespace {
+
+/** Distance in blocks to the next epoch from which its context is built in the background */
+constexpr int EPOCH_PREBUILD_BLOCKS = 100;
+
+/** Number of resident epoch contexts: the current and the next one, plus the previous one for reorgs */
+constexpr size_t MAX_EPOCH_CONTEXTS = 3;
+
+/** Light cache file being loaded by LoadLightCache() on this thread */
+thread_local const std::vector<ethash::hash512>* loadingLightCache = nullptr;
+
+void LoadLightCache(ethash::hash512 cache[], int num_items, const ethash::hash256&)
+{
+    assert(loadingLightCache && loadingLightCache->size() == (size_t)num_items);
+    memcpy(cache, loadingLightCache->data(), num_items * sizeof(ethash::hash512));
+}
+
+uint256 HashLightCache(const ethash::hash512* cache, int num_items)
 {
-    static ethash::epoch_context_ptr epochContext{nullptr,nullptr};
-    if (!epochContext || epochContext->epoch_number != ethash::get_epoch_number(header.nHeight))
+    uint256 ret;
+    CSHA256().Write((const unsigned char*)cache, num_items * sizeof(ethash::hash512)).Finalize(ret.begin());
+    return ret;
+}
+
+/**
+ * Epoch contexts shared by all the threads hashing with ProgPoW. A context is built once, by the
+ * first thread needing it or ahead of time in the background, and the others wait for it. When a
+ * cache directory is set the light caches are stored there and loaded instead of being rebuilt
+ * after a restart. Light cache file: epoch number, number of items, SHA256 of the items, items.
+ */
+class CEpochContextCache
+{
+private:
+    std::mutex mutex;
+    std::map<int, std::shared_future<ProgPowEpochContextPtr>> contexts;
+    std::string cacheDir;
+
+    std::string LightCachePath(int epoch)
     {
-        epochContext.reset();
-        epochContext = ethash::create_epoch_context(ethash::get_epoch_number(header.nHeight));
+        std::lock_guard<std::mutex> lock(mutex);
+        return cacheDir.empty() ? std::string() : strprintf("%s/lightcache-%d.dat", cacheDir, epoch);
     }
 
-    const auto header_h256{U256ToH256(SerializeHash(header))};
-    const auto result = progpow::hash(*epochContext, header.nHeight, header_h256, header.nNonce64);
+    ethash::epoch_context* LoadContext(const std::string& path, int epoch)
+    {
+        FILE* file = fopen(path.c_str(), "rb");
+        if (!file)
+            return nullptr;
+
+        int32_t fileEpoch = -1, numItems = -1;
+        uint256 hash;
+        std::vector<ethash::hash512> items;
+        bool fOk = fread(&fileEpoch, sizeof(fileEpoch), 1, file) == 1 &&
+                   fread(&numItems, sizeof(numItems), 1, file) == 1 &&
+                   fileEpoch == epoch && numItems == ethash::calculate_light_cache_num_items(epoch) &&
+                   fread(hash.begin(), hash.size(), 1, file) == 1;
+        if (fOk) {
+            items.resize(numItems);
+            fOk = fread(items.data(), sizeof(ethash::hash512), numItems, file) == (size_t)numItems &&
+                  HashLightCache(items.data(), numItems) == hash;
+        }
+        fclose(file);
+        if (!fOk)
+            return nullptr;
+
+        loadingLightCache = &items;
+        ethash::epoch_context* context = ethash::generic::create_epoch_context(LoadLightCache, epoch, false);
+        loadingLightCache = nullptr;
+        return context;
+    }
+
+    void SaveLightCache(const std::string& path, const ethash::epoch_context& context)
+    {
+        std::string tmpPath = path + ".new";
+        FILE* file = fopen(tmpPath.c_str(), "wb");
+        if (!file)
+            return;
+
+        int32_t epoch = context.epoch_number, numItems = context.light_cache_num_items;
+        uint256 hash = HashLightCache(context.light_cache, numItems);
+        bool fOk = fwrite(&epoch, sizeof(epoch), 1, file) == 1 &&
+                   fwrite(&numItems, sizeof(numItems), 1, file) == 1 &&
+                   fwrite(hash.begin(), hash.size(), 1, file) == 1 &&
+                   fwrite(context.light_cache, sizeof(ethash::hash512), numItems, file) == (size_t)numItems;
+        fOk = fclose(file) == 0 && fOk;
+        if (!fOk || std::rename(tmpPath.c_str(), path.c_str()) != 0) {
+            std::remove(tmpPath.c_str());
+            return;
+        }
+
+        // The caches are written in epoch order, drop the one nobody needs anymore
+        if (epoch >= 2)
+            std::remove(LightCachePath(epoch - 2).c_str());
+    }
+
+    ProgPowEpochContextPtr Build(int epoch)
+    {
+        std::string path = LightCachePath(epoch);
+        ethash::epoch_context* context = path.empty() ? nullptr : LoadContext(path, epoch);
+        if (!context) {
+            context = ethash_create_epoch_context(epoch);
+            if (!context)
+                throw std::bad_alloc();
+            if (!path.empty())
+                SaveLightCache(path, *context);
+        }
+        return ProgPowEpochContextPtr(context, ethash_destroy_epoch_context);
+    }
+
+    // Start building the context unless it is already there, mutex must be held
+    std::shared_future<ProgPowEpochContextPtr> Request(int epoch)
+    {
+        auto it = contexts.find(epoch);
+        if (it != contexts.end())
+            return it->second;
+
+        // Evict the ready context furthest away from the requested epoch. Its users keep it alive
+        while (contexts.size() >= MAX_EPOCH_CONTEXTS) {
+            auto furthest = contexts.end();
+            for (auto jt = contexts.begin(); jt != contexts.end(); ++jt) {
+                if (jt->second.wait_for(std::chrono::seconds(0)) != std::future_status::ready)
+                    continue;
+                if (furthest == contexts.end() || std::abs(jt->first - epoch) > std::abs(furthest->first - epoch))
+                    furthest = jt;
+            }
+            if (furthest == contexts.end())
+                break;
+            contexts.erase(furthest);
+        }
+
+        std::shared_future<ProgPowEpochContextPtr> future = std::async(std::launch::async, [this, epoch]() {
+            return Build(epoch);
+        }).share();
+        contexts.emplace(epoch, future);
+        return future;
+    }
+
+    // Drop the context of the epoch if its build failed, mutex must be held. A successful build started
+    // meanwhile by another request is kept
+    void Forget(int epoch)
+    {
+        auto it = contexts.find(epoch);
+        if (it == contexts.end() || it->second.wait_for(std::chrono::seconds(0)) != std::future_status::ready)
+            return;
+        try {
+            it->second.get();
+        } catch (...) {
+            contexts.erase(it);
+        }
+    }
+
+public:
+    ProgPowEpochContextPtr Get(int epoch)
+    {
+        std::shared_future<ProgPowEpochContextPtr> future;
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            future = Request(epoch);
+        }
+        try {
+            return future.get();
+        } catch (...) {
+            // Don't keep the failed build around, the next request of the epoch tries again
+            std::lock_guard<std::mutex> lock(mutex);
+            Forget(epoch);
+            throw;
+        }
+    }
+
+    void Prebuild(int epoch)
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        Request(epoch);
+    }
+
+    void SetCacheDir(const std::string& dir)
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        cacheDir = dir;
+    }
+};
+
+CEpochContextCache epochContextCache;
+
+} // namespace
+
+ProgPowEpochContextPtr progpow_get_epoch_context(int epoch_number)
+{
+    return epochContextCache.Get(epoch_number);
+}
+
+void progpow_set_cache_dir(const std::string& dir)
+{
+    epochContextCache.SetCacheDir(dir);
+}
+
+uint256 progpow_hash_full(const CProgPowHeader& header, uint256& mix_hash)
+{
+    const int epoch_number = ethash::get_epoch_number(header.nHeight);
+    ProgPowEpochContextPtr epochContext = epochContextCache.Get(epoch_number);
+
+    // Have the next epoch ready by the time the chain gets there
+    if ((epoch_number + 1) * ETHASH_EPOCH_LENGTH - (int)header.nHeight <= EPOCH_PREBUILD_BLOCKS)
+        epochContextCache.Prebuild(epoch_number + 1);
+
+    return progpow_hash_full(*epochContext, SerializeHash(header), header.nHeight, header.nNonce64, mix_hash);
+}
+
+uint256 progpow_hash_full(const ethash::epoch_context& context, const uint256& header_hash, uint32_t nHeight, uint64_t nNonce64, uint256& mix_hash)
+{
+    const auto result = progpow::hash(context, nHeight, U256ToH256(header_hash), nNonce64);
     mix_hash = H256ToU256(result.mix_hash);
     return H256ToU256(result.final_hash);
 }
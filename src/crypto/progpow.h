@@ -11,6 +11,14 @@
 #include <uint256.h>
 #include <serialize.h>
 
+#include <memory>
+#include <string>
+
+/** Default for -persistprogpowcache */
+static const bool DEFAULT_PERSIST_PROGPOW_CACHE = false;
+
+typedef std::shared_ptr<const ethash::epoch_context> ProgPowEpochContextPtr;
+
 /**
  * Serializer for ProgPow BlockHeader input
 */
@@ -39,9 +47,18 @@ public:
     }
 };
 
+/* Returns the context of the epoch, shared with the other threads and built on first use */
+ProgPowEpochContextPtr progpow_get_epoch_context(int epoch_number);
+
+/* Keep the epoch light caches in dir so they are loaded rather than rebuilt after a restart, empty to disable */
+void progpow_set_cache_dir(const std::string& dir);
+
 /* Performs a full progpow hash (DAG loops implied) provided header already hash nHeight valued */
 uint256 progpow_hash_full(const CProgPowHeader& header, uint256& mix_hash);
 
+/* Same with the serialized hash of the header and an epoch context obtained by the caller, for hashing many nonces */
+uint256 progpow_hash_full(const ethash::epoch_context& context, const uint256& header_hash, uint32_t nHeight, uint64_t nNonce64, uint256& mix_hash);
+
 /* Performs a light progpow hash (DAG loops excluded) provided header has mix_hash */
 uint256 progpow_hash_light(const CProgPowHeader& header);
 
@@ -7,6 +7,7 @@
 
 #include <stdint.h>
 #include <stdlib.h>
+#include <string>
 
 /** A hasher class for SHA-256. */
 class CSHA256
@@ -25,4 +26,22 @@ public:
     CSHA256& Reset();
 };
 
+/** Autodetect the best available SHA256 implementation, check it against the
+ *  portable one and return its name. Must be called once at startup, before
+ *  any other thread hashes. Without it the portable implementation is used.
+ */
+std::string SHA256AutoDetect();
+
+/** Compute multiple double-SHA256's of 64-byte blobs, several of them at once
+ *  when the CPU allows it. The output may overlap the input as long as it
+ *  starts at the same address, which lets a merkle tree be hashed in place.
+ *  output:  pointer to a blocks*32 byte output buffer
+ *  input:   pointer to a blocks*64 byte input buffer
+ *  blocks:  the number of hashes to compute.
+ */
+void SHA256D64(unsigned char* output, const unsigned char* input, size_t blocks);
+
+/** Same as SHA256D64, but every 64-byte blob is hashed only once. */
+void SHA256S64(unsigned char* output, const unsigned char* input, size_t blocks);
+
 #endif // BITCOIN_CRYPTO_SHA256_H
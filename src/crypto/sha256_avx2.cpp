@@ -0,0 +1,126 @@
+// Copyright (c) 2021 The Firo Core Developers
+// Distributed under the MIT software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+// This is an AVX2 implementation of SHA-256, hashing 8 independent
+// messages in the 8 32-bit lanes of a vector register.
+
+#ifdef ENABLE_AVX2
+
+#include <stdint.h>
+#include <immintrin.h>
+
+#include "crypto/common.h"
+
+namespace sha256_avx2 {
+
+namespace {
+
+const uint32_t K256[64] = {
+    0x428a2f98, 0x71374491, 0xb5c0fbcf, 0xe9b5dba5, 0x3956c25b, 0x59f111f1, 0x923f82a4, 0xab1c5ed5,
+    0xd807aa98, 0x12835b01, 0x243185be, 0x550c7dc3, 0x72be5d74, 0x80deb1fe, 0x9bdc06a7, 0xc19bf174,
+    0xe49b69c1, 0xefbe4786, 0x0fc19dc6, 0x240ca1cc, 0x2de92c6f, 0x4a7484aa, 0x5cb0a9dc, 0x76f988da,
+    0x983e5152, 0xa831c66d, 0xb00327c8, 0xbf597fc7, 0xc6e00bf3, 0xd5a79147, 0x06ca6351, 0x14292967,
+    0x27b70a85, 0x2e1b2138, 0x4d2c6dfc, 0x53380d13, 0x650a7354, 0x766a0abb, 0x81c2c92e, 0x92722c85,
+    0xa2bfe8a1, 0xa81a664b, 0xc24b8b70, 0xc76c51a3, 0xd192e819, 0xd6990624, 0xf40e3585, 0x106aa070,
+    0x19a4c116, 0x1e376c08, 0x2748774c, 0x34b0bcb5, 0x391c0cb3, 0x4ed8aa4a, 0x5b9cca4f, 0x682e6ff3,
+    0x748f82ee, 0x78a5636f, 0x84c87814, 0x8cc70208, 0x90befffa, 0xa4506ceb, 0xbef9a3f7, 0xc67178f2
+};
+
+__m256i inline K(uint32_t x) { return _mm256_set1_epi32(x); }
+
+__m256i inline Add(__m256i x, __m256i y) { return _mm256_add_epi32(x, y); }
+__m256i inline Add(__m256i x, __m256i y, __m256i z) { return Add(Add(x, y), z); }
+__m256i inline Add(__m256i x, __m256i y, __m256i z, __m256i w) { return Add(Add(x, y), Add(z, w)); }
+__m256i inline Add(__m256i x, __m256i y, __m256i z, __m256i w, __m256i v) { return Add(Add(x, y, z), Add(w, v)); }
+__m256i inline Xor(__m256i x, __m256i y) { return _mm256_xor_si256(x, y); }
+__m256i inline Xor(__m256i x, __m256i y, __m256i z) { return Xor(Xor(x, y), z); }
+__m256i inline Or(__m256i x, __m256i y) { return _mm256_or_si256(x, y); }
+__m256i inline And(__m256i x, __m256i y) { return _mm256_and_si256(x, y); }
+__m256i inline ShR(__m256i x, int n) { return _mm256_srli_epi32(x, n); }
+__m256i inline ShL(__m256i x, int n) { return _mm256_slli_epi32(x, n); }
+__m256i inline RotR(__m256i x, int n) { return Or(ShR(x, n), ShL(x, 32 - n)); }
+
+__m256i inline Ch(__m256i x, __m256i y, __m256i z) { return Xor(z, And(x, Xor(y, z))); }
+__m256i inline Maj(__m256i x, __m256i y, __m256i z) { return Or(And(x, y), And(z, Or(x, y))); }
+__m256i inline Sigma0(__m256i x) { return Xor(RotR(x, 2), RotR(x, 13), RotR(x, 22)); }
+__m256i inline Sigma1(__m256i x) { return Xor(RotR(x, 6), RotR(x, 11), RotR(x, 25)); }
+__m256i inline sigma0(__m256i x) { return Xor(RotR(x, 7), RotR(x, 18), ShR(x, 3)); }
+__m256i inline sigma1(__m256i x) { return Xor(RotR(x, 17), RotR(x, 19), ShR(x, 10)); }
+
+/** One round of SHA-256 in every lane, kw being the round constant plus the message word. */
+void inline __attribute__((always_inline)) Round(__m256i a, __m256i b, __m256i c, __m256i& d, __m256i e, __m256i f, __m256i g, __m256i& h, __m256i kw)
+{
+    __m256i t1 = Add(h, Sigma1(e), Ch(e, f, g), kw);
+    __m256i t2 = Add(Sigma0(a), Maj(a, b, c));
+    d = Add(d, t1);
+    h = Add(t1, t2);
+}
+
+/** Message word r of every lane, extending the schedule in place past the first 16 words. */
+__m256i inline __attribute__((always_inline)) W(__m256i* w, int r)
+{
+    if (r >= 16) {
+        w[r & 15] = Add(w[r & 15], sigma1(w[(r + 14) & 15]), w[(r + 9) & 15], sigma0(w[(r + 1) & 15]));
+    }
+    return w[r & 15];
+}
+
+__m256i inline Read8(const unsigned char* chunks, int offset)
+{
+    return _mm256_set_epi32(
+        ReadBE32(chunks + 448 + offset),
+        ReadBE32(chunks + 384 + offset),
+        ReadBE32(chunks + 320 + offset),
+        ReadBE32(chunks + 256 + offset),
+        ReadBE32(chunks + 192 + offset),
+        ReadBE32(chunks + 128 + offset),
+        ReadBE32(chunks + 64 + offset),
+        ReadBE32(chunks + 0 + offset));
+}
+
+} // namespace
+
+void Transform_8way(uint32_t* s, const unsigned char* chunks)
+{
+    __m256i a = _mm256_set_epi32(s[56], s[48], s[40], s[32], s[24], s[16], s[8], s[0]);
+    __m256i b = _mm256_set_epi32(s[57], s[49], s[41], s[33], s[25], s[17], s[9], s[1]);
+    __m256i c = _mm256_set_epi32(s[58], s[50], s[42], s[34], s[26], s[18], s[10], s[2]);
+    __m256i d = _mm256_set_epi32(s[59], s[51], s[43], s[35], s[27], s[19], s[11], s[3]);
+    __m256i e = _mm256_set_epi32(s[60], s[52], s[44], s[36], s[28], s[20], s[12], s[4]);
+    __m256i f = _mm256_set_epi32(s[61], s[53], s[45], s[37], s[29], s[21], s[13], s[5]);
+    __m256i g = _mm256_set_epi32(s[62], s[54], s[46], s[38], s[30], s[22], s[14], s[6]);
+    __m256i h = _mm256_set_epi32(s[63], s[55], s[47], s[39], s[31], s[23], s[15], s[7]);
+
+    __m256i w[16];
+    for (int i = 0; i < 16; ++i) {
+        w[i] = Read8(chunks, 4 * i);
+    }
+
+    for (int r = 0; r < 64; r += 8) {
+        Round(a, b, c, d, e, f, g, h, Add(K(K256[r + 0]), W(w, r + 0)));
+        Round(h, a, b, c, d, e, f, g, Add(K(K256[r + 1]), W(w, r + 1)));
+        Round(g, h, a, b, c, d, e, f, Add(K(K256[r + 2]), W(w, r + 2)));
+        Round(f, g, h, a, b, c, d, e, Add(K(K256[r + 3]), W(w, r + 3)));
+        Round(e, f, g, h, a, b, c, d, Add(K(K256[r + 4]), W(w, r + 4)));
+        Round(d, e, f, g, h, a, b, c, Add(K(K256[r + 5]), W(w, r + 5)));
+        Round(c, d, e, f, g, h, a, b, Add(K(K256[r + 6]), W(w, r + 6)));
+        Round(b, c, d, e, f, g, h, a, Add(K(K256[r + 7]), W(w, r + 7)));
+    }
+
+    const __m256i state[8] = {a, b, c, d, e, f, g, h};
+    for (int j = 0; j < 8; ++j) {
+        s[0 + j] += _mm256_extract_epi32(state[j], 0);
+        s[8 + j] += _mm256_extract_epi32(state[j], 1);
+        s[16 + j] += _mm256_extract_epi32(state[j], 2);
+        s[24 + j] += _mm256_extract_epi32(state[j], 3);
+        s[32 + j] += _mm256_extract_epi32(state[j], 4);
+        s[40 + j] += _mm256_extract_epi32(state[j], 5);
+        s[48 + j] += _mm256_extract_epi32(state[j], 6);
+        s[56 + j] += _mm256_extract_epi32(state[j], 7);
+    }
+}
+
+}
+
+#endif
@@ -0,0 +1,124 @@
+// Copyright (c) 2021 The Firo Core Developers
+// Distributed under the MIT software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+// This is an implementation of SHA-256 using the Intel SHA extensions
+// (SHA-NI), processing one message two rounds per instruction.
+
+#ifdef ENABLE_SHANI
+
+#include <stdint.h>
+#include <immintrin.h>
+
+namespace sha256_shani {
+
+namespace {
+
+alignas(16) const uint32_t K256[64] = {
+    0x428a2f98, 0x71374491, 0xb5c0fbcf, 0xe9b5dba5, 0x3956c25b, 0x59f111f1, 0x923f82a4, 0xab1c5ed5,
+    0xd807aa98, 0x12835b01, 0x243185be, 0x550c7dc3, 0x72be5d74, 0x80deb1fe, 0x9bdc06a7, 0xc19bf174,
+    0xe49b69c1, 0xefbe4786, 0x0fc19dc6, 0x240ca1cc, 0x2de92c6f, 0x4a7484aa, 0x5cb0a9dc, 0x76f988da,
+    0x983e5152, 0xa831c66d, 0xb00327c8, 0xbf597fc7, 0xc6e00bf3, 0xd5a79147, 0x06ca6351, 0x14292967,
+    0x27b70a85, 0x2e1b2138, 0x4d2c6dfc, 0x53380d13, 0x650a7354, 0x766a0abb, 0x81c2c92e, 0x92722c85,
+    0xa2bfe8a1, 0xa81a664b, 0xc24b8b70, 0xc76c51a3, 0xd192e819, 0xd6990624, 0xf40e3585, 0x106aa070,
+    0x19a4c116, 0x1e376c08, 0x2748774c, 0x34b0bcb5, 0x391c0cb3, 0x4ed8aa4a, 0x5b9cca4f, 0x682e6ff3,
+    0x748f82ee, 0x78a5636f, 0x84c87814, 0x8cc70208, 0x90befffa, 0xa4506ceb, 0xbef9a3f7, 0xc67178f2
+};
+
+/** Load four big-endian message words. */
+__m128i inline Load(const unsigned char* in)
+{
+    const __m128i mask = _mm_set_epi64x(0x0c0d0e0f08090a0bULL, 0x0405060700010203ULL);
+    return _mm_shuffle_epi8(_mm_loadu_si128((const __m128i*)in), mask);
+}
+
+/** Four rounds, state0 holding ABEF and state1 CDGH. */
+void inline __attribute__((always_inline)) QuadRound(__m128i& state0, __m128i& state1, __m128i m, int r)
+{
+    __m128i kw = _mm_add_epi32(m, _mm_load_si128((const __m128i*)(K256 + r)));
+    state1 = _mm_sha256rnds2_epu32(state1, state0, kw);
+    state0 = _mm_sha256rnds2_epu32(state0, state1, _mm_shuffle_epi32(kw, 0x0e));
+}
+
+/** First half of the schedule for the next four words: m0 += sigma0 of the following words. */
+void inline __attribute__((always_inline)) ShiftMessageA(__m128i& m0, __m128i m1)
+{
+    m0 = _mm_sha256msg1_epu32(m0, m1);
+}
+
+/** Second half of the schedule: m2 gets the words after m1, given their sigma0 part. */
+void inline __attribute__((always_inline)) ShiftMessageC(__m128i m0, __m128i m1, __m128i& m2)
+{
+    m2 = _mm_sha256msg2_epu32(_mm_add_epi32(m2, _mm_alignr_epi8(m1, m0, 4)), m1);
+}
+
+} // namespace
+
+void Transform(uint32_t* s, const unsigned char* chunk, size_t blocks)
+{
+    __m128i m0, m1, m2, m3, s0, s1, t, abef_save, cdgh_save;
+
+    // Rearrange the state from ABCD EFGH into ABEF CDGH, as the instructions want it
+    t = _mm_shuffle_epi32(_mm_loadu_si128((const __m128i*)s), 0xb1);
+    s1 = _mm_shuffle_epi32(_mm_loadu_si128((const __m128i*)(s + 4)), 0x1b);
+    s0 = _mm_alignr_epi8(t, s1, 8);
+    s1 = _mm_blend_epi16(s1, t, 0xf0);
+
+    while (blocks--) {
+        abef_save = s0;
+        cdgh_save = s1;
+
+        m0 = Load(chunk);
+        QuadRound(s0, s1, m0, 0);
+        m1 = Load(chunk + 16);
+        QuadRound(s0, s1, m1, 4);
+        ShiftMessageA(m0, m1);
+        m2 = Load(chunk + 32);
+        QuadRound(s0, s1, m2, 8);
+        ShiftMessageA(m1, m2);
+        m3 = Load(chunk + 48);
+        QuadRound(s0, s1, m3, 12);
+        ShiftMessageC(m2, m3, m0);
+        ShiftMessageA(m2, m3);
+
+        for (int r = 16; r < 48; r += 16) {
+            QuadRound(s0, s1, m0, r);
+            ShiftMessageC(m3, m0, m1);
+            ShiftMessageA(m3, m0);
+            QuadRound(s0, s1, m1, r + 4);
+            ShiftMessageC(m0, m1, m2);
+            ShiftMessageA(m0, m1);
+            QuadRound(s0, s1, m2, r + 8);
+            ShiftMessageC(m1, m2, m3);
+            ShiftMessageA(m1, m2);
+            QuadRound(s0, s1, m3, r + 12);
+            ShiftMessageC(m2, m3, m0);
+            ShiftMessageA(m2, m3);
+        }
+
+        QuadRound(s0, s1, m0, 48);
+        ShiftMessageC(m3, m0, m1);
+        ShiftMessageA(m3, m0);
+        QuadRound(s0, s1, m1, 52);
+        ShiftMessageC(m0, m1, m2);
+        QuadRound(s0, s1, m2, 56);
+        ShiftMessageC(m1, m2, m3);
+        QuadRound(s0, s1, m3, 60);
+
+        s0 = _mm_add_epi32(s0, abef_save);
+        s1 = _mm_add_epi32(s1, cdgh_save);
+        chunk += 64;
+    }
+
+    // And back to ABCD EFGH
+    t = _mm_shuffle_epi32(s0, 0x1b);
+    s1 = _mm_shuffle_epi32(s1, 0xb1);
+    s0 = _mm_blend_epi16(t, s1, 0xf0);
+    s1 = _mm_alignr_epi8(s1, t, 8);
+    _mm_storeu_si128((__m128i*)s, s0);
+    _mm_storeu_si128((__m128i*)(s + 4), s1);
+}
+
+}
+
+#endif
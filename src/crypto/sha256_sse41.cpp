@@ -0,0 +1,118 @@
+// Copyright (c) 2021 The Firo Core Developers
+// Distributed under the MIT software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+// This is an SSE4.1 implementation of SHA-256, hashing 4 independent
+// messages in the 4 32-bit lanes of a vector register.
+
+#ifdef ENABLE_SSE41
+
+#include <stdint.h>
+#include <immintrin.h>
+
+#include "crypto/common.h"
+
+namespace sha256_sse41 {
+
+namespace {
+
+const uint32_t K256[64] = {
+    0x428a2f98, 0x71374491, 0xb5c0fbcf, 0xe9b5dba5, 0x3956c25b, 0x59f111f1, 0x923f82a4, 0xab1c5ed5,
+    0xd807aa98, 0x12835b01, 0x243185be, 0x550c7dc3, 0x72be5d74, 0x80deb1fe, 0x9bdc06a7, 0xc19bf174,
+    0xe49b69c1, 0xefbe4786, 0x0fc19dc6, 0x240ca1cc, 0x2de92c6f, 0x4a7484aa, 0x5cb0a9dc, 0x76f988da,
+    0x983e5152, 0xa831c66d, 0xb00327c8, 0xbf597fc7, 0xc6e00bf3, 0xd5a79147, 0x06ca6351, 0x14292967,
+    0x27b70a85, 0x2e1b2138, 0x4d2c6dfc, 0x53380d13, 0x650a7354, 0x766a0abb, 0x81c2c92e, 0x92722c85,
+    0xa2bfe8a1, 0xa81a664b, 0xc24b8b70, 0xc76c51a3, 0xd192e819, 0xd6990624, 0xf40e3585, 0x106aa070,
+    0x19a4c116, 0x1e376c08, 0x2748774c, 0x34b0bcb5, 0x391c0cb3, 0x4ed8aa4a, 0x5b9cca4f, 0x682e6ff3,
+    0x748f82ee, 0x78a5636f, 0x84c87814, 0x8cc70208, 0x90befffa, 0xa4506ceb, 0xbef9a3f7, 0xc67178f2
+};
+
+__m128i inline K(uint32_t x) { return _mm_set1_epi32(x); }
+
+__m128i inline Add(__m128i x, __m128i y) { return _mm_add_epi32(x, y); }
+__m128i inline Add(__m128i x, __m128i y, __m128i z) { return Add(Add(x, y), z); }
+__m128i inline Add(__m128i x, __m128i y, __m128i z, __m128i w) { return Add(Add(x, y), Add(z, w)); }
+__m128i inline Add(__m128i x, __m128i y, __m128i z, __m128i w, __m128i v) { return Add(Add(x, y, z), Add(w, v)); }
+__m128i inline Xor(__m128i x, __m128i y) { return _mm_xor_si128(x, y); }
+__m128i inline Xor(__m128i x, __m128i y, __m128i z) { return Xor(Xor(x, y), z); }
+__m128i inline Or(__m128i x, __m128i y) { return _mm_or_si128(x, y); }
+__m128i inline And(__m128i x, __m128i y) { return _mm_and_si128(x, y); }
+__m128i inline ShR(__m128i x, int n) { return _mm_srli_epi32(x, n); }
+__m128i inline ShL(__m128i x, int n) { return _mm_slli_epi32(x, n); }
+__m128i inline RotR(__m128i x, int n) { return Or(ShR(x, n), ShL(x, 32 - n)); }
+
+__m128i inline Ch(__m128i x, __m128i y, __m128i z) { return Xor(z, And(x, Xor(y, z))); }
+__m128i inline Maj(__m128i x, __m128i y, __m128i z) { return Or(And(x, y), And(z, Or(x, y))); }
+__m128i inline Sigma0(__m128i x) { return Xor(RotR(x, 2), RotR(x, 13), RotR(x, 22)); }
+__m128i inline Sigma1(__m128i x) { return Xor(RotR(x, 6), RotR(x, 11), RotR(x, 25)); }
+__m128i inline sigma0(__m128i x) { return Xor(RotR(x, 7), RotR(x, 18), ShR(x, 3)); }
+__m128i inline sigma1(__m128i x) { return Xor(RotR(x, 17), RotR(x, 19), ShR(x, 10)); }
+
+/** One round of SHA-256 in every lane, kw being the round constant plus the message word. */
+void inline __attribute__((always_inline)) Round(__m128i a, __m128i b, __m128i c, __m128i& d, __m128i e, __m128i f, __m128i g, __m128i& h, __m128i kw)
+{
+    __m128i t1 = Add(h, Sigma1(e), Ch(e, f, g), kw);
+    __m128i t2 = Add(Sigma0(a), Maj(a, b, c));
+    d = Add(d, t1);
+    h = Add(t1, t2);
+}
+
+/** Message word r of every lane, extending the schedule in place past the first 16 words. */
+__m128i inline __attribute__((always_inline)) W(__m128i* w, int r)
+{
+    if (r >= 16) {
+        w[r & 15] = Add(w[r & 15], sigma1(w[(r + 14) & 15]), w[(r + 9) & 15], sigma0(w[(r + 1) & 15]));
+    }
+    return w[r & 15];
+}
+
+__m128i inline Read4(const unsigned char* chunks, int offset)
+{
+    return _mm_set_epi32(
+        ReadBE32(chunks + 192 + offset),
+        ReadBE32(chunks + 128 + offset),
+        ReadBE32(chunks + 64 + offset),
+        ReadBE32(chunks + 0 + offset));
+}
+
+} // namespace
+
+void Transform_4way(uint32_t* s, const unsigned char* chunks)
+{
+    __m128i a = _mm_set_epi32(s[24], s[16], s[8], s[0]);
+    __m128i b = _mm_set_epi32(s[25], s[17], s[9], s[1]);
+    __m128i c = _mm_set_epi32(s[26], s[18], s[10], s[2]);
+    __m128i d = _mm_set_epi32(s[27], s[19], s[11], s[3]);
+    __m128i e = _mm_set_epi32(s[28], s[20], s[12], s[4]);
+    __m128i f = _mm_set_epi32(s[29], s[21], s[13], s[5]);
+    __m128i g = _mm_set_epi32(s[30], s[22], s[14], s[6]);
+    __m128i h = _mm_set_epi32(s[31], s[23], s[15], s[7]);
+
+    __m128i w[16];
+    for (int i = 0; i < 16; ++i) {
+        w[i] = Read4(chunks, 4 * i);
+    }
+
+    for (int r = 0; r < 64; r += 8) {
+        Round(a, b, c, d, e, f, g, h, Add(K(K256[r + 0]), W(w, r + 0)));
+        Round(h, a, b, c, d, e, f, g, Add(K(K256[r + 1]), W(w, r + 1)));
+        Round(g, h, a, b, c, d, e, f, Add(K(K256[r + 2]), W(w, r + 2)));
+        Round(f, g, h, a, b, c, d, e, Add(K(K256[r + 3]), W(w, r + 3)));
+        Round(e, f, g, h, a, b, c, d, Add(K(K256[r + 4]), W(w, r + 4)));
+        Round(d, e, f, g, h, a, b, c, Add(K(K256[r + 5]), W(w, r + 5)));
+        Round(c, d, e, f, g, h, a, b, Add(K(K256[r + 6]), W(w, r + 6)));
+        Round(b, c, d, e, f, g, h, a, Add(K(K256[r + 7]), W(w, r + 7)));
+    }
+
+    const __m128i state[8] = {a, b, c, d, e, f, g, h};
+    for (int j = 0; j < 8; ++j) {
+        s[0 + j] += _mm_extract_epi32(state[j], 0);
+        s[8 + j] += _mm_extract_epi32(state[j], 1);
+        s[16 + j] += _mm_extract_epi32(state[j], 2);
+        s[24 + j] += _mm_extract_epi32(state[j], 3);
+    }
+}
+
+}
+
+#endif
@@ -198,6 +198,14 @@ public:
         return piter->value().size();
     }
 
+    // The serialized value, so that it can be deserialized later or on another thread
+    CDataStream GetValueStream() {
+        leveldb::Slice slValue = piter->value();
+        CDataStream ssValue(slValue.data(), slValue.data() + slValue.size(), SER_DISK, CLIENT_VERSION);
+        ssValue.Xor(dbwrapper_private::GetObfuscateKey(parent));
+        return ssValue;
+    }
+
 };
 
 class CDBWrapper
@@ -8,6 +8,7 @@
 #include "base58.h"
 #include "chainparams.h"
 #include "core_io.h"
+#include "crypto/sha256.h"
 #include "script/standard.h"
 #include "ui_interface.h"
 #include "validation.h"
@@ -278,27 +279,36 @@ std::vector<CDeterministicMNCPtr> CDeterministicMNList::CalculateQuorum(size_t m
 
 std::vector<std::pair<arith_uint256, CDeterministicMNCPtr>> CDeterministicMNList::CalculateScores(const uint256& modifier) const
 {
-    std::vector<std::pair<arith_uint256, CDeterministicMNCPtr>> scores;
-    scores.reserve(GetAllMNsCount());
+    std::vector<CDeterministicMNCPtr> mns;
+    mns.reserve(GetAllMNsCount());
     ForEachMN(true, [&](const CDeterministicMNCPtr& dmn) {
         if (dmn->pdmnState->confirmedHash.IsNull()) {
             // we only take confirmed MNs into account to avoid hash grinding on the ProRegTxHash to sneak MNs into a
             // future quorums
             return;
         }
-        // calculate sha256(sha256(proTxHash, confirmedHash), modifier) per MN
-        // Please note that this is not a double-sha256 but a single-sha256
-        // The first part is already precalculated (confirmedHashWithProRegTxHash)
-        // TODO When https://github.com/bitcoin/bitcoin/pull/13191 gets backported, implement something that is similar but for single-sha256
-        uint256 h;
-        CSHA256 sha256;
-        sha256.Write(dmn->pdmnState->confirmedHashWithProRegTxHash.begin(), dmn->pdmnState->confirmedHashWithProRegTxHash.size());
-        sha256.Write(modifier.begin(), modifier.size());
-        sha256.Finalize(h.begin());
-
-        scores.emplace_back(UintToArith256(h), dmn);
+        mns.emplace_back(dmn);
     });
 
+    // calculate sha256(sha256(proTxHash, confirmedHash), modifier) per MN
+    // Please note that this is not a double-sha256 but a single-sha256
+    // The first part is already precalculated (confirmedHashWithProRegTxHash)
+    // Every input is exactly 64 bytes, so all of them are hashed in one go, several at a time
+    std::vector<unsigned char> input(mns.size() * 64);
+    for (size_t i = 0; i < mns.size(); i++) {
+        const uint256& confirmedHashWithProRegTxHash = mns[i]->pdmnState->confirmedHashWithProRegTxHash;
+        memcpy(input.data() + i * 64, confirmedHashWithProRegTxHash.begin(), 32);
+        memcpy(input.data() + i * 64 + 32, modifier.begin(), 32);
+    }
+    std::vector<uint256> hashes(mns.size());
+    SHA256S64(hashes.empty() ? nullptr : hashes[0].begin(), input.data(), mns.size());
+
+    std::vector<std::pair<arith_uint256, CDeterministicMNCPtr>> scores;
+    scores.reserve(mns.size());
+    for (size_t i = 0; i < mns.size(); i++) {
+        scores.emplace_back(UintToArith256(hashes[i]), std::move(mns[i]));
+    }
+
     return scores;
 }
 
@@ -85,7 +85,7 @@ uint256 CSimplifiedMNList::CalcMerkleRoot(bool* pmutated) const
     for (const auto& e : mnList) {
         leaves.emplace_back(e->CalcHash());
     }
-    return ComputeMerkleRoot(leaves, pmutated);
+    return ComputeMerkleRoot(std::move(leaves), pmutated);
 }
 
 CSimplifiedMNListDiff::CSimplifiedMNListDiff()
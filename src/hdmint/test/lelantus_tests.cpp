@@ -169,6 +169,60 @@ BOOST_AUTO_TEST_CASE(regenerate_mint)
     BOOST_CHECK_EQUAL_COLLECTIONS(
         key, key + 32,
         entry1.ecdsaSecretKey.begin(), entry1.ecdsaSecretKey.end());
+
+    // cached secrets should still pick up the state of the mint
+    mint.SetUsed(true);
+    mint.SetHeight(10);
+    mint.SetId(1);
+
+    CLelantusEntry entry3;
+    BOOST_CHECK(pwalletMain->zwallet->RegenerateMint(walletdb, mint, entry3));
+    BOOST_CHECK(entry3.value == entry1.value);
+    BOOST_CHECK(entry3.randomness == entry1.randomness);
+    BOOST_CHECK(entry3.serialNumber == entry1.serialNumber);
+    BOOST_CHECK(entry3.ecdsaSecretKey == entry1.ecdsaSecretKey);
+    BOOST_CHECK_EQUAL(true, entry3.IsUsed);
+    BOOST_CHECK_EQUAL(10, entry3.nHeight);
+    BOOST_CHECK_EQUAL(1, entry3.id);
+
+    // and regeneration should work the same after the cache is dropped
+    pwalletMain->zwallet->ClearMintCache();
+    CLelantusEntry entry4;
+    BOOST_CHECK(pwalletMain->zwallet->RegenerateMint(walletdb, mint, entry4));
+    BOOST_CHECK(entry4.serialNumber == entry1.serialNumber);
+}
+
+BOOST_AUTO_TEST_CASE(mint_cache_cleared_on_lock)
+{
+    lelantus::PrivateCoin coin(params, 1);
+    CHDMint mint;
+    CLelantusEntry entry1;
+    {
+        CWalletDB walletdb(pwalletMain->strWalletFile);
+        uint160 seedID;
+        BOOST_CHECK(pwalletMain->zwallet->GenerateLelantusMint(walletdb, coin, mint, seedID));
+        BOOST_CHECK(pwalletMain->zwallet->RegenerateMint(walletdb, mint, entry1));
+    }
+    BOOST_CHECK(pwalletMain->zwallet->IsMintCached(mint.GetPubCoinHash()));
+
+    // encrypting leaves the wallet locked, which drops the cached secrets
+    SecureString passphrase("mint cache");
+    BOOST_CHECK(pwalletMain->EncryptWallet(passphrase));
+    BOOST_CHECK(pwalletMain->IsLocked());
+    BOOST_CHECK(!pwalletMain->zwallet->IsMintCached(mint.GetPubCoinHash()));
+
+    // the mint is cached again once regenerated in the unlocked wallet
+    BOOST_CHECK(pwalletMain->Unlock(passphrase));
+    CLelantusEntry entry2;
+    {
+        CWalletDB walletdb(pwalletMain->strWalletFile);
+        BOOST_CHECK(pwalletMain->zwallet->RegenerateMint(walletdb, mint, entry2));
+    }
+    BOOST_CHECK(entry2.serialNumber == entry1.serialNumber);
+    BOOST_CHECK(pwalletMain->zwallet->IsMintCached(mint.GetPubCoinHash()));
+
+    BOOST_CHECK(pwalletMain->Lock());
+    BOOST_CHECK(!pwalletMain->zwallet->IsMintCached(mint.GetPubCoinHash()));
 }
 
 BOOST_AUTO_TEST_SUITE_END()
\ No newline at end of file
@@ -540,12 +540,13 @@ bool CHDMintTracker::IsMempoolSpendOurs(const std::set<uint256>& setMempool, con
         }
 
         const CTransaction &tx = *ptx;
-        for (const CTxIn& txin : tx.vin) {
+        for (size_t i = 0; i < tx.vin.size(); i++) {
+            const CTxIn& txin = tx.vin[i];
             if (txin.IsSigmaSpend()) {
-                std::unique_ptr<sigma::CoinSpend> spend;
+                std::shared_ptr<const sigma::CoinSpend> spend;
                 uint32_t pubcoinId;
                 try {
-                    std::tie(spend, pubcoinId) = sigma::ParseSigmaSpend(txin);
+                    std::tie(spend, pubcoinId) = sigma::ParseSigmaSpend(tx, i);
                 } catch (...) {
                     return false;
                 }
@@ -557,7 +558,7 @@ bool CHDMintTracker::IsMempoolSpendOurs(const std::set<uint256>& setMempool, con
             }
 
             if (txin.IsLelantusJoinSplit()) {
-                std::unique_ptr<lelantus::JoinSplit> joinsplit;
+                std::shared_ptr<const lelantus::JoinSplit> joinsplit;
                 try {
                     joinsplit = lelantus::ParseLelantusJoinSplit(tx);
                 } catch (...) {
@@ -12,9 +12,12 @@
 #include "wallet/wallet.h"
 #include "sigma.h"
 #include "lelantus.h"
+#include "proofthreadpool.h"
+#include "crypto/common.h"
 #include "crypto/hmac_sha256.h"
 #include "crypto/hmac_sha512.h"
 #include "keystore.h"
+#include "support/cleanse.h"
 #include <boost/optional.hpp>
 #include "masternode-sync.h"
 #include "ui_interface.h"
@@ -32,6 +35,12 @@ CHDMintWallet::CHDMintWallet(const std::string& strWalletFile, bool resetCount)
 {
     this->mintPool = CMintPool();
 
+    // The cached mint secrets don't outlive the unlocked wallet
+    walletStatusConnection = pwalletMain->NotifyStatusChanged.connect([this](CCryptoKeyStore* keystore) {
+        if (keystore->IsLocked())
+            ClearMintCache();
+    });
+
     //Don't try to do anything else if the wallet is locked.
     if (pwalletMain->IsLocked()) {
         return;
@@ -64,6 +73,7 @@ bool CHDMintWallet::SetupWallet(const uint160& hashSeedMaster, bool fResetCount)
     }
 
     this->hashSeedMaster = hashSeedMaster;
+    ClearMintCache();
 
     nCountNextUse = COUNT_DEFAULT;
     nCountNextGenerate = COUNT_DEFAULT;
@@ -132,7 +142,7 @@ std::pair<uint256,uint256> CHDMintWallet::RegenerateMintPoolEntry(CWalletDB& wal
  * only runs if the current mintpool is exhausted and we need new mints (ie. the next mint to
  * generate is the same as the one last used)
  * Generates 20 mints at a time.
- * Makes the appropriate database entries.
+ * Commitments are computed on the proof threads and all database entries are written in one transaction.
  *
  * @param nIndex The number of mints to generate. Defaults to 20 if no param passed.
  */
@@ -156,36 +166,85 @@ void CHDMintWallet::GenerateMintPool(CWalletDB& walletdb, bool forceGenerate, in
     if(nIndex > 0 && nIndex >= nLastCount)
         nStop = nIndex + mintpoolsize;
     LogPrintf("%s : nLastCount=%d nStop=%d\n", __func__, nLastCount, nStop - 1);
+
+    // Key derivation updates the HD chain and the keystore, so seeds are created in order
+    struct PendingMint {
+        int32_t nCount;
+        CKeyID seedId;
+        uint512 mintSeed;
+        GroupElement commitmentValue;
+        Scalar serialNumber;
+        bool fValid = false;
+    };
+    std::vector<PendingMint> pendingMints;
     for (; nLastCount <= nStop; ++nLastCount) {
         if (ShutdownRequested())
             return;
 
-        CKeyID seedId;
-        uint512 mintSeed;
-        if(!CreateMintSeed(walletdb, mintSeed, nLastCount, seedId, false))
+        PendingMint pending;
+        pending.nCount = nLastCount;
+        if(!CreateMintSeed(walletdb, pending.mintSeed, nLastCount, pending.seedId, false))
             continue;
+        pendingMints.push_back(pending);
+    }
 
-        GroupElement commitmentValue;
-        sigma::PrivateCoin coin(sigma::Params::get_default(), sigma::CoinDenomination::SIGMA_DENOM_1);
-        if(!SeedToMint(mintSeed, commitmentValue, coin)) //for lelantus put just part of commit, for checking we will need to reduce h1^v from lelantus mint
+    // Turning seeds into commitments is independent for every mint, spread it over the proof threads.
+    // sigma::Params::get_default() creates the params lazily without locking, fetch them once here
+    const sigma::Params* params = sigma::Params::get_default();
+    ProofThreadPool& threadPool = ProofThreadPool::GetInstance();
+    std::size_t nChunks = std::min(pendingMints.size(), threadPool.GetNumberOfThreads());
+    std::vector<std::function<void()>> jobs;
+    for (std::size_t i = 0; i < nChunks; ++i) {
+        jobs.emplace_back([this, &pendingMints, params, i, nChunks]() {
+            for (std::size_t j = i; j < pendingMints.size(); j += nChunks) {
+                PendingMint& pending = pendingMints[j];
+                sigma::PrivateCoin coin(params, sigma::CoinDenomination::SIGMA_DENOM_1);
+                //for lelantus put just part of commit, for checking we will need to reduce h1^v from lelantus mint
+                pending.fValid = SeedToMint(pending.mintSeed, pending.commitmentValue, coin);
+                pending.serialNumber = coin.getSerialNumber();
+            }
+        });
+    }
+    threadPool.RunAll(jobs);
+
+    // write the whole pool in a single db transaction, memory is only updated once it is committed
+    if (!walletdb.TxnBegin())
+        throw std::runtime_error(std::string(__func__) + ": Unable to begin wallet db transaction");
+
+    std::vector<std::pair<uint256, MintPoolEntry>> mintPoolEntries;
+    for (const PendingMint& pending : pendingMints) {
+        if (!pending.fValid)
             continue;
 
-        uint256 hashPubcoin = primitives::GetPubCoinValueHash(commitmentValue);
+        uint256 hashPubcoin = primitives::GetPubCoinValueHash(pending.commitmentValue);
 
-        MintPoolEntry mintPoolEntry(hashSeedMaster, seedId, nLastCount);
-        mintPool.Add(std::make_pair(hashPubcoin, mintPoolEntry));
-        walletdb.WritePubcoin(primitives::GetSerialHash(coin.getSerialNumber()), commitmentValue);
-        walletdb.WriteMintPoolPair(hashPubcoin, mintPoolEntry);
+        MintPoolEntry mintPoolEntry(hashSeedMaster, pending.seedId, pending.nCount);
+        if (!walletdb.WritePubcoin(primitives::GetSerialHash(pending.serialNumber), pending.commitmentValue) ||
+            !walletdb.WriteMintPoolPair(hashPubcoin, mintPoolEntry)) {
+            walletdb.TxnAbort();
+            throw std::runtime_error(std::string(__func__) + ": Writing mint pool entry failed");
+        }
+        mintPoolEntries.push_back(std::make_pair(hashPubcoin, mintPoolEntry));
     }
 
     // write hdchain back to database
-    if (!walletdb.WriteHDChain(pwalletMain->GetHDChain()))
+    if (!walletdb.WriteHDChain(pwalletMain->GetHDChain())) {
+        walletdb.TxnAbort();
         throw std::runtime_error(std::string(__func__) + ": Writing HD chain model failed");
+    }
 
-    // Update local + DB entries for count last generated
-    nCountNextGenerate = nLastCount;
-    walletdb.WriteMintSeedCount(nCountNextGenerate);
+    // Update DB entry for count last generated
+    if (!walletdb.WriteMintSeedCount(nLastCount)) {
+        walletdb.TxnAbort();
+        throw std::runtime_error(std::string(__func__) + ": Writing mint seed count failed");
+    }
+
+    if (!walletdb.TxnCommit())
+        throw std::runtime_error(std::string(__func__) + ": Unable to commit mint pool to wallet db");
 
+    for (const auto& mintPoolEntry : mintPoolEntries)
+        mintPool.Add(mintPoolEntry);
+    nCountNextGenerate = nLastCount;
 }
 
 /**
@@ -238,6 +297,44 @@ void CHDMintWallet::SetWalletTransactionBlock(CWalletTx &wtx, const CBlockIndex
     wtx.SetMerkleBranch(blockIndex, (int)posInBlock);
 }
 
+/**
+ * Get the tag identifying a Lelantus mint on chain without revealing its commitment.
+ *
+ * @param hashPubcoin mint pubcoin hash
+ * @param seedId seed ID for the key used to generate the mint
+ * @return the mint tag
+ */
+uint256 CHDMintWallet::GetMintTag(const uint256& hashPubcoin, const uint160& seedId)
+{
+    CDataStream ss(SER_GETHASH, 0);
+    ss << hashPubcoin;
+    ss << seedId;
+    return Hash(ss.begin(), ss.end());
+}
+
+/**
+ * Get a mint transaction, reusing the ones already fetched during this sync.
+ *
+ * @param mapMintTxs transactions fetched so far, mapped to their block hash
+ * @param txHash hash of the transaction to get
+ * @param tx reference to the transaction. Is set if found
+ * @param hashBlock reference to the containing block hash. Is set if found
+ * @return success
+ */
+bool CHDMintWallet::GetMintTransaction(std::map<uint256, std::pair<CTransactionRef, uint256>>& mapMintTxs, const uint256& txHash, CTransactionRef& tx, uint256& hashBlock)
+{
+    auto it = mapMintTxs.find(txHash);
+    if (it == mapMintTxs.end()) {
+        if (!GetTransaction(txHash, tx, Params().GetConsensus(), hashBlock, true))
+            return false;
+        it = mapMintTxs.emplace(txHash, std::make_pair(tx, hashBlock)).first;
+    }
+
+    tx = it->second.first;
+    hashBlock = it->second.second;
+    return true;
+}
+
 /**
  * Catch the mint counter up with the chain.
  *
@@ -255,6 +352,8 @@ void CHDMintWallet::SyncWithChain(bool fGenerateMintPool, boost::optional<std::l
 
     std::set<uint256> setAddedTx;
     std::set<uint256> setChecked;
+    // transactions holding several of our mints are only fetched once
+    std::map<uint256, std::pair<CTransactionRef, uint256>> mapMintTxs;
     int mintsFound = 1;
     bool firstIteration = true;
     do {
@@ -270,6 +369,21 @@ void CHDMintWallet::SyncWithChain(bool fGenerateMintPool, boost::optional<std::l
             listMints = std::list<std::pair<uint256, MintPoolEntry>>();
             mintPool.List(listMints.get());
         }
+
+        // Look up every mint of this pass on chain at once instead of one at a time
+        std::vector<uint256> mintTags, pubCoinHashes;
+        for (const std::pair<uint256, MintPoolEntry>& pMint : listMints.get()) {
+            if (setChecked.count(pMint.first) || tracker.HasPubcoinHash(pMint.first, walletdb))
+                continue;
+            mintTags.push_back(GetMintTag(pMint.first, std::get<1>(pMint.second)));
+            pubCoinHashes.push_back(pMint.first);
+        }
+
+        std::map<uint256, COutPoint> lelantusOutPoints, sigmaOutPoints;
+        if (!pwalletMain->IsLocked())
+            lelantus::GetOutPointsFromMintTags(lelantusOutPoints, mintTags);
+        sigma::GetOutPoints(sigmaOutPoints, pubCoinHashes);
+
         for (std::pair<uint256, MintPoolEntry>& pMint : listMints.get()) {
             if (setChecked.count(pMint.first))
                 continue;
@@ -285,22 +399,16 @@ void CHDMintWallet::SyncWithChain(bool fGenerateMintPool, boost::optional<std::l
             if (tracker.HasPubcoinHash(pMint.first, walletdb))
                 continue;
 
-            uint160 seedId = std::get<1>(pMint.second);
-            CDataStream ss(SER_GETHASH, 0);
-            ss << pMint.first;
-            ss << seedId;
-            uint256 mintTag = Hash(ss.begin(), ss.end());
-
-            COutPoint outPoint;
-            if (!pwalletMain->IsLocked() && lelantus::GetOutPointFromMintTag(outPoint, mintTag)) {
-                const uint256& txHash = outPoint.hash;
+            auto lelantusOutPoint = lelantusOutPoints.find(GetMintTag(pMint.first, std::get<1>(pMint.second)));
+            if (lelantusOutPoint != lelantusOutPoints.end()) {
+                const uint256& txHash = lelantusOutPoint->second.hash;
                 //this mint has already occurred on the chain, increment counter's state to reflect this
                 LogPrintf("%s : Found wallet coin mint=%s count=%d tx=%s\n", __func__, pMint.first.GetHex(), mintCount, txHash.GetHex());
                 found = true;
 
                 uint256 hashBlock;
                 CTransactionRef tx;
-                if (!GetTransaction(txHash, tx, Params().GetConsensus(), hashBlock, true)) {
+                if (!GetMintTransaction(mapMintTxs, txHash, tx, hashBlock)) {
                     LogPrintf("%s : failed to get transaction for mint %s!\n", __func__, pMint.first.GetHex());
                     found = false;
                     continue;
@@ -391,15 +499,15 @@ void CHDMintWallet::SyncWithChain(bool fGenerateMintPool, boost::optional<std::l
                     UpdateCountDB(walletdb);
                     LogPrint("zero", "%s: updated count to %d\n", __func__, nCountNextUse);
                 }
-            } if (sigma::GetOutPoint(outPoint, pMint.first)) {
-                const uint256& txHash = outPoint.hash;
+            } if (sigmaOutPoints.count(pMint.first)) {
+                const uint256& txHash = sigmaOutPoints[pMint.first].hash;
                 //this mint has already occurred on the chain, increment counter's state to reflect this
                 LogPrintf("%s : Found wallet coin mint=%s count=%d tx=%s\n", __func__, pMint.first.GetHex(), mintCount, txHash.GetHex());
                 found = true;
 
                 uint256 hashBlock;
                 CTransactionRef tx;
-                if (!GetTransaction(txHash, tx, Params().GetConsensus(), hashBlock, true)) {
+                if (!GetMintTransaction(mapMintTxs, txHash, tx, hashBlock)) {
                     LogPrintf("%s : failed to get transaction for mint %s!\n", __func__, pMint.first.GetHex());
                     found = false;
                     continue;
@@ -1055,6 +1163,14 @@ bool CHDMintWallet::RegenerateMint(CWalletDB& walletdb, const CHDMint& dMint, CS
     sigma::CoinDenomination denom;
     IntegerToDenomination(dMint.GetAmount(), denom);
 
+    if (!forEstimation && GetCachedMint(dMint, sigma.value, sigma.randomness, sigma.serialNumber, sigma.ecdsaSecretKey)) {
+        sigma.set_denomination(denom);
+        sigma.IsUsed = dMint.IsUsed();
+        sigma.nHeight = dMint.GetHeight();
+        sigma.id = dMint.GetId();
+        return true;
+    }
+
     //Generate the coin
     sigma::PrivateCoin coin(sigma::Params::get_default(), denom, false);
     CHDMint dMintDummy;
@@ -1085,11 +1201,22 @@ bool CHDMintWallet::RegenerateMint(CWalletDB& walletdb, const CHDMint& dMint, CS
     sigma.id = dMint.GetId();
     sigma.ecdsaSecretKey = std::vector<unsigned char>(&coin.getEcdsaSeckey()[0],&coin.getEcdsaSeckey()[32]);
 
+    if (!forEstimation)
+        CacheMint(dMint, bnValue, sigma.randomness, bnSerial, coin.getEcdsaSeckey());
+
     return true;
 }
 
 bool CHDMintWallet::RegenerateMint(CWalletDB& walletdb, const CHDMint& dMint, CLelantusEntry& lelantusEntry, bool forEstimation)
 {
+    if (!forEstimation && GetCachedMint(dMint, lelantusEntry.value, lelantusEntry.randomness, lelantusEntry.serialNumber, lelantusEntry.ecdsaSecretKey)) {
+        lelantusEntry.amount = dMint.GetAmount();
+        lelantusEntry.IsUsed = dMint.IsUsed();
+        lelantusEntry.nHeight = dMint.GetHeight();
+        lelantusEntry.id = dMint.GetId();
+        return true;
+    }
+
     //Generate the coin
     lelantus::PrivateCoin coin(lelantus::Params::get_default(), dMint.GetAmount());
     CHDMint dMintDummy;
@@ -1121,9 +1248,112 @@ bool CHDMintWallet::RegenerateMint(CWalletDB& walletdb, const CHDMint& dMint, CL
     lelantusEntry.id = dMint.GetId();
     lelantusEntry.ecdsaSecretKey = std::vector<unsigned char>(&coin.getEcdsaSeckey()[0],&coin.getEcdsaSeckey()[32]);
 
+    if (!forEstimation)
+        CacheMint(dMint, bnValue, lelantusEntry.randomness, bnSerial, coin.getEcdsaSeckey());
+
     return true;
 }
 
+/**
+ * Look up the private data of a mint regenerated earlier in this session
+ *
+ * Nothing is returned while the wallet is locked, so regeneration fails the same way it
+ * would without the cache.
+ *
+ * @param dMint HDMint object
+ * @return true if the mint was found in the cache
+ */
+bool CHDMintWallet::GetCachedMint(const CHDMint& dMint, GroupElement& value, Scalar& randomness, Scalar& serial, std::vector<unsigned char>& ecdsaSecretKey)
+{
+    {
+        LOCK(cs_mintCache);
+        if (mintCache.count(dMint.GetPubCoinHash()) == 0)
+            return false;
+    }
+
+    SecureVector mask(2 * Scalar::memoryRequired() + 32);
+    if (!GetMintCacheMask(dMint, mask))
+        return false;
+
+    LOCK(cs_mintCache);
+    auto it = mintCache.find(dMint.GetPubCoinHash());
+    if (it == mintCache.end())
+        return false;
+
+    SecureVector secrets(it->second.secrets);
+    for (size_t i = 0; i < secrets.size(); i++)
+        secrets[i] ^= mask[i];
+
+    value = it->second.value;
+    serial.deserialize(randomness.deserialize(secrets.data()));
+    ecdsaSecretKey.assign(secrets.begin() + 2 * Scalar::memoryRequired(), secrets.end());
+    return true;
+}
+
+void CHDMintWallet::CacheMint(const CHDMint& dMint, const GroupElement& value, const Scalar& randomness, const Scalar& serial, const unsigned char* ecdsaSecretKey)
+{
+    SecureVector secrets(2 * Scalar::memoryRequired() + 32);
+    unsigned char* keyStart = serial.serialize(randomness.serialize(secrets.data()));
+    std::copy(ecdsaSecretKey, ecdsaSecretKey + 32, keyStart);
+
+    SecureVector mask(secrets.size());
+    if (!GetMintCacheMask(dMint, mask))
+        return;
+    for (size_t i = 0; i < secrets.size(); i++)
+        secrets[i] ^= mask[i];
+
+    LOCK(cs_mintCache);
+    CachedMint& cached = mintCache[dMint.GetPubCoinHash()];
+    cached.value = value;
+    cached.secrets = std::move(secrets);
+}
+
+/**
+ * Derive the mask of the cached secrets of a mint from its seed key
+ *
+ * The mask is never stored, it can only be derived again while the wallet is unlocked.
+ *
+ * @param dMint HDMint object
+ * @param mask filled with the mask, sized by the caller
+ * @return false if the seed key is not available
+ */
+bool CHDMintWallet::GetMintCacheMask(const CHDMint& dMint, SecureVector& mask)
+{
+    CKey key;
+    if (!pwalletMain->CCryptoKeyStore::GetKey(dMint.GetSeedId(), key))
+        return false;
+
+    // HMAC-SHA512(key, "mintcache" || pubcoin hash || block number), as many blocks as the mask takes
+    static const std::string strDomain = "mintcache";
+    uint256 hashPubcoin = dMint.GetPubCoinHash();
+    unsigned char block[CHMAC_SHA512::OUTPUT_SIZE];
+    for (uint32_t n = 0; n * sizeof(block) < mask.size(); n++) {
+        unsigned char counter[4];
+        WriteLE32(counter, n);
+        CHMAC_SHA512(key.begin(), key.size())
+            .Write(reinterpret_cast<const unsigned char*>(strDomain.data()), strDomain.size())
+            .Write(hashPubcoin.begin(), hashPubcoin.size())
+            .Write(counter, sizeof(counter))
+            .Finalize(block);
+        size_t nOffset = n * sizeof(block);
+        std::copy(block, block + std::min(sizeof(block), mask.size() - nOffset), mask.begin() + nOffset);
+    }
+    memory_cleanse(block, sizeof(block));
+    return true;
+}
+
+void CHDMintWallet::ClearMintCache()
+{
+    LOCK(cs_mintCache);
+    mintCache.clear();
+}
+
+bool CHDMintWallet::IsMintCached(const uint256& hashPubcoin)
+{
+    LOCK(cs_mintCache);
+    return mintCache.count(hashPubcoin) > 0;
+}
+
 /**
  * Checks to see if serial passed is on-chain (ie. a check on whether the mint for the serial is spent)
  *
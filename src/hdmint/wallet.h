@@ -9,6 +9,8 @@
 #include "hdmint/mintpool.h"
 #include "uint256.h"
 #include "primitives/mint_spend.h"
+#include "support/allocators/secure.h"
+#include "sync.h"
 #include "wallet/wallet.h"
 #include "tracker.h"
 
@@ -27,6 +29,17 @@ private:
     CHDMintTracker tracker;
     uint160 hashSeedMaster;
 
+    // Private data of mints already regenerated from the seed, keyed by pubcoin hash. The secrets
+    // are kept in locked memory, masked with a key derived from the seed key of the mint, and dropped
+    // as soon as the wallet is locked or the master seed changes. Chain state is always taken from the HDMint.
+    struct CachedMint {
+        GroupElement value;
+        SecureVector secrets; // randomness, serial number and ecdsa secret key
+    };
+    CCriticalSection cs_mintCache;
+    std::map<uint256, CachedMint> mintCache;
+    boost::signals2::scoped_connection walletStatusConnection;
+
 public:
     int static const COUNT_DEFAULT = 0;
 
@@ -51,6 +64,8 @@ public:
     bool SetLelantusMintSeedSeen(CWalletDB& walletdb, std::pair<uint256,MintPoolEntry> mintPoolEntryPair, int nHeight, const uint256& txid, uint64_t amount);
     bool SeedToMint(const uint512& mintSeed, GroupElement& bnValue, sigma::PrivateCoin& coin);
     bool SeedToLelantusMint(const uint512& mintSeed, lelantus::PrivateCoin& coin);
+    void ClearMintCache();
+    bool IsMintCached(const uint256& hashPubcoin);
 
     // Count updating functions
     int32_t GetCount();
@@ -63,7 +78,12 @@ public:
 
 private:
     CKeyID GetMintSeedID(CWalletDB& walletdb, int32_t nCount);
+    uint256 GetMintTag(const uint256& hashPubcoin, const uint160& seedId);
+    bool GetMintTransaction(std::map<uint256, std::pair<CTransactionRef, uint256>>& mapMintTxs, const uint256& txHash, CTransactionRef& tx, uint256& hashBlock);
     bool CreateMintSeed(CWalletDB& walletdb, uint512& mintSeed, const int32_t& n, CKeyID& seedId, bool nWriteChain = true);
+    bool GetCachedMint(const CHDMint& dMint, GroupElement& value, Scalar& randomness, Scalar& serial, std::vector<unsigned char>& ecdsaSecretKey);
+    void CacheMint(const CHDMint& dMint, const GroupElement& value, const Scalar& randomness, const Scalar& serial, const unsigned char* ecdsaSecretKey);
+    bool GetMintCacheMask(const CHDMint& dMint, SecureVector& mask);
 };
 
 #endif //FIRO_HDMINTWALLET_H
@@ -101,6 +101,14 @@ public:
      */
     void WriteHeader(const std::string& hdr, const std::string& value);
 
+    /**
+     * Append data to the body of the reply, so that a large reply can be built piece by piece
+     * without collecting it in a single string first.
+     *
+     * @note call this before calling WriteReply, which appends its strReply after this data.
+     */
+    void WriteReplyBody(const char* data, size_t size);
+
     /**
      * Write HTTP reply.
      * nStatus is the HTTP status code to send.
@@ -17,6 +17,7 @@
 #include "compat/sanity.h"
 #include "consensus/validation.h"
 #include "crypto/progpow.h"
+#include "crypto/sha256.h"
 #include "httpserver.h"
 #include "httprpc.h"
 #include "key.h"
@@ -29,6 +30,7 @@
 #include "rpc/server.h"
 #include "rpc/register.h"
 #include "script/standard.h"
+#include "proofcache.h"
 #include "script/sigcache.h"
 #include "scheduler.h"
 #include "timedata.h"
@@ -101,6 +103,7 @@
 #endif
 
 bool fFeeEstimatesInitialized = false;
+static int nProofThreads = DEFAULT_PROOF_THREADS;
 static const bool DEFAULT_PROXYRANDOMIZE = true;
 static const bool DEFAULT_REST_ENABLE = false;
 static const bool DEFAULT_DISABLE_SAFEMODE = false;
@@ -257,6 +260,7 @@ void Shutdown()
 
     BatchProofContainer::get_instance()->finalize();
     BatchProofContainer::get_instance()->verify();
+    StopProofThreads();
 
 #ifdef ENABLE_WALLET
     if (pwalletMain)
@@ -288,6 +292,7 @@ void Shutdown()
         LOCK(cs_main);
         if (pcoinsTip != NULL) {
             FlushStateToDisk();
+            DumpPrivacyState();
         }
         delete pcoinsTip;
         pcoinsTip = NULL;
@@ -435,12 +440,17 @@ std::string HelpMessage(HelpMessageMode mode)
     if (showDebug)
         strUsage += HelpMessageOpt("-feefilter", strprintf("Tell other nodes to filter invs to us by our mempool min fee (default: %u)", DEFAULT_FEEFILTER));
     strUsage += HelpMessageOpt("-loadblock=<file>", _("Imports blocks from external blk000??.dat file on startup"));
+    strUsage += HelpMessageOpt("-joinsplitbatchwindow=<n>", strprintf(_("Hold Lelantus JoinSplits received from peers for up to <n> milliseconds and verify their proofs in one batch, 0 to verify each on arrival (default: %u)"), DEFAULT_JOINSPLIT_BATCH_WINDOW));
     strUsage += HelpMessageOpt("-maxorphantx=<n>", strprintf(_("Keep at most <n> unconnectable transactions in memory (default: %u)"), DEFAULT_MAX_ORPHAN_TRANSACTIONS));
     strUsage += HelpMessageOpt("-maxmempool=<n>", strprintf(_("Keep the transaction memory pool below <n> megabytes (default: %u)"), DEFAULT_MAX_MEMPOOL_SIZE));
     strUsage += HelpMessageOpt("-mempoolexpiry=<n>", strprintf(_("Do not keep transactions in the mempool longer than <n> hours (default: %u)"), DEFAULT_MEMPOOL_EXPIRY));
     strUsage += HelpMessageOpt("-blockreconstructionextratxn=<n>", strprintf(_("Extra transactions to keep in memory for compact block reconstructions (default: %u)"), DEFAULT_BLOCK_RECONSTRUCTION_EXTRA_TXN));
     strUsage += HelpMessageOpt("-par=<n>", strprintf(_("Set the number of script verification threads (%u to %d, 0 = auto, <0 = leave that many cores free, default: %d)"),
         -GetNumCores(), MAX_SCRIPTCHECK_THREADS, DEFAULT_SCRIPTCHECK_THREADS));
+    strUsage += HelpMessageOpt("-proofthreads=<n>", strprintf(_("Set the number of privacy proof verification threads (%u to %d, 0 = auto, <0 = leave that many cores free, default: %d)"),
+        -GetNumCores(), MAX_PROOF_THREADS, DEFAULT_PROOF_THREADS));
+    strUsage += HelpMessageOpt("-parallelproofs", strprintf(_("Verify the privacy proofs of new blocks on the proof verification threads (default: %u)"), DEFAULT_PARALLEL_PROOFS));
+    strUsage += HelpMessageOpt("-persistprogpowcache", strprintf(_("Keep the ProgPoW light caches in the data directory to skip building them again on startup (default: %u)"), DEFAULT_PERSIST_PROGPOW_CACHE));
 #ifndef WIN32
     strUsage += HelpMessageOpt("-pid=<file>", strprintf(_("Specify pid file (default: %s)"), BITCOIN_PID_FILENAME));
 #endif
@@ -547,6 +557,7 @@ std::string HelpMessage(HelpMessageMode mode)
         strUsage += HelpMessageOpt("-limitfreerelay=<n>", strprintf("Continuously rate-limit free transactions to <n>*1000 bytes per minute (default: %u)", DEFAULT_LIMITFREERELAY));
         strUsage += HelpMessageOpt("-relaypriority", strprintf("Require high priority for relaying free or low-fee transactions (default: %u)", DEFAULT_RELAYPRIORITY));
         strUsage += HelpMessageOpt("-maxsigcachesize=<n>", strprintf("Limit size of signature cache to <n> MiB (default: %u)", DEFAULT_MAX_SIG_CACHE_SIZE));
+        strUsage += HelpMessageOpt("-maxproofcachesize=<n>", strprintf("Limit size of the verified privacy proof cache to <n> MiB (default: %u)", DEFAULT_MAX_PROOF_CACHE_SIZE));
         strUsage += HelpMessageOpt("-maxtipage=<n>", strprintf("Maximum tip age in seconds to consider node in initial block download (default: %u)", DEFAULT_MAX_TIP_AGE));
     }
     strUsage += HelpMessageOpt("-minrelaytxfee=<amt>", strprintf(_("Fees (in %s/kB) smaller than this are considered zero fee for relaying, mining and transaction creation (default: %s)"),
@@ -1272,6 +1283,15 @@ bool AppInitParameterInteraction()
     else if (nScriptCheckThreads > MAX_SCRIPTCHECK_THREADS)
         nScriptCheckThreads = MAX_SCRIPTCHECK_THREADS;
 
+    // -proofthreads=0 means autodetect
+    nProofThreads = GetArg("-proofthreads", DEFAULT_PROOF_THREADS);
+    if (nProofThreads <= 0)
+        nProofThreads += GetNumCores();
+    if (nProofThreads < 1)
+        nProofThreads = 1;
+    else if (nProofThreads > MAX_PROOF_THREADS)
+        nProofThreads = MAX_PROOF_THREADS;
+
     // block pruning; get the amount of disk space (in MiB) to allot for block & undo files
     int64_t nPruneArg = GetArg("-prune", 0);
     if (nPruneArg < 0) {
@@ -1439,6 +1459,10 @@ bool AppInitSanityChecks()
 {
     // ********************************************************* Step 4: sanity checks
 
+    // Pick the fastest SHA256 implementation the CPU supports
+    std::string sha256_algo = SHA256AutoDetect();
+    LogPrintf("Using the '%s' SHA256 implementation\n", sha256_algo);
+
     // Initialize elliptic curve code
     ECC_Start();
     globalVerifyHandle.reset(new ECCVerifyHandle());
@@ -1483,6 +1507,7 @@ bool AppInitMain(boost::thread_group& threadGroup, CScheduler& scheduler)
     LogPrintf("Using at most %i automatic connections (%i file descriptors available)\n", nMaxConnections, nFD);
 
     InitSignatureCache();
+    InitProofCache();
 
     LogPrintf("Using %u threads for script verification\n", nScriptCheckThreads);
     if (nScriptCheckThreads) {
@@ -1490,6 +1515,9 @@ bool AppInitMain(boost::thread_group& threadGroup, CScheduler& scheduler)
             threadGroup.create_thread(&ThreadScriptCheck);
     }
 
+    LogPrintf("Using %u threads for privacy proof verification\n", nProofThreads);
+    StartProofThreads(nProofThreads);
+
     // Start the lightweight task scheduler thread
     CScheduler::Function serviceLoop = boost::bind(&CScheduler::serviceQueue, &scheduler);
     threadGroup.create_thread(boost::bind(&TraceThread<CScheduler::Function>, "scheduler", serviceLoop));
@@ -1731,6 +1759,12 @@ bool AppInitMain(boost::thread_group& threadGroup, CScheduler& scheduler)
 
     boost::filesystem::create_directories(GetDataDir() / "blocks");
 
+    if (GetBoolArg("-persistprogpowcache", DEFAULT_PERSIST_PROGPOW_CACHE)) {
+        boost::filesystem::path progpowdir = GetDataDir() / "progpow";
+        boost::filesystem::create_directories(progpowdir);
+        progpow_set_cache_dir(progpowdir.string());
+    }
+
     // cache size calculations
     int64_t nTotalCache = (GetArg("-dbcache", nDefaultDbCache) << 20);
 //    nTotalCache = std::max(nTotalCache, nMinDbCache << 20); // total cache cannot be less than nMinDbCache
@@ -17,6 +17,8 @@
 #include "policy/policy.h"
 #include "coins.h"
 #include "batchproof_container.h"
+#include "proofcache.h"
+#include "streams.h"
 
 #include <atomic>
 #include <sstream>
@@ -31,6 +33,9 @@ namespace lelantus {
 
 static CLelantusState lelantusState;
 
+// mempool JoinSplits whose proofs passed BatchVerifyJoinSplits(), guarded by cs_main
+static std::set<uint256> batchVerifiedJoinSplits;
+
 static bool CheckLelantusSpendSerial(
         CValidationState &state,
         CLelantusTxInfo *lelantusTxInfo,
@@ -61,7 +66,7 @@ size_t CountCoinInBlock(CBlockIndex *index, int id) {
         ? index->lelantusMintedPubCoins[id].size() : 0;
 }
 
-std::vector<unsigned char> GetAnonymitySetHash(CBlockIndex *index, int group_id, bool generation = false) {
+std::vector<unsigned char> GetAnonymitySetHash(CBlockIndex *index, int group_id, bool generation) {
     std::vector<unsigned char> out_hash;
 
     CLelantusState::LelantusCoinGroupInfo coinGroup;
@@ -81,6 +86,18 @@ std::vector<unsigned char> GetAnonymitySetHash(CBlockIndex *index, int group_id,
     return out_hash;
 }
 
+uint256 GetJoinSplitProofKey(
+        const uint256& hashTx,
+        const std::map<uint32_t, std::pair<uint256, uint64_t>>& anonymitySets,
+        const std::vector<std::vector<unsigned char>>& anonymitySetHashes,
+        bool fAfterFixes) {
+    CHashWriter proofKeyWriter = GetProofCacheKeyWriter(hashTx);
+    for (const auto& idAndSet : anonymitySets)
+        proofKeyWriter << idAndSet.first << idAndSet.second.first << idAndSet.second.second;
+    proofKeyWriter << anonymitySetHashes << fAfterFixes;
+    return proofKeyWriter.GetHash();
+}
+
 bool IsLelantusAllowed()
 {
     LOCK(cs_main);
@@ -216,12 +233,17 @@ void ParseLelantusMintScript(const CScript& script, secp_primitives::GroupElemen
     }
 }
 
-std::unique_ptr<JoinSplit> ParseLelantusJoinSplit(const CTransaction &tx)
+std::shared_ptr<const JoinSplit> ParseLelantusJoinSplit(const CTransaction &tx)
 {
     if (tx.vin.size() != 1 || tx.vin[0].scriptSig.size() < 1) {
         throw CBadTxIn();
     }
 
+    // the proof of a transaction never changes, decode it only once
+    std::shared_ptr<const JoinSplit> joinsplit = tx.GetParsedJoinSplit();
+    if (joinsplit)
+        return joinsplit;
+
     CDataStream serialized(SER_NETWORK, PROTOCOL_VERSION);
 
     if (tx.vin[0].scriptSig[0] == OP_LELANTUSJOINSPLIT) {
@@ -233,7 +255,9 @@ std::unique_ptr<JoinSplit> ParseLelantusJoinSplit(const CTransaction &tx)
     else
         throw CBadTxIn();
 
-    return std::make_unique<lelantus::JoinSplit>(lelantus::Params::get_default(), serialized);
+    size_t nProofSize = serialized.size();
+    joinsplit = std::make_shared<lelantus::JoinSplit>(lelantus::Params::get_default(), serialized);
+    return tx.SetParsedJoinSplit(joinsplit, nProofSize);
 }
 
 bool CheckLelantusBlock(CValidationState &state, const CBlock& block) {
@@ -353,7 +377,8 @@ bool CheckLelantusJoinSplitTransaction(
         bool isCheckWallet,
         bool fStatefulSigmaCheck,
         sigma::CSigmaTxInfo* sigmaTxInfo,
-        CLelantusTxInfo* lelantusTxInfo) {
+        CLelantusTxInfo* lelantusTxInfo,
+        BatchProofContainer* proofCollector = nullptr) {
     std::unordered_set<Scalar, sigma::CScalarHash> txSerials;
 
     Consensus::Params const & params = ::Params().GetConsensus();
@@ -380,7 +405,7 @@ bool CheckLelantusJoinSplitTransaction(
         }
     }
     const CTxIn &txin = tx.vin[0];
-    std::unique_ptr<lelantus::JoinSplit> joinsplit;
+    std::shared_ptr<const lelantus::JoinSplit> joinsplit;
 
     try {
         joinsplit = ParseLelantusJoinSplit(tx);
@@ -443,6 +468,8 @@ bool CheckLelantusJoinSplitTransaction(
     }
 
     std::vector<std::vector<unsigned char>> anonymity_set_hashes;
+    // last block of every anonymity set, for the proof cache
+    std::map<uint32_t, uint256> anonymity_set_blocks;
 
     for (auto& idAndHash : joinsplit->getIdAndBlockHashes()) {
         auto& anonymity_set = anonymity_sets[idAndHash.first];
@@ -465,24 +492,14 @@ bool CheckLelantusJoinSplitTransaction(
             while (index != coinGroup.firstBlock && index->GetBlockHash() != idAndHash.second)
                 index = index->pprev;
 
-            std::pair<sigma::CoinDenomination, int> denominationAndId = std::make_pair(denomination, coinGroupId);
+            anonymity_set_blocks[idAndHash.first] = index->GetBlockHash();
 
-            auto lelantusParams = lelantus::Params::get_default();
-            while (true) {
-                if (index->sigmaMintedPubCoins.count(denominationAndId) > 0) {
-                    BOOST_FOREACH(
-                    const sigma::PublicCoin &pubCoinValue,
-                    index->sigmaMintedPubCoins[denominationAndId]) {
-                        if (::Params().GetConsensus().sigmaBlacklist.count(pubCoinValue.getValue()) > 0) {
-                            continue;
-                        }
-                        lelantus::PublicCoin publicCoin(pubCoinValue.getValue() + lelantusParams->get_h1() * intDenom);
-                        anonymity_set.push_back(publicCoin);
-                    }
-                }
-                if (index == coinGroup.firstBlock)
-                    break;
-                index = index->pprev;
+            // the converted coins of the group up to that block, without the blacklisted ones
+            std::shared_ptr<const sigma::CSigmaState::ConvertedSet> convertedSet = sigmaState->GetConvertedSet(denomination, coinGroupId);
+            sigma::CSigmaState::ConvertedSet::BlockEntry const *lastBlock = convertedSet ? convertedSet->GetLastBlock(index->nHeight) : nullptr;
+            if (lastBlock) {
+                auto coins = convertedSet->GetCoins(*lastBlock, true);
+                anonymity_set.insert(anonymity_set.end(), coins.first, coins.second);
             }
         } else {
             CLelantusState::LelantusCoinGroupInfo coinGroup;
@@ -496,6 +513,7 @@ bool CheckLelantusJoinSplitTransaction(
             // find index for block with hash of accumulatorBlockHash or set index to the coinGroup.firstBlock if not found
             while (index != coinGroup.firstBlock && index->GetBlockHash() != idAndHash.second)
                 index = index->pprev;
+            anonymity_set_blocks[idAndHash.first] = index->GetBlockHash();
 
             // take the hash from last block of anonymity set, it is used at challenge generation if nLelantusFixesStartBlock is passed
             if (nHeight >= params.nLelantusFixesStartBlock) {
@@ -506,43 +524,46 @@ bool CheckLelantusJoinSplitTransaction(
             // Build a vector with all the public coins with given id before
             // the block on which the spend occured.
             // This list of public coins is required by function "Verify" of JoinSplit.
-
-            while (true) {
-                int id = 0;
-                if (CountCoinInBlock(index, idAndHash.first)) {
-                    id = idAndHash.first;
-                } else if (CountCoinInBlock(index, idAndHash.first - 1)) {
-                    id = idAndHash.first - 1;
-                }
-                if (id) {
-                    if(index->lelantusMintedPubCoins.count(id) > 0) {
-                        BOOST_FOREACH(
-                        const auto& pubCoinValue,
-                        index->lelantusMintedPubCoins[id]) {
-                            // skip mints from blacklist if nLelantusFixesStartBlock is passed
-                            if (chainActive.Height() >= ::Params().GetConsensus().nLelantusFixesStartBlock) {
-                                if (::Params().GetConsensus().lelantusBlacklist.count(pubCoinValue.first.getValue()) > 0) {
-                                    continue;
-                                }
-                            }
-                            anonymity_set.push_back(pubCoinValue.first);
-                        }
-                    }
-                }
-                if (index == coinGroup.firstBlock)
-                    break;
-                index = index->pprev;
+            CLelantusState::AnonymitySet const *coinSet = lelantusState.GetCachedAnonymitySet(idAndHash.first);
+            CLelantusState::AnonymitySet::BlockEntry const *lastBlock = coinSet ? coinSet->GetLastBlock(index->nHeight) : nullptr;
+            if (lastBlock) {
+                // skip mints from blacklist if nLelantusFixesStartBlock is passed
+                auto coins = coinSet->GetCoins(
+                    *lastBlock, chainActive.Height() >= ::Params().GetConsensus().nLelantusFixesStartBlock);
+                anonymity_set.insert(anonymity_set.end(), coins.first, coins.second);
             }
         }
         anonymity_sets[idAndHash.first] = anonymity_set;
     }
 
-    BatchProofContainer* batchProofContainer = BatchProofContainer::get_instance();
-    bool useBatching = batchProofContainer->fCollectProofs && !isVerifyDB && !isCheckWallet && lelantusTxInfo && !lelantusTxInfo->fInfoIsComplete;
+    // everything the proofs are verified against, the sets are made of the coins up to their last block
+    std::map<uint32_t, std::pair<uint256, uint64_t>> proofKeySets;
+    for (const auto& idAndSet : anonymity_sets)
+        proofKeySets[idAndSet.first] = std::make_pair(anonymity_set_blocks[idAndSet.first], (uint64_t)idAndSet.second.size());
+    uint256 proofKey = GetJoinSplitProofKey(hashTx, proofKeySets, anonymity_set_hashes, nHeight >= params.nLelantusFixesStartBlock);
+
+    // proofs of a mempool transaction may have been verified in a batch with others already, and the
+    // ones of a block transaction when it was accepted to the mempool
+    bool fProofsVerified = (nHeight == INT_MAX && batchVerifiedJoinSplits.count(hashTx) > 0) ||
+            (!isVerifyDB && IsProofVerified(proofKey));
+
+    BatchProofContainer* batchProofContainer = proofCollector ? proofCollector : BatchProofContainer::get_instance();
+    bool useBatching = batchProofContainer->fCollectProofs && !isVerifyDB && !isCheckWallet && lelantusTxInfo && !lelantusTxInfo->fInfoIsComplete && !fProofsVerified;
+    // when connecting a block at the tip the proofs are verified on the proof threads while the following
+    // transactions are checked, serials are still checked below in the block order
+    bool fDeferVerification = batchProofContainer->fDeferProofs && !useBatching && !fProofsVerified && !isVerifyDB && !isCheckWallet &&
+            nHeight != INT_MAX && lelantusTxInfo && !lelantusTxInfo->fInfoIsComplete;
 
     Scalar challenge;
     // if we are collecting proofs, skip verification and collect proofs
-    passVerify = joinsplit->Verify(anonymity_sets, anonymity_set_hashes, Cout, Vout, txHashForMetadata, challenge, useBatching);
+    passVerify = joinsplit->Verify(anonymity_sets, anonymity_set_hashes, Cout, Vout, txHashForMetadata, challenge, useBatching || fProofsVerified || fDeferVerification);
+
+    if (passVerify && fDeferVerification) {
+        auto sets = std::make_shared<const std::map<uint32_t, std::vector<PublicCoin>>>(std::move(anonymity_sets));
+        batchProofContainer->defer([joinsplit, sets, anonymity_set_hashes, Cout, Vout, txHashForMetadata]() {
+            return joinsplit->Verify(*sets, anonymity_set_hashes, Cout, Vout, txHashForMetadata);
+        });
+    }
 
     // add proofs into container
     if(useBatching) {
@@ -555,6 +576,9 @@ bool CheckLelantusJoinSplitTransaction(
         batchProofContainer->add(joinsplit.get(), Cout);
     }
 
+    if (passVerify && nHeight == INT_MAX && !useBatching)
+        SetProofVerified(proofKey);
+
     if (passVerify) {
         const std::vector<Scalar>& serials = joinsplit->getCoinSerialNumbers();
         const std::vector<uint32_t> &ids = joinsplit->getCoinGroupIds();
@@ -773,6 +797,47 @@ bool CheckLelantusTransaction(
     return true;
 }
 
+bool BatchVerifyJoinSplits(const std::vector<CTransactionRef>& txs) {
+    AssertLockHeld(cs_main);
+
+    BatchProofContainer batchProofContainer;
+    std::vector<uint256> collected;
+    for (const CTransactionRef& tx : txs) {
+        if (!tx->IsLelantusJoinSplit())
+            continue;
+
+        // collect proofs of every transaction separately, so the ones failing other checks don't spoil the batch
+        CValidationState state;
+        CLelantusTxInfo lelantusTxInfo;
+        batchProofContainer.init();
+        batchProofContainer.fCollectProofs = true;
+        if (!CheckLelantusJoinSplitTransaction(
+                *tx, state, tx->GetHash(), false, INT_MAX, chainActive.Height(),
+                false, true, nullptr, &lelantusTxInfo, &batchProofContainer)) {
+            // left for AcceptToMemoryPool to reject with the proper state
+            continue;
+        }
+        batchProofContainer.finalize();
+        collected.push_back(tx->GetHash());
+    }
+
+    if (collected.empty())
+        return true;
+
+    if (!batchProofContainer.verify_joinsplits()) {
+        LogPrintf("BatchVerifyJoinSplits: batch of %d JoinSplits failed\n", collected.size());
+        return false;
+    }
+
+    batchVerifiedJoinSplits.insert(collected.begin(), collected.end());
+    return true;
+}
+
+void ClearBatchVerifiedJoinSplits() {
+    AssertLockHeld(cs_main);
+    batchVerifiedJoinSplits.clear();
+}
+
 void RemoveLelantusJoinSplitReferencingBlock(CTxMemPool& pool, CBlockIndex* blockIndex) {
     LOCK2(cs_main, pool.cs);
     std::vector<CTransaction> txn_to_remove;
@@ -783,7 +848,7 @@ void RemoveLelantusJoinSplitReferencingBlock(CTxMemPool& pool, CBlockIndex* bloc
             // block removed. If any one is equal, remove txn from mempool.
             for (const CTxIn& txin : tx.vin) {
                 if (txin.IsLelantusJoinSplit()) {
-                    std::unique_ptr<lelantus::JoinSplit> joinsplit;
+                    std::shared_ptr<const lelantus::JoinSplit> joinsplit;
 
                     try {
                         joinsplit = ParseLelantusJoinSplit(tx);
@@ -911,18 +976,25 @@ bool ConnectBlockLelantus(
 
         const auto& params = ::Params().GetConsensus();
         CHash256 hash;
-        std::vector<unsigned char> data(GroupElement::serialize_size);
         bool updateHash = false;
 
+        // serializes all coins at once, sharing the field inversion between the points
+        auto writeCoins = [&hash](const std::vector<GroupElement>& values) {
+            std::vector<unsigned char> data(values.size() * GroupElement::serialize_size);
+            GroupElement::serialize(values, data.data());
+            hash.Write(data.data(), data.size());
+        };
+
         // create first anonymity set hash with whole existing set, at HF block
         if (pindexNew->nHeight == params.nLelantusFixesStartBlock) {
             updateHash = true;
             std::vector<lelantus::PublicCoin> coins;
             lelantusState.GetAnonymitySet(1, false, coins);
-            for (auto &coin : coins) {
-                coin.getValue().serialize(data.data());
-                hash.Write(data.data(), data.size());
-            }
+            std::vector<GroupElement> values;
+            values.reserve(coins.size());
+            for (auto &coin : coins)
+                values.push_back(coin.getValue());
+            writeCoins(values);
         }
 
         if (!pblock->lelantusTxInfo->mints.empty()) {
@@ -947,10 +1019,10 @@ bool ConnectBlockLelantus(
                     }
                 }
 
-                for (auto &coin : pindexNew->lelantusMintedPubCoins[latestCoinId]) {
-                    coin.first.getValue().serialize(data.data());
-                    hash.Write(data.data(), data.size());
-                }
+                std::vector<GroupElement> values;
+                for (auto &coin : pindexNew->lelantusMintedPubCoins[latestCoinId])
+                    values.push_back(coin.first.getValue());
+                writeCoins(values);
             }
         }
 
@@ -1039,6 +1111,40 @@ bool GetOutPointFromMintTag(COutPoint& outPoint, const uint256 &pubCoinTag) {
     return GetOutPoint(outPoint, pubCoinValue);
 }
 
+bool GetOutPointsFromMintTags(std::map<uint256, COutPoint>& outPoints, const std::vector<uint256> &pubCoinTags) {
+    lelantus::CLelantusState *lelantusState = lelantus::CLelantusState::GetState();
+
+    // group the coins by mint height so that every block is read only once
+    std::map<int, std::vector<std::pair<uint256, GroupElement>>> mintsByHeight;
+    for (const uint256& pubCoinTag : pubCoinTags) {
+        GroupElement pubCoinValue;
+        if (!lelantusState->HasCoinTag(pubCoinValue, pubCoinTag))
+            continue;
+
+        int mintHeight = lelantusState->GetMintedCoinHeightAndId(lelantus::PublicCoin(pubCoinValue)).first;
+        if (mintHeight == -1)
+            continue;
+
+        mintsByHeight[mintHeight].emplace_back(pubCoinTag, pubCoinValue);
+    }
+
+    for (const auto& heightAndMints : mintsByHeight) {
+        CBlock block;
+        if (!ReadBlockFromDisk(block, chainActive[heightAndMints.first], ::Params().GetConsensus())) {
+            LogPrintf("can't read block from disk.\n");
+            continue;
+        }
+
+        for (const auto& tagAndValue : heightAndMints.second) {
+            COutPoint outPoint;
+            if (GetOutPointFromBlock(outPoint, tagAndValue.second, block))
+                outPoints[tagAndValue.first] = outPoint;
+        }
+    }
+
+    return !outPoints.empty();
+}
+
 bool BuildLelantusStateFromIndex(CChain *chain) {
     for (CBlockIndex *blockIndex = chain->Genesis(); blockIndex; blockIndex=chain->Next(blockIndex))
     {
@@ -1126,6 +1232,34 @@ void CLelantusState::Containers::RemoveExtendedMints(int group) {
     CheckSurgeCondition();
 }
 
+void CLelantusState::Containers::RestoreFromIndex(CChain *chain, std::size_t nMints, std::size_t nSpends, std::map<int, size_t> const & extendedMints) {
+    Reset();
+    mintedPubCoins.reserve(nMints);
+    tagToPublicCoin.reserve(nMints);
+    usedCoinSerials.reserve(nSpends);
+    extendedMintMetaInfo = extendedMints;
+
+    for (CBlockIndex *index = chain->Genesis(); index; index = chain->Next(index)) {
+        for (auto const &pubCoins : index->lelantusMintedPubCoins) {
+            if (pubCoins.second.empty())
+                continue;
+
+            for (auto const &coin : pubCoins.second) {
+                mintedPubCoins.insert(std::make_pair(coin.first, CMintedCoinInfo::make(pubCoins.first, index->nHeight)));
+                tagToPublicCoin.insert(std::make_pair(coin.second, coin.first));
+            }
+            mintMetaInfo[pubCoins.first] += pubCoins.second.size();
+        }
+
+        for (auto const &serial : index->lelantusSpentSerials) {
+            usedCoinSerials[serial.first] = serial.second;
+            spendMetaInfo[serial.second] += 1;
+        }
+    }
+
+    CheckSurgeCondition();
+}
+
 mint_info_container const & CLelantusState::Containers::GetMints() const {
     return mintedPubCoins;
 }
@@ -1138,6 +1272,10 @@ std::unordered_map<Scalar, int> const & CLelantusState::Containers::GetSpends()
     return usedCoinSerials;
 }
 
+std::map<int, size_t> const & CLelantusState::Containers::GetExtendedMints() const {
+    return extendedMintMetaInfo;
+}
+
 bool CLelantusState::Containers::IsSurgeCondition() const {
     return surgeCondition;
 }
@@ -1243,6 +1381,7 @@ void CLelantusState::AddMintsToStateAndBlockIndex(
         newCoinGroup.nCoins = coins + blockMints.size();
 
         containers.AddExtendedMints(latestCoinId, coins);
+        ExtendAnonymitySet(latestCoinId, first);
     }
 
     for (const auto& mint : blockMints) {
@@ -1251,6 +1390,8 @@ void CLelantusState::AddMintsToStateAndBlockIndex(
         LogPrintf("AddMintsToStateAndBlockIndex: Lelantus mint added id=%d\n", latestCoinId);
         index->lelantusMintedPubCoins[latestCoinId].push_back(mint);
     }
+
+    anonymitySets[latestCoinId].AddBlock(index, latestCoinId);
 }
 
 void CLelantusState::AddSpend(const Scalar &serial, int coinGroupId) {
@@ -1274,6 +1415,7 @@ void CLelantusState::AddBlock(CBlockIndex *index) {
                 coinGroup.firstBlock = first ? first : index;
 
                 containers.AddExtendedMints(pubCoins.first, coinGroup.nCoins);
+                ExtendAnonymitySet(pubCoins.first, first);
             }
         }
         coinGroup.lastBlock = index;
@@ -1283,6 +1425,7 @@ void CLelantusState::AddBlock(CBlockIndex *index) {
         for (auto const &coin : pubCoins.second) {
             containers.AddMint(coin.first, CMintedCoinInfo::make(pubCoins.first, index->nHeight), coin.second);
         }
+        anonymitySets[pubCoins.first].AddBlock(index, pubCoins.first);
     }
 
     for (auto const &serial : index->lelantusSpentSerials) {
@@ -1331,6 +1474,7 @@ void CLelantusState::RemoveBlock(CBlockIndex *index) {
             latestCoinId--;
             // erase from containers
             containers.RemoveExtendedMints(coins.first);
+            anonymitySets.erase(coins.first);
         } else {
             // roll back lastBlock to previous position
             assert(coinGroup.lastBlock == index);
@@ -1339,6 +1483,8 @@ void CLelantusState::RemoveBlock(CBlockIndex *index) {
                 assert(coinGroup.lastBlock != coinGroup.firstBlock);
                 coinGroup.lastBlock = coinGroup.lastBlock->pprev;
             } while (coinGroup.lastBlock->lelantusMintedPubCoins.count(coins.first) == 0);
+
+            anonymitySets[coins.first].RemoveBlock(index);
         }
     }
 
@@ -1420,56 +1566,32 @@ int CLelantusState::GetCoinSetForSpend(
 
     coins_out.clear();
 
-    if (coinGroups.count(coinGroupID) == 0) {
+    auto coinSet = anonymitySets.find(coinGroupID);
+    if (coinGroups.count(coinGroupID) == 0 || coinSet == anonymitySets.end()) {
         return 0;
     }
 
-    LelantusCoinGroupInfo &coinGroup = coinGroups[coinGroupID];
-
-    int numberOfCoins = 0;
-    for (CBlockIndex *block = coinGroup.lastBlock;; block = block->pprev) {
-
-        // ignore block heigher than max height
-        if (block->nHeight > maxHeight) {
-            continue;
-        }
+    // latest block satisfying given conditions
+    AnonymitySet::BlockEntry const *lastBlock = coinSet->second.GetLastBlock(maxHeight);
+    if (!lastBlock) {
+        return 0;
+    }
 
-        // check coins in group coinGroupID - 1 in the case that using coins from prev group.
-        int id = 0;
-        if (CountCoinInBlock(block, coinGroupID)) {
-            id = coinGroupID;
-        } else if (CountCoinInBlock(block, coinGroupID - 1)) {
-            id = coinGroupID - 1;
-        }
+    // remember block hash and set hash
+    blockHash_out = lastBlock->block->GetBlockHash();
+    setHash_out = GetAnonymitySetHash(lastBlock->block, lastBlock->coinGroupId);
 
-        if (id) {
-            if (numberOfCoins == 0) {
-                // latest block satisfying given conditions
-                // remember block hash and set hash
-                blockHash_out = block->GetBlockHash();
-                setHash_out =  GetAnonymitySetHash(block, id);
-            }
-            numberOfCoins += block->lelantusMintedPubCoins[id].size();
-            if (block->lelantusMintedPubCoins.count(id) > 0) {
-                for (const auto &coin : block->lelantusMintedPubCoins[id]) {
-                    LOCK(cs_main);
-                    // skip mints from blacklist if nLelantusFixesStartBlock is passed
-                    if (chainActive.Height() >= ::Params().GetConsensus().nLelantusFixesStartBlock) {
-                        if (::Params().GetConsensus().lelantusBlacklist.count(coin.first.getValue()) > 0) {
-                            continue;
-                        }
-                    }
-                    coins_out.push_back(coin.first);
-                }
-            }
-        }
-
-        if (block == coinGroup.firstBlock) {
-            break ;
-        }
+    bool fSkipBlacklisted;
+    {
+        LOCK(cs_main);
+        // skip mints from blacklist if nLelantusFixesStartBlock is passed
+        fSkipBlacklisted = chainActive.Height() >= ::Params().GetConsensus().nLelantusFixesStartBlock;
     }
 
-    return numberOfCoins;
+    auto coins = coinSet->second.GetCoins(*lastBlock, fSkipBlacklisted);
+    coins_out.assign(coins.first, coins.second);
+
+    return lastBlock->coinsEnd;
 }
 
 void CLelantusState::GetAnonymitySet(
@@ -1479,49 +1601,28 @@ void CLelantusState::GetAnonymitySet(
 
     coins_out.clear();
 
-    if (coinGroups.count(coinGroupID) == 0) {
+    auto coinSet = anonymitySets.find(coinGroupID);
+    if (coinGroups.count(coinGroupID) == 0 || coinSet == anonymitySets.end()) {
         return;
     }
 
-    LelantusCoinGroupInfo &coinGroup = coinGroups[coinGroupID];
     const auto &params = ::Params().GetConsensus();
     LOCK(cs_main);
     int maxHeight = fStartLelantusBlacklist ? (chainActive.Height() - (ZC_MINT_CONFIRMATIONS - 1)) : (params.nLelantusFixesStartBlock - 1);
 
-    for (CBlockIndex *block = coinGroup.lastBlock;; block = block->pprev) {
-
-        // ignore block heigher than max height
-        if (block->nHeight > maxHeight) {
-            continue;
-        }
-
-        // check coins in group coinGroupID - 1 in the case that using coins from prev group.
-        int id = 0;
-        if (CountCoinInBlock(block, coinGroupID)) {
-            id = coinGroupID;
-        } else if (CountCoinInBlock(block, coinGroupID - 1)) {
-            id = coinGroupID - 1;
-        }
+    AnonymitySet::BlockEntry const *lastBlock = coinSet->second.GetLastBlock(maxHeight);
+    if (!lastBlock) {
+        return;
+    }
 
-        if (id) {
-            if(block->lelantusMintedPubCoins.count(id) > 0) {
-                for (const auto &coin : block->lelantusMintedPubCoins[id]) {
-                    if (fStartLelantusBlacklist &&
-                        chainActive.Height() >= ::Params().GetConsensus().nLelantusFixesStartBlock) {
-                        std::vector<unsigned char> vch = coin.first.getValue().getvch();
-                        if (::Params().GetConsensus().lelantusBlacklist.count(coin.first.getValue()) > 0) {
-                            continue;
-                        }
-                    }
-                    coins_out.push_back(coin.first);
-                }
-            }
-        }
+    auto coins = coinSet->second.GetCoins(
+        *lastBlock, fStartLelantusBlacklist && chainActive.Height() >= params.nLelantusFixesStartBlock);
+    coins_out.assign(coins.first, coins.second);
+}
 
-        if (block == coinGroup.firstBlock) {
-            break ;
-        }
-    }
+CLelantusState::AnonymitySet const *CLelantusState::GetCachedAnonymitySet(int coinGroupID) const {
+    auto coinSet = anonymitySets.find(coinGroupID);
+    return coinSet != anonymitySets.end() ? &coinSet->second : nullptr;
 }
 
 std::pair<int, int> CLelantusState::GetMintedCoinHeightAndId(
@@ -1582,10 +1683,107 @@ bool CLelantusState::CanAddMintToMempool(const GroupElement& pubCoin){
 
 void CLelantusState::Reset() {
     coinGroups.clear();
+    anonymitySets.clear();
     latestCoinId = 0;
     containers.Reset();
 }
 
+void CLelantusState::WriteSnapshot(CAutoFile& file) const {
+    file << (uint64_t)GetMints().size();
+    file << (uint64_t)GetSpends().size();
+    file << latestCoinId;
+
+    // blocks are referred to by height, the snapshot is only valid for the chain it was written for
+    file << (uint64_t)coinGroups.size();
+    for (auto const &group : coinGroups) {
+        file << group.first;
+        file << (group.second.firstBlock ? group.second.firstBlock->nHeight : -1);
+        file << (group.second.lastBlock ? group.second.lastBlock->nHeight : -1);
+        file << group.second.nCoins;
+    }
+
+    auto const &extendedMints = containers.GetExtendedMints();
+    file << (uint64_t)extendedMints.size();
+    for (auto const &group : extendedMints) {
+        file << group.first;
+        file << (uint64_t)group.second;
+    }
+
+    file << (uint64_t)anonymitySets.size();
+    for (auto const &coinSet : anonymitySets) {
+        file << coinSet.first;
+        file << (uint64_t)coinSet.second.GetBlocks().size();
+        for (auto const &entry : coinSet.second.GetBlocks()) {
+            file << entry.block->nHeight;
+            file << entry.coinGroupId;
+        }
+    }
+}
+
+bool CLelantusState::ReadSnapshot(CAutoFile& file, CChain *chain) {
+    Reset();
+
+    uint64_t nMints, nSpends, nGroups;
+    file >> nMints;
+    file >> nSpends;
+    file >> latestCoinId;
+
+    file >> nGroups;
+    for (uint64_t i = 0; i < nGroups; i++) {
+        int id, firstHeight, lastHeight;
+        file >> id;
+        file >> firstHeight;
+        file >> lastHeight;
+
+        LelantusCoinGroupInfo &coinGroup = coinGroups[id];
+        file >> coinGroup.nCoins;
+        coinGroup.firstBlock = (*chain)[firstHeight];
+        coinGroup.lastBlock = (*chain)[lastHeight];
+        if (!coinGroup.firstBlock || !coinGroup.lastBlock)
+            return false;
+    }
+
+    uint64_t nExtended;
+    std::map<int, size_t> extendedMints;
+    file >> nExtended;
+    for (uint64_t i = 0; i < nExtended; i++) {
+        int id;
+        uint64_t nCoins;
+        file >> id;
+        file >> nCoins;
+        extendedMints[id] = nCoins;
+    }
+
+    uint64_t nSets;
+    file >> nSets;
+    for (uint64_t i = 0; i < nSets; i++) {
+        int id;
+        uint64_t nBlocks;
+        file >> id;
+        file >> nBlocks;
+
+        AnonymitySet &coinSet = anonymitySets[id];
+        for (uint64_t j = 0; j < nBlocks; j++) {
+            int height, coinGroupId;
+            file >> height;
+            file >> coinGroupId;
+
+            CBlockIndex *block = (*chain)[height];
+            if (!block)
+                return false;
+            coinSet.AddBlock(block, coinGroupId);
+        }
+
+        // a block without coins of the group is skipped by AddBlock
+        if (coinSet.GetBlocks().size() != nBlocks)
+            return false;
+    }
+
+    containers.RestoreFromIndex(chain, nMints, nSpends, extendedMints);
+
+    return GetMints().size() == nMints && GetSpends().size() == nSpends;
+}
+
 CLelantusState* CLelantusState::GetState() {
     return &lelantusState;
 }
@@ -1640,6 +1838,80 @@ size_t CLelantusState::CountLastNCoins(int groupId, size_t required, CBlockIndex
     return coins;
 }
 
+void CLelantusState::ExtendAnonymitySet(int groupId, CBlockIndex *first) {
+    AnonymitySet &coinSet = anonymitySets[groupId];
+
+    auto prevSet = anonymitySets.find(groupId - 1);
+    if (!first || prevSet == anonymitySets.end()) {
+        return;
+    }
+
+    for (auto const &entry : prevSet->second.GetBlocks()) {
+        if (entry.coinGroupId == groupId - 1 && entry.block->nHeight >= first->nHeight) {
+            coinSet.AddBlock(entry.block, entry.coinGroupId);
+        }
+    }
+}
+
+// CLelantusState::AnonymitySet
+
+void CLelantusState::AnonymitySet::AddBlock(CBlockIndex *block, int coinGroupId) {
+    auto blockCoins = block->lelantusMintedPubCoins.find(coinGroupId);
+    if (blockCoins == block->lelantusMintedPubCoins.end() || blockCoins->second.empty()) {
+        return;
+    }
+
+    auto const &blacklist = ::Params().GetConsensus().lelantusBlacklist;
+    for (auto coin = blockCoins->second.rbegin(); coin != blockCoins->second.rend(); ++coin) {
+        coins.push_back(coin->first);
+
+        if (blacklist.count(coin->first.getValue()) > 0) {
+            if (!fHasBlacklisted) {
+                // none of the earlier coins is blacklisted
+                filteredCoins.assign(coins.begin(), coins.end() - 1);
+                fHasBlacklisted = true;
+            }
+        } else if (fHasBlacklisted) {
+            filteredCoins.push_back(coin->first);
+        }
+    }
+
+    blocks.push_back({block, coinGroupId, coins.size(), fHasBlacklisted ? filteredCoins.size() : coins.size()});
+}
+
+void CLelantusState::AnonymitySet::RemoveBlock(CBlockIndex *block) {
+    if (blocks.empty() || blocks.back().block != block) {
+        return;
+    }
+
+    blocks.pop_back();
+    std::size_t coinsEnd = blocks.empty() ? 0 : blocks.back().coinsEnd;
+    std::size_t filteredCoinsEnd = blocks.empty() ? 0 : blocks.back().filteredCoinsEnd;
+
+    coins.erase(coins.begin() + coinsEnd, coins.end());
+    if (filteredCoinsEnd == coinsEnd) {
+        filteredCoins.clear();
+        fHasBlacklisted = false;
+    } else {
+        filteredCoins.erase(filteredCoins.begin() + filteredCoinsEnd, filteredCoins.end());
+    }
+}
+
+CLelantusState::AnonymitySet::BlockEntry const *CLelantusState::AnonymitySet::GetLastBlock(int maxHeight) const {
+    auto next = std::upper_bound(blocks.begin(), blocks.end(), maxHeight,
+        [](int height, BlockEntry const &entry) { return height < entry.block->nHeight; });
+
+    return next == blocks.begin() ? nullptr : &*(next - 1);
+}
+
+std::pair<CLelantusState::AnonymitySet::const_iterator, CLelantusState::AnonymitySet::const_iterator>
+CLelantusState::AnonymitySet::GetCoins(BlockEntry const &last, bool fSkipBlacklisted) const {
+    if (fSkipBlacklisted && last.filteredCoinsEnd != last.coinsEnd) {
+        return std::make_pair(filteredCoins.rend() - last.filteredCoinsEnd, filteredCoins.rend());
+    }
+    return std::make_pair(coins.rend() - last.coinsEnd, coins.rend());
+}
+
 // CLelantusMempoolState
 
 bool CLelantusMempoolState::HasCoinSerial(const Scalar& coinSerial) {
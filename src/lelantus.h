@@ -14,6 +14,8 @@
 #include <functional>
 #include "coin_containers.h"
 
+class CAutoFile;
+
 namespace lelantus_mintspend { class lelantus_mintspend_test; }
 
 namespace lelantus {
@@ -50,7 +52,7 @@ void ParseLelantusMintScript(const CScript& script, secp_primitives::GroupElemen
 void ParseLelantusJMintScript(const CScript& script, secp_primitives::GroupElement& pubcoin, std::vector<unsigned char>& encryptedValue);
 void ParseLelantusJMintScript(const CScript& script, secp_primitives::GroupElement& pubcoin, std::vector<unsigned char>& encryptedValue, uint256& mintTag);
 void ParseLelantusMintScript(const CScript& script, secp_primitives::GroupElement& pubcoin);
-std::unique_ptr<JoinSplit> ParseLelantusJoinSplit(const CTransaction& tx);
+std::shared_ptr<const JoinSplit> ParseLelantusJoinSplit(const CTransaction& tx);
 
 size_t GetSpendInputs(const CTransaction &tx, const CTxIn& in);
 size_t GetSpendInputs(const CTransaction &tx);
@@ -69,6 +71,15 @@ bool CheckLelantusTransaction(
     sigma::CSigmaTxInfo* sigmaTxInfo,
 	CLelantusTxInfo* lelantusTxInfo);
 
+/*
+ * Verify the sigma and range proofs of mempool candidate JoinSplits in one batch. Until
+ * ClearBatchVerifiedJoinSplits() is called AcceptToMemoryPool skips the proof verification of those
+ * which passed, all the other checks still apply. Returns false if the batch failed, in which case
+ * every transaction has to be verified on its own to find the invalid one. Requires cs_main.
+ */
+bool BatchVerifyJoinSplits(const std::vector<CTransactionRef>& txs);
+void ClearBatchVerifiedJoinSplits();
+
 void DisconnectTipLelantus(CBlock &block, CBlockIndex *pindexDelete);
 
 bool ConnectBlockLelantus(
@@ -88,10 +99,23 @@ bool GetOutPoint(COutPoint& outPoint, const GroupElement &pubCoinValue);
 bool GetOutPoint(COutPoint& outPoint, const uint256 &pubCoinValueHash);
 // This one gets outpoint from hash of reduced Lelantus commitment
 bool GetOutPointFromMintTag(COutPoint& outPoint, const uint256 &pubCoinTag);
+// Batch version of the above, found outpoints are stored by mint tag and every block is read once
+bool GetOutPointsFromMintTags(std::map<uint256, COutPoint>& outPoints, const std::vector<uint256> &pubCoinTags);
 
 
 bool BuildLelantusStateFromIndex(CChain *chain);
 
+// Hash of the anonymity set of the group as of the given block, empty if there is none
+std::vector<unsigned char> GetAnonymitySetHash(CBlockIndex *index, int group_id, bool generation = false);
+
+// Proof cache key of a joinsplit verified against the given sets, each given by group id as its last block
+// and number of coins, see proofcache.h
+uint256 GetJoinSplitProofKey(
+        const uint256& hashTx,
+        const std::map<uint32_t, std::pair<uint256, uint64_t>>& anonymitySets,
+        const std::vector<std::vector<unsigned char>>& anonymitySetHashes,
+        bool fAfterFixes);
+
 std::vector<Scalar> GetLelantusJoinSplitSerialNumbers(const CTransaction &tx, const CTxIn &txin);
 std::vector<uint32_t> GetLelantusJoinSplitIds(const CTransaction &tx, const CTxIn &txin);
 
@@ -147,6 +171,44 @@ public:
         int nCoins;
     };
 
+    // Anonymity set of a coin group kept as a flat list, appended to when blocks are added and
+    // truncated when they are removed. Every block appends its coins in reverse order, so the set as
+    // of any block is the reversed prefix ending at that block and is read without walking the chain.
+    class AnonymitySet {
+    public:
+        typedef std::vector<lelantus::PublicCoin>::const_reverse_iterator const_iterator;
+
+        struct BlockEntry {
+            CBlockIndex *block;
+            // group the coins were minted in, this group or the previous one
+            int coinGroupId;
+            // end of the block's coins in the full and the blacklist filtered lists
+            std::size_t coinsEnd;
+            std::size_t filteredCoinsEnd;
+        };
+
+    public:
+        void AddBlock(CBlockIndex *block, int coinGroupId);
+        // Remove the block if it is the latest one of the set
+        void RemoveBlock(CBlockIndex *block);
+
+        // Latest block at or below maxHeight, nullptr if there is none
+        BlockEntry const *GetLastBlock(int maxHeight) const;
+
+        // Coins of the set as of the given block in the anonymity set order, optionally without the
+        // blacklisted ones. The range stays valid until the set is changed
+        std::pair<const_iterator, const_iterator> GetCoins(BlockEntry const &last, bool fSkipBlacklisted) const;
+
+        std::vector<BlockEntry> const &GetBlocks() const { return blocks; }
+
+    private:
+        std::vector<lelantus::PublicCoin> coins;
+        // only materialised once the set gets a blacklisted coin, until then it equals coins
+        std::vector<lelantus::PublicCoin> filteredCoins;
+        bool fHasBlacklisted = false;
+        std::vector<BlockEntry> blocks;
+    };
+
 public:
     CLelantusState(
         size_t maxCoinInGroup = ZC_LELANTUS_MAX_MINT_NUM,
@@ -196,12 +258,23 @@ public:
             bool fStartLelantusBlacklist,
             std::vector<lelantus::PublicCoin>& coins_out);
 
+    // Cached anonymity set of the group, nullptr if the group does not exist
+    AnonymitySet const *GetCachedAnonymitySet(int coinGroupID) const;
+
     // Return height of mint transaction and id of minted coin
     std::pair<int, int> GetMintedCoinHeightAndId(const lelantus::PublicCoin& pubCoin);
 
     // Reset to initial values
     void Reset();
 
+    // Write the coin groups and anonymity set layout of the state. The coins are not written, they
+    // are restored from the block index
+    void WriteSnapshot(CAutoFile& file) const;
+
+    // Restore the state written by WriteSnapshot for the tip of the chain without replaying every
+    // block, returns false if the snapshot doesn't match the block index
+    bool ReadSnapshot(CAutoFile& file, CChain *chain);
+
     // Check if there is a conflicting tx in the blockchain or mempool
     bool CanAddSpendToMempool(const Scalar& coinSerial);
 
@@ -236,6 +309,9 @@ public:
 private:
     size_t CountLastNCoins(int groupId, size_t required, CBlockIndex* &first);
 
+    // Start the cached set of a new group with the last coins of the previous one, beginning at first
+    void ExtendAnonymitySet(int groupId, CBlockIndex *first);
+
 private:
     // Group Limit
     size_t maxCoinInGroup;
@@ -244,6 +320,9 @@ private:
     // Collection of coin groups. Map from id to LelantusCoinGroupInfo structure
     std::unordered_map<int, LelantusCoinGroupInfo> coinGroups;
 
+    // Anonymity set of every coin group, kept in sync with coinGroups
+    std::unordered_map<int, AnonymitySet> anonymitySets;
+
     // Latest anonymity set id;
     int latestCoinId;
 
@@ -263,8 +342,12 @@ private:
 
         void Reset();
 
+        // Add every mint and spend of the chain in one pass, checking the surge condition once
+        void RestoreFromIndex(CChain *chain, std::size_t nMints, std::size_t nSpends, std::map<int, size_t> const & extendedMints);
+
         mint_info_container const & GetMints() const;
         std::unordered_map<Scalar, int> const & GetSpends() const;
+        std::map<int, size_t> const & GetExtendedMints() const;
         std::unordered_map<uint256, lelantus::PublicCoin>& GetTagToPublicCoin();
         bool IsSurgeCondition() const;
     private:
@@ -28,9 +28,9 @@ public:
 
     void add(const std::vector<GroupElement>& group_elements) {
         addSize(group_elements.size());
-        for (size_t i = 0; i < group_elements.size(); ++i) {
-            add(group_elements[i]);
-        }
+        std::vector<unsigned char> buffer(group_elements.size() * GroupElement::serialize_size);
+        GroupElement::serialize(group_elements, buffer.data());
+        hash.Write(buffer.data(), buffer.size());
     }
 
     void add(const Scalar& scalar) {
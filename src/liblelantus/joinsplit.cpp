@@ -191,27 +191,27 @@ uint256 JoinSplit::signatureHash(const SpendMetaData& m, size_t coutSize) const
     return h.GetHash();
 }
 
-const std::vector<uint32_t>& JoinSplit::getCoinGroupIds() {
+const std::vector<uint32_t>& JoinSplit::getCoinGroupIds() const {
     return this->groupIds;
 }
 
-const std::vector<std::pair<uint32_t, uint256>>& JoinSplit::getIdAndBlockHashes() {
+const std::vector<std::pair<uint32_t, uint256>>& JoinSplit::getIdAndBlockHashes() const {
     return this->coinGroupIdAndBlockHash;
 }
 
-const std::vector<Scalar>& JoinSplit::getCoinSerialNumbers() {
+const std::vector<Scalar>& JoinSplit::getCoinSerialNumbers() const {
     return this->serialNumbers;
 }
 
-const LelantusProof& JoinSplit::getLelantusProof() {
+const LelantusProof& JoinSplit::getLelantusProof() const {
     return this->lelantusProof;
 }
 
-uint64_t JoinSplit::getFee() {
+uint64_t JoinSplit::getFee() const {
     return this->fee;
 }
 
-bool JoinSplit::getIndex(const PublicCoin& coin, const std::vector<PublicCoin>& anonymity_set, size_t& index) {
+bool JoinSplit::getIndex(const PublicCoin& coin, const std::vector<PublicCoin>& anonymity_set, size_t& index) const {
     for (std::size_t j = 0; j < anonymity_set.size(); ++j) {
         if(anonymity_set[j] == coin){
             index = j;
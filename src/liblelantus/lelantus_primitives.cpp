@@ -65,6 +65,13 @@ void LelantusPrimitives::commit(const GroupElement& g,
     result_out = g * r + mult.get_multiple();
 }
 
+void LelantusPrimitives::commit(const FixedBaseTable& gens,
+                                const std::vector<Scalar>& exp,
+                                const Scalar& r,
+                                GroupElement& result_out) {
+    result_out = gens.multiply(0, r) + gens.multi_multiply(1, exp);
+}
+
 GroupElement LelantusPrimitives::commit(
         const GroupElement& g,
         const Scalar& m,
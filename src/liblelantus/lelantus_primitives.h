@@ -4,6 +4,7 @@
 #include <secp256k1/include/Scalar.h>
 #include <secp256k1/include/GroupElement.h>
 #include <secp256k1/include/MultiExponent.h>
+#include <secp256k1/include/FixedBaseTable.h>
 #include "sigmaextended_proof.h"
 #include "lelantus_proof.h"
 #include "schnorr_proof.h"
@@ -66,6 +67,13 @@ public:
             const Scalar& r,
             GroupElement& result_out);
 
+    // Same commitment with g and h taken from a table of [g, h...]
+    static void commit(
+            const FixedBaseTable& gens,
+            const std::vector<Scalar>& exp,
+            const Scalar& r,
+            GroupElement& result_out);
+
     static void convert_to_sigma(std::size_t num, std::size_t n, std::size_t m, std::vector<Scalar>& out);
 
     static std::vector<std::size_t> convert_to_nal(std::size_t num, std::size_t n, std::size_t m);
@@ -1,5 +1,5 @@
 #include "lelantus_prover.h"
-#include "threadpool.h"
+#include "../proofthreadpool.h"
 #include "util.h"
 
 namespace lelantus {
@@ -85,7 +85,8 @@ void LelantusProver::generate_sigma_proofs(
         std::vector<Scalar>& Yk_sum,
         std::vector<SigmaExtendedProof>& sigma_proofs,
         SchnorrProof& qkSchnorrProof) {
-    SigmaExtendedProver sigmaProver(params->get_g(), params->get_sigma_h(), params->get_sigma_n(), params->get_sigma_m());
+    SigmaExtendedProver sigmaProver(
+        params->get_g(), params->get_sigma_h(), params->get_sigma_n(), params->get_sigma_m(), &params->get_sigma_table());
     sigma_proofs.resize(Cin.size());
     std::size_t N = Cin.size();
     std::vector<Scalar> rA, rB, rC, rD;
@@ -104,78 +105,57 @@ void LelantusProver::generate_sigma_proofs(
     std::vector<Scalar> serialNumbers;
     serialNumbers.reserve(N);
 
-    std::size_t threadsMaxCount = std::min((unsigned int)N, boost::thread::hardware_concurrency());
-    std::vector<boost::shared_future<bool>> parallelTasks;
-    parallelTasks.reserve(threadsMaxCount);
-    ParallelOpThreadPool<bool> threadPool(threadsMaxCount);
+    ProofThreadPool& threadPool = ProofThreadPool::GetInstance();
+    std::vector<std::future<bool>> parallelTasks;
+    parallelTasks.reserve(N);
 
     std::vector<std::vector<GroupElement>> C_;
     C_.resize(N);
     DoNotDisturb dnd;
-    for (std::size_t j = 0; j < N; j += threadsMaxCount) {
-        for (std::size_t i = j; i < j + threadsMaxCount; ++i) {
-            if (i < N) {
-                if (!c.count(Cin[i].second))
-                    throw std::invalid_argument("No such anonymity set or id is not correct");
-
-                GroupElement gs = (params->get_g() * Cin[i].first.getSerialNumber().negate());
-                serialNumbers.emplace_back(Cin[i].first.getSerialNumber());
-
-                C_[i].reserve(c.size());
-
-                const auto& set = c.find(Cin[i].second);
-                if (set == c.end())
-                    throw std::invalid_argument("No such anonymity set");
-
-                for (auto const &coin : set->second)
-                    C_[i].emplace_back(coin.getValue() + gs);
-
-                rA[i].randomize();
-                rB[i].randomize();
-                rC[i].randomize();
-                rD[i].randomize();
-                Tk[i].resize(params->get_sigma_m());
-                Pk[i].resize(params->get_sigma_m());
-                Yk[i].resize(params->get_sigma_m());
-                a[i].resize(params->get_sigma_n() * params->get_sigma_m());
-
-                auto& sigma_i = sigma[i];
-                auto& rA_i = rA[i];
-                auto& rB_i = rB[i];
-                auto& rC_i = rC[i];
-                auto& rD_i = rD[i];
-                auto& a_i = a[i];
-                auto& Tk_i = Tk[i];
-                auto& Pk_i = Pk[i];
-                auto& Yk_i = Yk[i];
-                auto& prover = sigmaProver;
-                auto& commits = C_[i];
-                auto& index = indexes[i];
-                auto& proof = sigma_proofs[i];
-                parallelTasks.emplace_back(threadPool.PostTask([&]() {
-                    try {
-                        prover.sigma_commit(commits, index, rA_i, rB_i, rC_i, rD_i, a_i, Tk_i, Pk_i, Yk_i, sigma_i, proof);
-                    } catch (...) {
-                        return false;
-                    }
-                    return true;
-                }));
-            } else
-                break;
-        }
-
-        bool isFail = false;
-        for (auto& th : parallelTasks) {
-            if (!th.get())
-                isFail = true;
-        }
+    // check all the sets before posting tasks, which reference the local containers
+    for (std::size_t i = 0; i < N; ++i) {
+        if (!c.count(Cin[i].second))
+            throw std::invalid_argument("No such anonymity set or id is not correct");
+    }
 
-        if (isFail)
-            throw std::runtime_error("Lelantus proof creation failed.");
+    for (std::size_t i = 0; i < N; ++i) {
+        GroupElement gs = (params->get_g() * Cin[i].first.getSerialNumber().negate());
+        serialNumbers.emplace_back(Cin[i].first.getSerialNumber());
+
+        C_[i].reserve(c.size());
+
+        const auto& set = c.find(Cin[i].second);
+        for (auto const &coin : set->second)
+            C_[i].emplace_back(coin.getValue() + gs);
+
+        rA[i].randomize();
+        rB[i].randomize();
+        rC[i].randomize();
+        rD[i].randomize();
+        Tk[i].resize(params->get_sigma_m());
+        Pk[i].resize(params->get_sigma_m());
+        Yk[i].resize(params->get_sigma_m());
+        a[i].resize(params->get_sigma_n() * params->get_sigma_m());
+
+        parallelTasks.emplace_back(threadPool.PostTask([&, i]() {
+            try {
+                sigmaProver.sigma_commit(C_[i], indexes[i], rA[i], rB[i], rC[i], rD[i], a[i], Tk[i], Pk[i], Yk[i], sigma[i], sigma_proofs[i]);
+            } catch (...) {
+                return false;
+            }
+            return true;
+        }));
+    }
 
-        parallelTasks.clear();
+    bool isFail = false;
+    for (auto& th : parallelTasks) {
+        if (!threadPool.WaitFor(th))
+            isFail = true;
     }
 
+    if (isFail)
+        throw std::runtime_error("Lelantus proof creation failed.");
+
     std::vector<GroupElement> PubcoinsOut;
     PubcoinsOut.reserve(Cout.size());
     for(auto coin : Cout)
@@ -274,7 +254,7 @@ void LelantusProver::generate_bulletproofs(
     g_.insert(g_.end(), params->get_bulletproofs_g().begin(), params->get_bulletproofs_g().begin() + (n * m));
     h_.insert(h_.end(), params->get_bulletproofs_h().begin(), params->get_bulletproofs_h().begin() + (n * m));
 
-    RangeProver rangeProver(params->get_h1(), params->get_h0(), params->get_g(), g_, h_, n, version);
+    RangeProver rangeProver(params->get_h1(), params->get_h0(), params->get_g(), g_, h_, n, version, &params->get_range_table());
     rangeProver.proof(v_s, serials, randoms, commitments, bulletproofs);
 
 }
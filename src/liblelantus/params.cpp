@@ -130,4 +130,24 @@ const GroupElement& Params::get_h1_limit_range() const {
     return h1_limit_range;
 }
 
+const FixedBaseTable& Params::get_sigma_table() const {
+    std::call_once(sigma_table_flag, [this]() {
+        std::vector<GroupElement> generators;
+        generators.reserve(h_sigma.size() + 1);
+        generators.emplace_back(g);
+        generators.insert(generators.end(), h_sigma.begin(), h_sigma.end());
+        sigma_table.reset(new FixedBaseTable(generators));
+    });
+    return *sigma_table;
+}
+
+const FixedBaseTable& Params::get_range_table() const {
+    std::call_once(range_table_flag, [this]() {
+        std::vector<GroupElement> generators = {get_h1(), get_h0(), g};
+        generators.insert(generators.end(), h_rangeProof.begin(), h_rangeProof.begin() + 2 * n_rangeProof);
+        range_table.reset(new FixedBaseTable(generators));
+    });
+    return *range_table;
+}
+
 } //namespace lelantus
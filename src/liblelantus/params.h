@@ -3,9 +3,13 @@
 
 #include <secp256k1/include/Scalar.h>
 #include <secp256k1/include/GroupElement.h>
+#include <secp256k1/include/FixedBaseTable.h>
 #include <serialize.h>
 #include <sync.h>
 
+#include <memory>
+#include <mutex>
+
 using namespace secp_primitives;
 
 namespace lelantus {
@@ -26,6 +30,12 @@ public:
     const Scalar& get_limit_range() const;
     const GroupElement& get_h1_limit_range() const;
 
+    // Precomputed generator tables for the provers, built on first use
+    // [g, h_sigma...], used by SigmaExtendedProver
+    const FixedBaseTable& get_sigma_table() const;
+    // [h1, h0, g, bulletproofs_h...] used by RangeProver, covering the h generators of two aggregated outputs
+    const FixedBaseTable& get_range_table() const;
+
 private:
     Params(const GroupElement& g_sigma_, int n, int m, int n_rangeProof_, int max_m_rangeProof_);
 
@@ -46,6 +56,11 @@ private:
     std::vector<GroupElement> h_rangeProof;
     Scalar limit_range;
     GroupElement h1_limit_range;
+
+    mutable std::once_flag sigma_table_flag;
+    mutable std::unique_ptr<FixedBaseTable> sigma_table;
+    mutable std::once_flag range_table_flag;
+    mutable std::unique_ptr<FixedBaseTable> range_table;
 };
 
 } // namespace lelantus
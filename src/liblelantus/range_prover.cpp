@@ -10,7 +10,8 @@ RangeProver::RangeProver(
         const std::vector<GroupElement>& g_vector,
         const std::vector<GroupElement>& h_vector,
         std::size_t n,
-        unsigned int v)
+        unsigned int v,
+        const FixedBaseTable* table)
         : g (g)
         , h1 (h1)
         , h2 (h2)
@@ -18,7 +19,31 @@ RangeProver::RangeProver(
         , h_(h_vector)
         , n (n)
         , version (v)
-{}
+        , table (table)
+{
+    // the table must be built for this prover's generators, though it may cover only a prefix of them
+    if (table) {
+        std::size_t covered = std::min(table->size(), h_.size() + 3);
+        for (std::size_t i = 0; i < covered; ++i)
+            assert(table->get_generator(i) == generator(i));
+    }
+}
+
+const GroupElement& RangeProver::generator(std::size_t index) const {
+    switch (index) {
+        case 0: return g;
+        case 1: return h1;
+        case 2: return h2;
+        default: return h_[index - 3];
+    }
+}
+
+GroupElement RangeProver::fixed_multiply(std::size_t index, const Scalar& exp) const {
+    if (table && index < table->size())
+        return table->multiply(index, exp);
+
+    return generator(index) * exp;
+}
 
 void RangeProver::proof(
         const std::vector<Scalar>& v,
@@ -60,7 +85,9 @@ void RangeProver::proof(
 
     Scalar alpha;
     alpha.randomize();
-    LelantusPrimitives::commit(h1, alpha, g_, aL, h_, aR, proof_out.A);
+    proof_out.A += fixed_multiply(1, alpha)
+        + secp_primitives::MultiExponent(g_, aL).get_multiple()
+        + secp_primitives::MultiExponent(h_, aR).get_multiple();
 
     std::vector<Scalar> sL, sR;
     sL.resize(n * m);
@@ -73,7 +100,9 @@ void RangeProver::proof(
 
     Scalar ro;
     ro.randomize();
-    LelantusPrimitives::commit(h1, ro, g_, sL, h_, sR, proof_out.S);
+    proof_out.S += fixed_multiply(1, ro)
+        + secp_primitives::MultiExponent(g_, sL).get_multiple()
+        + secp_primitives::MultiExponent(h_, sR).get_multiple();
 
     Scalar y, z;
     std::unique_ptr<ChallengeGenerator> challengeGenerator;
@@ -143,8 +172,8 @@ void RangeProver::proof(
     T_12.randomize();
     T_21.randomize();
     T_22.randomize();
-    proof_out.T1 = LelantusPrimitives::double_commit(g, t1, h1, T_11, h2, T_21);
-    proof_out.T2 = LelantusPrimitives::double_commit(g, t2, h1, T_12, h2, T_22);
+    proof_out.T1 = fixed_multiply(0, t1) + fixed_multiply(1, T_11) + fixed_multiply(2, T_21);
+    proof_out.T2 = fixed_multiply(0, t2) + fixed_multiply(1, T_12) + fixed_multiply(2, T_22);
 
     Scalar x;
     challengeGenerator->add({proof_out.T1, proof_out.T2});
@@ -171,7 +200,7 @@ void RangeProver::proof(
     NthPower y_i_inv(y.inverse());
     for (std::size_t i = 0; i < h_.size(); ++i)
     {
-        h_prime.emplace_back(h_[i] * y_i_inv.pow);
+        h_prime.emplace_back(fixed_multiply(i + 3, y_i_inv.pow));
         y_i_inv.go_next();
     }
 
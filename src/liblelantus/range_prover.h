@@ -14,7 +14,8 @@ public:
             , const std::vector<GroupElement>& g_vector
             , const std::vector<GroupElement>& h_vector
             , std::size_t n
-            , unsigned int v);
+            , unsigned int v
+            , const FixedBaseTable* table = nullptr);
 
     // commitments are included into transcript if version >= LELANTUS_TX_VERSION_4_5
     void proof(
@@ -24,6 +25,13 @@ public:
             , const std::vector<GroupElement>& commitments
             , RangeProof& proof_out);
 
+private:
+    // the generators [g, h1, h2, h_...] by index
+    const GroupElement& generator(std::size_t index) const;
+
+    // generator * exp for the generators [g, h1, h2, h_...], from the table when it covers the generator
+    GroupElement fixed_multiply(std::size_t index, const Scalar& exp) const;
+
 private:
     GroupElement g;
     GroupElement h1;
@@ -32,6 +40,8 @@ private:
     std::vector<GroupElement> h_;
     std::size_t n;
     unsigned int version;
+    // optional precomputed table of [g, h1, h2, h_...], it may cover only a prefix of h_
+    const FixedBaseTable* table;
 
 };
 
@@ -1,5 +1,6 @@
 #include "range_verifier.h"
 #include "challenge_generator_impl.h"
+#include "../proofthreadpool.h"
 
 // This is based on the 1 Jul 2018 revision of the Bulletproofs preprint:
 // https://eprint.iacr.org/2017/1066
@@ -33,6 +34,14 @@ bool RangeVerifier::verify(const std::vector<GroupElement>& V, const std::vector
 }
 
 bool RangeVerifier::verify(const std::vector<std::vector<GroupElement> >& V, const std::vector<std::vector<GroupElement> >& commitments, const std::vector<RangeProof>& proofs) {
+    RangeProofBatch batch;
+    if (!add_to_batch(V, commitments, proofs, batch))
+        return false;
+
+    return verify_batch(batch);
+}
+
+bool RangeVerifier::add_to_batch(const std::vector<std::vector<GroupElement> >& V, const std::vector<std::vector<GroupElement> >& commitments, const std::vector<RangeProof>& proofs, RangeProofBatch& batch) {
     // Preprocess all proofs
     if (V.size() != commitments.size() || commitments.size() != proofs.size()) {
         return false;
@@ -46,7 +55,7 @@ bool RangeVerifier::verify(const std::vector<std::vector<GroupElement> >& V, con
 
         // Require a power of 2 (if no commitments, valid by default)
         if (m == 0) {
-            return true;
+            continue;
         }
         if ((m & (m - 1)) != 0) {
             return false;
@@ -77,26 +86,21 @@ bool RangeVerifier::verify(const std::vector<std::vector<GroupElement> >& V, con
         return false;
     }
 
-    // Set up final multiscalar multiplication and common scalars
-    std::vector<GroupElement> points;
-    std::vector<Scalar> scalars;
-    Scalar g_scalar(uint64_t(0));
-    Scalar h1_scalar(uint64_t(0));
-    Scalar h2_scalar(uint64_t(0));
-
-    // Elements from g- and h-vectors are interleaved in order at the start of the final vectors
-    for (std::size_t i = 0; i < max_m*n; i++) {
-        points.emplace_back(g_[i]);
-        scalars.emplace_back(uint64_t(0));
-        points.emplace_back(h_[i]);
-        scalars.emplace_back(uint64_t(0));
+    // Elements from g- and h-vectors are shared by all proofs in the batch
+    if (batch.g_scalars.size() < max_m*n) {
+        batch.g_scalars.resize(max_m*n, Scalar(uint64_t(0)));
+        batch.h_scalars.resize(max_m*n, Scalar(uint64_t(0)));
     }
+    std::vector<GroupElement>& points = batch.points;
+    std::vector<Scalar>& scalars = batch.scalars;
 
     // Process each proof and add to the batch
     for (std::size_t k_proofs = 0; k_proofs < N_proofs; k_proofs++) {
-        const RangeProof proof = proofs[k_proofs];
+        const RangeProof& proof = proofs[k_proofs];
         const std::size_t m = V[k_proofs].size(); // number of aggregated inputs
         const std::size_t log_mn = proof.innerProductProof.L_.size(); // round count
+        if (m == 0)
+            continue;
 
         // Choose random nonzero weights for batching purposes
         // Each weight is used for one of the two verifier equations (98 and 105)
@@ -209,10 +213,10 @@ bool RangeVerifier::verify(const std::vector<std::vector<GroupElement> >& V, con
                 }
 
                 // g-vector
-                scalars[2*i] += (x_il * innerProductProof.a_ + z) * w2;
+                batch.g_scalars[i] += (x_il * innerProductProof.a_ + z) * w2;
 
                 // h-vector
-                scalars[2*i + 1] += (y_n_.pow * (x_ir * innerProductProof.b_ - (z_j.pow * two_n[k])) - z) * w2;
+                batch.h_scalars[i] += (y_n_.pow * (x_ir * innerProductProof.b_ - (z_j.pow * two_n[k])) - z) * w2;
 
                 y_n_.go_next();
             }
@@ -220,11 +224,11 @@ bool RangeVerifier::verify(const std::vector<std::vector<GroupElement> >& V, con
         }
 
         // Update common scalars
-        g_scalar += (innerProductProof.c_ - delta) * w1;
-        g_scalar += x_u * (innerProductProof.a_ * innerProductProof.b_ - innerProductProof.c_) * w2;
-        h1_scalar += proof.T_x1 * w1;
-        h1_scalar += proof.u * w2;
-        h2_scalar += proof.T_x2 * w1;
+        batch.g_scalar += (innerProductProof.c_ - delta) * w1;
+        batch.g_scalar += x_u * (innerProductProof.a_ * innerProductProof.b_ - innerProductProof.c_) * w2;
+        batch.h1_scalar += proof.T_x1 * w1;
+        batch.h1_scalar += proof.u * w2;
+        batch.h2_scalar += proof.T_x2 * w1;
 
         // Add per-proof elements
         points.emplace_back(proof.A);
@@ -245,20 +249,51 @@ bool RangeVerifier::verify(const std::vector<std::vector<GroupElement> >& V, con
         }
     }
 
+    return true;
+}
+
+bool RangeVerifier::verify_batch(const RangeProofBatch& batch) {
+    std::vector<GroupElement> points;
+    std::vector<Scalar> scalars;
+    std::size_t size = batch.g_scalars.size();
+    if (size > g_.size() || size > h_.size() || batch.h_scalars.size() != size)
+        return false;
+
+    points.reserve(2 * size + batch.points.size() + 3);
+    scalars.reserve(2 * size + batch.scalars.size() + 3);
+
+    // Elements from g- and h-vectors are interleaved in order at the start of the final vectors
+    for (std::size_t i = 0; i < size; i++) {
+        points.emplace_back(g_[i]);
+        scalars.emplace_back(batch.g_scalars[i]);
+        points.emplace_back(h_[i]);
+        scalars.emplace_back(batch.h_scalars[i]);
+    }
+    points.insert(points.end(), batch.points.begin(), batch.points.end());
+    scalars.insert(scalars.end(), batch.scalars.begin(), batch.scalars.end());
+
     // Add common elements
     points.emplace_back(g);
-    scalars.emplace_back(g_scalar);
+    scalars.emplace_back(batch.g_scalar);
     points.emplace_back(h1);
-    scalars.emplace_back(h1_scalar);
+    scalars.emplace_back(batch.h1_scalar);
     points.emplace_back(h2);
-    scalars.emplace_back(h2_scalar);
+    scalars.emplace_back(batch.h2_scalar);
 
     // Perform the batch check
+    ProofThreadPool& threadPool = ProofThreadPool::GetInstance();
+    std::size_t chunks = std::min(threadPool.GetNumberOfThreads(), points.size() / minParallelRange);
     secp_primitives::MultiExponent mult(points, scalars);
-    if(!mult.get_multiple().isInfinity()) {
-        return false;
+    GroupElement result;
+    if (chunks <= 1) {
+        result = mult.get_multiple();
+    } else {
+        result = mult.get_multiple_parallel(chunks, [&threadPool](const std::vector<std::function<void()>>& jobs) {
+            threadPool.RunAll(jobs);
+        });
     }
-    return true;
+
+    return result.isInfinity();
 }
 
 // Note: the infinity/zero checks are not required by the protocol; they are only included for historical implementation reasons
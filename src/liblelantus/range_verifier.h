@@ -5,6 +5,19 @@
 
 namespace lelantus {
 
+// Terms of one randomised batch check, proofs of every transcript version can be folded into the same batch
+struct RangeProofBatch {
+    std::vector<Scalar> g_scalars;
+    std::vector<Scalar> h_scalars;
+    Scalar g_scalar;
+    Scalar h1_scalar;
+    Scalar h2_scalar;
+
+    // per-proof elements
+    std::vector<GroupElement> points;
+    std::vector<Scalar> scalars;
+};
+
 class RangeVerifier {
 public:
     //g_vector and h_vector are being kept by reference, be sure it will not be modified from outside
@@ -21,9 +34,18 @@ public:
     bool verify(const std::vector<GroupElement>& V, const std::vector<GroupElement>& commitments, const RangeProof& proof); // single proof
     bool verify(const std::vector<std::vector<GroupElement> >& V, const std::vector<std::vector<GroupElement> >& commitments, const std::vector<RangeProof>& proof); // batch of proofs
 
+    // Folds the proofs into the batch with fresh random weights, the batch must be dropped if this fails
+    bool add_to_batch(const std::vector<std::vector<GroupElement> >& V, const std::vector<std::vector<GroupElement> >& commitments, const std::vector<RangeProof>& proofs, RangeProofBatch& batch);
+    // Single multiscalar multiplication over everything folded into the batch, split across the proof threads when large
+    bool verify_batch(const RangeProofBatch& batch);
+
 private:
     bool membership_checks(const RangeProof& proof);
 
+private:
+    // smallest number of points worth a separate multiexponentiation job
+    static const std::size_t minParallelRange = 1024;
+
 private:
     GroupElement g;
     GroupElement h1;
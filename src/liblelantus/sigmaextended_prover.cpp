@@ -6,11 +6,24 @@ SigmaExtendedProver::SigmaExtendedProver(
         const GroupElement& g,
         const std::vector<GroupElement>& h_gens,
         std::size_t n,
-        std::size_t m)
+        std::size_t m,
+        const FixedBaseTable* table)
         : g_(g)
         , h_(h_gens)
         , n_(n)
-        , m_(m) {
+        , m_(m)
+        , table_(table) {
+}
+
+void SigmaExtendedProver::commit(const std::vector<Scalar>& exp, const Scalar& r, GroupElement& result_out) const {
+    if (table_)
+        LelantusPrimitives::commit(*table_, exp, r, result_out);
+    else
+        LelantusPrimitives::commit(g_, h_, exp, r, result_out);
+}
+
+GroupElement SigmaExtendedProver::multiply_h(std::size_t i, const Scalar& exp) const {
+    return table_ ? table_->multiply(i + 1, exp) : h_[i] * exp;
 }
 
 // Generate the initial portion of a one-of-many proof
@@ -46,6 +59,9 @@ void SigmaExtendedProver::sigma_commit(
     if (h_.size() != n_ * m_) {
         throw std::invalid_argument("Generator vector size is invalid");
     }
+    if (table_ && table_->size() != n_ * m_ + 1) {
+        throw std::invalid_argument("Generator table size is invalid");
+    }
 
     LelantusPrimitives::convert_to_sigma(l, n_, m_, sigma);
     for (std::size_t k = 0; k < m_; ++k)
@@ -56,7 +72,7 @@ void SigmaExtendedProver::sigma_commit(
     }
 
     //compute B
-    LelantusPrimitives::commit(g_, h_, sigma, rB, proof_out.B_);
+    commit(sigma, rB, proof_out.B_);
 
     //compute A
     for (std::size_t j = 0; j < m_; ++j)
@@ -67,7 +83,7 @@ void SigmaExtendedProver::sigma_commit(
             a[j * n_] -= a[j * n_ + i];
         }
     }
-    LelantusPrimitives::commit(g_, h_, a, rA, proof_out.A_);
+    commit(a, rA, proof_out.A_);
 
     //compute C
     std::vector<Scalar> c;
@@ -78,7 +94,7 @@ void SigmaExtendedProver::sigma_commit(
     {
         c[i] = a[i] * (one - two * sigma[i]);
     }
-    LelantusPrimitives::commit(g_,h_, c, rC, proof_out.C_);
+    commit(c, rC, proof_out.C_);
 
     //compute D
     std::vector<Scalar> d;
@@ -87,7 +103,7 @@ void SigmaExtendedProver::sigma_commit(
     {
         d[i] = a[i].square().negate();
     }
-    LelantusPrimitives::commit(g_,h_, d, rD, proof_out.D_);
+    commit(d, rD, proof_out.D_);
 
     std::vector<std::vector<Scalar>> P_i_k;
     P_i_k.resize(setSize);
@@ -162,8 +178,8 @@ void SigmaExtendedProver::sigma_commit(
         }
         secp_primitives::MultiExponent mult(commits, P_i);
         GroupElement c_k = mult.get_multiple();
-        proof_out.Gk_.emplace_back(c_k + h_[0] * Yk[k].negate());
-        proof_out.Qk.emplace_back(LelantusPrimitives::double_commit(g_, Scalar(uint64_t(0)), h_[1], Pk[k], h_[0], Tk[k]) + h_[0] * Yk[k]);
+        proof_out.Gk_.emplace_back(c_k + multiply_h(0, Yk[k].negate()));
+        proof_out.Qk.emplace_back(multiply_h(1, Pk[k]) + multiply_h(0, Tk[k] + Yk[k]));
 
     }
 }
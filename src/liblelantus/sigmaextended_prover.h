@@ -8,8 +8,10 @@ namespace lelantus {
 class SigmaExtendedProver{
 
 public:
+    // table is an optional precomputed table of [g, h_gens...]
     SigmaExtendedProver(const GroupElement& g,
-                    const std::vector<GroupElement>& h_gens, std::size_t n, std::size_t m);
+                    const std::vector<GroupElement>& h_gens, std::size_t n, std::size_t m,
+                    const FixedBaseTable* table = nullptr);
 
     void sigma_commit(
             const std::vector<GroupElement>& commits,
@@ -40,11 +42,16 @@ public:
             SigmaExtendedProof& proof_out);
 
 
+private:
+    void commit(const std::vector<Scalar>& exp, const Scalar& r, GroupElement& result_out) const;
+    GroupElement multiply_h(std::size_t i, const Scalar& exp) const;
+
 private:
     GroupElement g_;
     std::vector<GroupElement> h_;
     std::size_t n_;
     std::size_t m_;
+    const FixedBaseTable* table_;
 };
 
 }//namespace lelantus
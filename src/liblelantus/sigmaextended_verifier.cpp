@@ -1,4 +1,5 @@
 #include "sigmaextended_verifier.h"
+#include "../proofthreadpool.h"
 #include "util.h"
 
 namespace lelantus {
@@ -156,22 +157,72 @@ bool SigmaExtendedVerifier::verify(
         }
     }
 
+    // Per-proof challenges, verifier weights, f-matrices and effective set sizes, computed up front so
+    // the commitment scalars below can be filled in parallel by index range
+    std::vector<Scalar> w1s(M), w2s(M), w3s(M);
+    std::vector<std::vector<Scalar>> fs(M);
+    std::vector<std::size_t> effectiveSetSizes(M);
+    for (std::size_t t = 0; t < M; t++) {
+        // The challenge depends on whether or not we're in common mode
+        const Scalar& x = commonChallenge ? challenges[0] : challenges[t];
+
+        // Generate random verifier weights
+        w1s[t].randomize();
+        w2s[t].randomize();
+        w3s[t].randomize();
+
+        // Reconstruct f-matrix
+        if (!compute_fs(proofs[t], x, fs[t])) {
+            LogPrintf("Invalid matrix reconstruction");
+            return false;
+        }
+
+        // Effective set size
+        effectiveSetSizes[t] = specifiedSetSizes ? setSizes[t] : commits.size();
+        if (effectiveSetSizes[t] == 0 || effectiveSetSizes[t] > commits.size()) {
+            LogPrintf("Invalid set size");
+            return false;
+        }
+    }
+
+    // The anonymity set sized part: every proof contributes f_i * w3 to the commitment scalars of
+    // its set. Split the commitment list into ranges, each task handles its range for all proofs
+    ProofThreadPool& threadPool = ProofThreadPool::GetInstance();
+    std::size_t rangeCount = std::max<std::size_t>(1, std::min(threadPool.GetNumberOfThreads(), commits.size() / minParallelRange));
+    std::size_t rangeSize = (commits.size() + rangeCount - 1) / rangeCount;
+
+    std::vector<Scalar> commit_scalars(commits.size(), Scalar(uint64_t(0))); // associated to commitment list
+    std::vector<std::vector<Scalar>> e_parts(rangeCount, std::vector<Scalar>(M, Scalar(uint64_t(0))));
+    std::vector<std::future<void>> parallelTasks;
+    parallelTasks.reserve(rangeCount);
+    for (std::size_t r = 0; r < rangeCount; r++) {
+        parallelTasks.emplace_back(threadPool.PostTask([&, r]() {
+            std::size_t lo = r * rangeSize;
+            std::size_t hi = std::min(commits.size(), lo + rangeSize);
+            for (std::size_t t = 0; t < M; t++) {
+                // Leaves [0, setSize - 1) of the proof's tree map to commitments starting at start
+                std::size_t start = commits.size() - effectiveSetSizes[t];
+                std::size_t begin = std::max(lo, start) - start;
+                std::size_t end = std::min(hi, commits.size() - 1);
+                if (end <= start || begin >= end - start)
+                    continue;
+                compute_batch_fis_range(Scalar(uint64_t(1)), m, fs[t], w3s[t], e_parts[r][t], 0, begin, end - start, commit_scalars.begin() + start);
+            }
+        }));
+    }
+    for (auto& task : parallelTasks)
+        threadPool.WaitFor(task);
+
     // Final batch multiscalar multiplication
     Scalar g_scalar = Scalar(uint64_t(0)); // associated to g_
     Scalar h1_scalar = Scalar(uint64_t(0)); // associated to h1
     Scalar h2_scalar = Scalar(uint64_t(0)); // associated to h2
     std::vector<Scalar> h_scalars; // associated to h_
-    std::vector<Scalar> commit_scalars; // associated to commitment list
     h_scalars.reserve(n * m);
     h_scalars.resize(n * m);
     for (std::size_t i = 0; i < n * m; i++) {
         h_scalars[i] = Scalar(uint64_t(0));
     }
-    commit_scalars.reserve(commits.size());
-    commit_scalars.resize(commits.size());
-    for (size_t i = 0; i < commits.size(); i++) {
-        commit_scalars[i] = Scalar(uint64_t(0));
-    }
 
     // Set up the final batch elements
     std::vector<GroupElement> points;
@@ -183,48 +234,15 @@ bool SigmaExtendedVerifier::verify(
     points.reserve(final_size);
     scalars.reserve(final_size);
 
-    // Index decomposition, which is common among all proofs
-    std::vector<std::vector<std::size_t> > I_;
-    I_.reserve(commits.size());
-    I_.resize(commits.size());
-    for (std::size_t i = 0; i < commits.size(); i++) {
-        I_[i] = LelantusPrimitives::convert_to_nal(i, n, m);
-    }
-
     // Process all proofs
     for (std::size_t t = 0; t < M; t++) {
-        SigmaExtendedProof proof = proofs[t];
-
-        // The challenge depends on whether or not we're in common mode
-        Scalar x;
-        if (commonChallenge) {
-            x = challenges[0];
-        }
-        else {
-            x = challenges[t];
-        }
-
-        // Generate random verifier weights
-        Scalar w1, w2, w3;
-        w1.randomize();
-        w2.randomize();
-        w3.randomize();
-
-        // Reconstruct f-matrix
-        std::vector<Scalar> f_;
-        if (!compute_fs(proof, x, f_)) {
-            LogPrintf("Invalid matrix reconstruction");
-            return false;
-        }
-
-        // Effective set size
-        std::size_t setSize;
-        if (!specifiedSetSizes) {
-            setSize = commits.size();
-        }
-        else {
-            setSize = setSizes[t];
-        }
+        const SigmaExtendedProof& proof = proofs[t];
+        const Scalar& x = commonChallenge ? challenges[0] : challenges[t];
+        const Scalar& w1 = w1s[t];
+        const Scalar& w2 = w2s[t];
+        const Scalar& w3 = w3s[t];
+        const std::vector<Scalar>& f_ = fs[t];
+        std::size_t setSize = effectiveSetSizes[t];
 
         // A, B, C, D (and associated commitments)
         points.emplace_back(proof.A_);
@@ -245,29 +263,24 @@ bool SigmaExtendedVerifier::verify(
         h1_scalar += proof.zV_ * w3.negate();
         h2_scalar += proof.zR_ * w3.negate();
 
-        Scalar f_i(uint64_t(1));
         Scalar e;
-        std::vector<Scalar>::iterator ptr;
-        if (!specifiedSetSizes) {
-            ptr = commit_scalars.begin();
-            compute_batch_fis(f_i, m, f_, w3, e, ptr, ptr, ptr + setSize - 1);
-        }
-        else {
-            ptr = commit_scalars.begin() + commits.size() - setSize;
-            compute_batch_fis(f_i, m, f_, w3, e, ptr, ptr, ptr + setSize - 1);
-        }
+        for (std::size_t r = 0; r < rangeCount; r++)
+            e += e_parts[r][t];
+
+        // Index decomposition of the last element of the set
+        std::vector<std::size_t> I_ = LelantusPrimitives::convert_to_nal(setSize - 1, n, m);
 
         Scalar pow(uint64_t(1));
         std::vector<Scalar> f_part_product;
         for (std::ptrdiff_t j = m - 1; j >= 0; j--) {
             f_part_product.push_back(pow);
-            pow *= f_[j*n + I_[setSize - 1][j]];
+            pow *= f_[j*n + I_[j]];
         }
 
         NthPower xj(x);
         for (std::size_t j = 0; j < m; j++) {
             Scalar fi_sum(uint64_t(0));
-            for (std::size_t i = I_[setSize - 1][j] + 1; i < n; i++)
+            for (std::size_t i = I_[j] + 1; i < n; i++)
                 fi_sum += f_[j*n + i];
             pow += fi_sum * xj.pow * f_part_product[m - j - 1];
             xj.go_next();
@@ -306,13 +319,27 @@ bool SigmaExtendedVerifier::verify(
     }
 
     // Verify the batch
-    secp_primitives::MultiExponent result(points, scalars);
-    if (result.get_multiple().isInfinity()) {
+    if (parallel_multiexp(points, scalars).isInfinity()) {
         return true;
     }
     return false;
 }
 
+// Split a large multiscalar multiplication into chunks evaluated on the proof thread pool
+GroupElement SigmaExtendedVerifier::parallel_multiexp(
+        const std::vector<GroupElement>& points,
+        const std::vector<Scalar>& scalars) const {
+    ProofThreadPool& threadPool = ProofThreadPool::GetInstance();
+    std::size_t chunks = std::min(threadPool.GetNumberOfThreads(), points.size() / minParallelRange);
+    secp_primitives::MultiExponent mult(points, scalars);
+    if (chunks <= 1)
+        return mult.get_multiple();
+
+    return mult.get_multiple_parallel(chunks, [&threadPool](const std::vector<std::function<void()>>& jobs) {
+        threadPool.RunAll(jobs);
+    });
+}
+
 bool SigmaExtendedVerifier::membership_checks(const SigmaExtendedProof& proof) const {
     if (!(proof.A_.isMember() &&
          proof.B_.isMember() &&
@@ -405,6 +432,41 @@ void SigmaExtendedVerifier::compute_fis(
     }
 }
 
+// Same as compute_batch_fis, restricted to the leaves [begin, end) of the subtree whose first leaf is offset
+void SigmaExtendedVerifier::compute_batch_fis_range(
+        const Scalar& f_i,
+        int j,
+        const std::vector<Scalar>& f,
+        const Scalar& y,
+        Scalar& e,
+        std::size_t offset,
+        std::size_t begin,
+        std::size_t end,
+        std::vector<Scalar>::iterator leaves) const {
+    j--;
+    if (j == -1)
+    {
+        *(leaves + offset) += f_i * y;
+        e += f_i;
+        return;
+    }
+
+    std::size_t step = (std::size_t)pow(n, j);
+    Scalar t;
+
+    for (std::size_t i = 0; i < n; i++)
+    {
+        std::size_t child = offset + i * step;
+        if (child >= end)
+            break;
+        if (child + step <= begin)
+            continue;
+        t = f[j * n + i];
+        t *= f_i;
+        compute_batch_fis_range(t, j, f, y, e, child, begin, end, leaves);
+    }
+}
+
 void SigmaExtendedVerifier::compute_batch_fis(
         const Scalar& f_i,
         int j,
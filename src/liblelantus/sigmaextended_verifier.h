@@ -73,8 +73,23 @@ private:
             std::vector<Scalar>::iterator& ptr,
             std::vector<Scalar>::iterator start_ptr,
             std::vector<Scalar>::iterator end_ptr) const;
+    void compute_batch_fis_range(
+            const Scalar& f_i,
+            int j,
+            const std::vector<Scalar>& f,
+            const Scalar& y,
+            Scalar& e,
+            std::size_t offset,
+            std::size_t begin,
+            std::size_t end,
+            std::vector<Scalar>::iterator leaves) const;
+
+    GroupElement parallel_multiexp(const std::vector<GroupElement>& points, const std::vector<Scalar>& scalars) const;
 
 private:
+    // Smallest number of commitments or points worth handing to a separate thread
+    static const std::size_t minParallelRange = 1024;
+
     GroupElement g_;
     std::vector<GroupElement> h_;
     std::size_t n;
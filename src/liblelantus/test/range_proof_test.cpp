@@ -67,6 +67,48 @@ BOOST_AUTO_TEST_CASE(prove_verify_single)
 
 }
 
+// Range proofs generated with a precomputed generator table, which covers only part of h_
+BOOST_AUTO_TEST_CASE(prove_verify_fixed_base_table)
+{
+    std::size_t n = 64;
+
+    secp_primitives::GroupElement g_gen, h_gen1, h_gen2;
+    g_gen.randomize();
+    h_gen1.randomize();
+    h_gen2.randomize();
+
+    auto g_ = RandomizeGroupElements(n * 4);
+    auto h_ = RandomizeGroupElements(n * 4);
+
+    std::vector<GroupElement> generators = {g_gen, h_gen1, h_gen2};
+    generators.insert(generators.end(), h_.begin(), h_.begin() + n * 2);
+    FixedBaseTable table(generators);
+
+    for (std::size_t m : {1, 2, 4}) {
+        std::vector<GroupElement> gens_g(g_.begin(), g_.begin() + n * m);
+        std::vector<GroupElement> gens_h(h_.begin(), h_.begin() + n * m);
+
+        auto serials = RandomizeScalars(m);
+        auto randoms = RandomizeScalars(m);
+
+        std::vector<secp_primitives::Scalar> v_s;
+        std::vector<secp_primitives::GroupElement> V;
+        for (std::size_t i = 0; i < m; ++i){
+            v_s.emplace_back(i);
+            V.push_back(g_gen * v_s.back() +  h_gen1 * randoms[i] + h_gen2 * serials[i]);
+        }
+
+        for (auto version : test_versions) {
+            RangeProver rangeProver(g_gen, h_gen1, h_gen2, gens_g, gens_h, n, version, &table);
+            RangeProof proof;
+            rangeProver.proof(v_s, serials, randoms, V, proof);
+
+            RangeVerifier rangeVerifier(g_gen, h_gen1, h_gen2, gens_g, gens_h, n, version);
+            BOOST_CHECK(rangeVerifier.verify(V, V, proof));
+        }
+    }
+}
+
 // A batch of valid aggregated range proofs of different size
 BOOST_AUTO_TEST_CASE(prove_verify_batch)
 {
@@ -117,6 +159,77 @@ BOOST_AUTO_TEST_CASE(prove_verify_batch)
     }
 }
 
+// Proofs of all versions folded into a single batch check
+BOOST_AUTO_TEST_CASE(prove_verify_batch_all_versions)
+{
+    // Parameters, the largest proof makes the final multiexponentiation big enough to be split
+    const std::size_t n = 64;
+    const std::vector<std::size_t> m = {1, 2, 16};
+
+    // Generators
+    secp_primitives::GroupElement g_gen, h_gen1, h_gen2;
+    g_gen.randomize();
+    h_gen1.randomize();
+    h_gen2.randomize();
+    std::size_t max_m = *std::max_element(m.begin(), m.end());
+    auto g_ = RandomizeGroupElements(n * max_m);
+    auto h_ = RandomizeGroupElements(n * max_m);
+
+    std::vector<std::vector<std::vector<GroupElement> > > V_versions;
+    std::vector<std::vector<RangeProof> > proof_versions;
+    for (auto version : test_versions)
+    {
+        V_versions.emplace_back();
+        proof_versions.emplace_back();
+        for (std::size_t i = 0; i < m.size(); i++) {
+            std::vector<GroupElement> gens_g(g_.begin(), g_.begin() + n * m[i]);
+            std::vector<GroupElement> gens_h(h_.begin(), h_.begin() + n * m[i]);
+            RangeProver rangeProver(g_gen, h_gen1, h_gen2, gens_g, gens_h, n, version);
+
+            // Input data
+            auto serials = RandomizeScalars(m[i]);
+            auto randoms = RandomizeScalars(m[i]);
+
+            std::vector<secp_primitives::Scalar> v_s;
+            std::vector<secp_primitives::GroupElement> V;
+            for (std::size_t j = 0; j < m[i]; ++j){
+                v_s.emplace_back(j);
+                V.push_back(g_gen * v_s.back() +  h_gen1 * randoms[j] + h_gen2 * serials[j]);
+            }
+
+            // Prove
+            RangeProof proof;
+            rangeProver.proof(v_s, serials, randoms, V, proof);
+            V_versions.back().emplace_back(V);
+            proof_versions.back().emplace_back(proof);
+        }
+    }
+
+    auto verify_all = [&] () {
+        RangeProofBatch batch;
+        std::size_t i = 0;
+        for (auto version : test_versions) {
+            RangeVerifier rangeVerifier(g_gen, h_gen1, h_gen2, g_, h_, n, version);
+            if (!rangeVerifier.add_to_batch(V_versions[i], V_versions[i], proof_versions[i], batch))
+                return false;
+            i++;
+        }
+
+        RangeVerifier rangeVerifier(g_gen, h_gen1, h_gen2, g_, h_, n, LELANTUS_TX_TPAYLOAD);
+        return rangeVerifier.verify_batch(batch);
+    };
+
+    BOOST_CHECK(verify_all());
+
+    // a proof without commitments is valid by itself, but does not validate the rest of the batch
+    V_versions[0].emplace_back();
+    proof_versions[0].emplace_back(proof_versions[0].back());
+    BOOST_CHECK(verify_all());
+
+    V_versions[0].front().front().randomize();
+    BOOST_CHECK(!verify_all());
+}
+
 // A single out-of-range aggregated range proof
 BOOST_AUTO_TEST_CASE(out_of_range_single_proof)
 {
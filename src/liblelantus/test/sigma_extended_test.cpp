@@ -150,6 +150,94 @@ BOOST_AUTO_TEST_CASE(one_out_of_N_variable_batch)
     BOOST_CHECK(verifier.batchverify(commits, challenges, serials, set_sizes, proofs));
 }
 
+BOOST_AUTO_TEST_CASE(one_out_of_N_variable_batch_large)
+{
+    // large enough for the commitment scalars and multiexponentiation to be split across threads
+    GenerateParams(4096, 16);
+
+    std::size_t commit_size = 4000; // require padding
+    auto commits = RandomizeGroupElements(commit_size);
+
+    // Generate
+    std::vector<Secret> secrets;
+    std::vector<std::size_t> indexes = { 0, 1500, 2048, 3999 };
+    std::vector<std::size_t> set_sizes = { 4000, 3000, 2500, 16 };
+
+    for (auto index : indexes) {
+        secrets.emplace_back(index);
+
+        auto &s = secrets.back();
+
+        commits[index] = Primitives::double_commit(
+            g, s.s, h_gens[1], s.v, h_gens[0], s.r
+        );
+    }
+
+    Prover prover(g, h_gens, n, m);
+    Verifier verifier(g, h_gens, n, m);
+    std::vector<Proof> proofs;
+    std::vector<Scalar> serials;
+    std::vector<Scalar> challenges;
+
+    for (std::size_t i = 0; i < indexes.size(); i++) {
+        Scalar x;
+        x.randomize();
+        proofs.emplace_back();
+        serials.push_back(secrets[i].s);
+        std::vector<GroupElement> commits_(commits.begin() + commit_size - set_sizes[i], commits.end());
+        GenerateBatchProof(
+            prover,
+            commits_,
+            secrets[i].l - (commit_size - set_sizes[i]),
+            secrets[i].s,
+            secrets[i].v,
+            secrets[i].r,
+            x,
+            proofs.back()
+        );
+        challenges.emplace_back(x);
+    }
+
+    BOOST_CHECK(verifier.batchverify(commits, challenges, serials, set_sizes, proofs));
+
+    // Invalidate the batch
+    serials.back().randomize();
+    BOOST_CHECK(!verifier.batchverify(commits, challenges, serials, set_sizes, proofs));
+}
+
+BOOST_AUTO_TEST_CASE(one_out_of_N_fixed_base_table)
+{
+    GenerateParams(64, 4);
+
+    auto commits = RandomizeGroupElements(N);
+
+    std::vector<GroupElement> generators = {g};
+    generators.insert(generators.end(), h_gens.begin(), h_gens.end());
+    FixedBaseTable table(generators);
+
+    Prover prover(g, h_gens, n, m, &table);
+    Verifier verifier(g, h_gens, n, m);
+
+    for (std::size_t index : {0, 17, 63}) {
+        Secret s(index);
+        commits[index] = Primitives::double_commit(
+            g, s.s, h_gens[1], s.v, h_gens[0], s.r);
+
+        Scalar x;
+        x.randomize();
+        Proof proof;
+        GenerateBatchProof(prover, commits, s.l, s.s, s.v, s.r, x, proof);
+
+        BOOST_CHECK(verifier.singleverify(commits, x, s.s, proof));
+    }
+
+    // table does not match the generators
+    FixedBaseTable shortTable({g, h_gens[0]});
+    Prover invalidProver(g, h_gens, n, m, &shortTable);
+    Proof proof;
+    BOOST_CHECK_THROW(GenerateBatchProof(invalidProver, commits, 0, Scalar(), Scalar(), Scalar(), Scalar(), proof), std::invalid_argument);
+}
+
 BOOST_AUTO_TEST_CASE(one_out_of_N_batch)
 {
     GenerateParams(16, 4);
@@ -1547,7 +1547,7 @@ CTransaction AdaptJsplitTx(CTransaction const & tx)
     static size_t const jsplitSerialSize = 32;
 
     CTransaction result{tx};
-    std::unique_ptr <lelantus::JoinSplit> jsplit;
+    std::shared_ptr<const lelantus::JoinSplit> jsplit;
     try {
         jsplit = lelantus::ParseLelantusJoinSplit(tx);
     }
@@ -31,10 +31,13 @@
 #include "crypto/MerkleTreeProof/mtp.h"
 #include "crypto/Lyra2Z/Lyra2Z.h"
 #include "crypto/Lyra2Z/Lyra2.h"
+#include "crypto/progpow.h"
 #include "sigma.h"
 #include "lelantus.h"
 #include "evo/spork.h"
 #include <algorithm>
+#include <atomic>
+#include <mutex>
 #include <boost/thread.hpp>
 #include <boost/tuple/tuple.hpp>
 #include <queue>
@@ -223,12 +226,17 @@ std::unique_ptr<CBlockTemplate> BlockAssembler::CreateNewBlock(const CScript& sc
 
     int nPackagesSelected = 0;
     int nDescendantsUpdated = 0;
+    bool fResumed = false;
     {
         LOCK(mempool.cs);
         FillBlackListForBlockTemplate();
 
-        addPriorityTxs();
+        fResumed = resumeTxSelection(pindexPrev);
+        // The resumed selection already holds the priority transactions of the last template
+        if (!fResumed)
+            addPriorityTxs();
         addPackageTxs(nPackagesSelected, nDescendantsUpdated);
+        saveTxSelection(pindexPrev);
     }
 
     int64_t nTime1 = GetTimeMicros();
@@ -309,11 +317,92 @@ std::unique_ptr<CBlockTemplate> BlockAssembler::CreateNewBlock(const CScript& sc
     }
     int64_t nTime2 = GetTimeMicros();
 
-    LogPrint("bench", "CreateNewBlock() packages: %.2fms (%d packages, %d updated descendants), validity: %.2fms (total %.2fms)\n", 0.001 * (nTime1 - nTimeStart), nPackagesSelected, nDescendantsUpdated, 0.001 * (nTime2 - nTime1), 0.001 * (nTime2 - nTimeStart));
+    LogPrint("bench", "CreateNewBlock() packages: %.2fms (%d packages, %d updated descendants%s), validity: %.2fms (total %.2fms)\n", 0.001 * (nTime1 - nTimeStart), nPackagesSelected, nDescendantsUpdated, fResumed ? ", resumed" : "", 0.001 * (nTime2 - nTime1), 0.001 * (nTime2 - nTimeStart));
 
     return std::move(pblocktemplate);
 }
 
+namespace {
+
+/**
+ * Transactions picked by the last CreateNewBlock() and what they were picked from. Pools ask for
+ * templates every few seconds and the mempool mostly grows in between, so as long as the tip stays
+ * the same and no transaction left the mempool (or had its fee changed) the next template starts
+ * from the same transactions, and package selection only has to go through the new arrivals. Once
+ * the previous template got close to full the new arrivals could have displaced some of its
+ * transactions, so the selection starts over then. Guarded by cs_main.
+ */
+struct CTxSelection
+{
+    uint256 hashPrevBlock;
+    int nHeight = 0;
+    unsigned int nTransactionsRemoved = 0;
+    unsigned int nBlockMaxWeight = 0;
+    unsigned int nBlockMaxSize = 0;
+    CFeeRate blockMinFeeRate;
+    bool fIncludeWitness = false;
+    bool fFull = false;
+    std::vector<uint256> vSelected;
+};
+
+CTxSelection lastTxSelection;
+
+} // namespace
+
+bool BlockAssembler::resumeTxSelection(const CBlockIndex* pindexPrev)
+{
+    AssertLockHeld(cs_main);
+    AssertLockHeld(mempool.cs);
+
+    const CTxSelection& last = lastTxSelection;
+    if (last.hashPrevBlock != pindexPrev->GetBlockHash() || last.nHeight != nHeight || last.fFull ||
+            last.nTransactionsRemoved != mempool.GetTransactionsRemoved() ||
+            last.nBlockMaxWeight != nBlockMaxWeight || last.nBlockMaxSize != nBlockMaxSize ||
+            !(last.blockMinFeeRate == blockMinFeeRate) || last.fIncludeWitness != fIncludeWitness)
+        return false;
+
+    // New arrivals may have blacklisted some of them (sporks, spent masternode collateral)
+    std::vector<CTxMemPool::txiter> entries;
+    entries.reserve(last.vSelected.size());
+    for (const uint256& hash : last.vSelected) {
+        CTxMemPool::txiter it = mempool.mapTx.find(hash);
+        if (it == mempool.mapTx.end() || txBlackList.count(it) > 0)
+            return false;
+        entries.push_back(it);
+    }
+
+    for (CTxMemPool::txiter it : entries)
+        AddToBlock(it);
+    return true;
+}
+
+void BlockAssembler::saveTxSelection(const CBlockIndex* pindexPrev)
+{
+    AssertLockHeld(cs_main);
+    AssertLockHeld(mempool.cs);
+
+    CTxSelection& last = lastTxSelection;
+    last.hashPrevBlock = pindexPrev->GetBlockHash();
+    last.nHeight = nHeight;
+    last.nTransactionsRemoved = mempool.GetTransactionsRemoved();
+    last.nBlockMaxWeight = nBlockMaxWeight;
+    last.nBlockMaxSize = nBlockMaxSize;
+    last.blockMinFeeRate = blockMinFeeRate;
+    last.fIncludeWitness = fIncludeWitness;
+    last.fFull = blockFinished || nBlockWeight > nBlockMaxWeight - 4000 ||
+            (fNeedSizeAccounting && nBlockSize > nBlockMaxSize - 1000);
+
+    // In block order, without the coinbase and quorum commitments which don't come from the mempool
+    last.vSelected.clear();
+    for (const CTransactionRef& tx : pblock->vtx) {
+        if (!tx)
+            continue;
+        CTxMemPool::txiter it = mempool.mapTx.find(tx->GetHash());
+        if (it != mempool.mapTx.end() && inBlock.count(it) > 0)
+            last.vSelected.push_back(tx->GetHash());
+    }
+}
+
 bool BlockAssembler::isStillDependent(CTxMemPool::txiter iter)
 {
     BOOST_FOREACH(CTxMemPool::txiter parent, mempool.GetMemPoolParents(iter))
@@ -1065,15 +1154,174 @@ static bool ProcessBlockFound(const CBlock* pblock, const CChainParams& chainpar
     return true;
 }
 
-void static FiroMiner(const CChainParams &chainparams) {
-    SetThreadPriority(THREAD_PRIORITY_LOWEST);
-    RenameThread("firo-miner");
+namespace {
 
+enum class MiningAlgorithm {
+    ProgPow,
+    MTP,
+    Lyra2Z,
+    Lyra2,
+    Lyra2Var,
+    Scrypt
+};
+
+const char* GetMiningAlgorithmName(MiningAlgorithm algorithm)
+{
+    switch (algorithm) {
+    case MiningAlgorithm::ProgPow:  return "progpow";
+    case MiningAlgorithm::MTP:      return "mtp";
+    case MiningAlgorithm::Lyra2Z:   return "lyra2z";
+    case MiningAlgorithm::Lyra2:    return "lyra2";
+    case MiningAlgorithm::Lyra2Var: return "lyra2var";
+    case MiningAlgorithm::Scrypt:   return "scrypt";
+    }
+    return "unknown";
+}
+
+MiningAlgorithm GetMiningAlgorithm(const CBlock& block, int nHeight, bool fTestNet)
+{
+    if (block.IsProgPow())
+        return MiningAlgorithm::ProgPow;
+    if (block.IsMTP())
+        return MiningAlgorithm::MTP;
+    if (nHeight >= (fTestNet ? HF_LYRA2Z_HEIGHT_TESTNET : HF_LYRA2Z_HEIGHT))
+        return MiningAlgorithm::Lyra2Z;
+    if (nHeight >= (fTestNet ? HF_LYRA2_HEIGHT_TESTNET : HF_LYRA2_HEIGHT))
+        return MiningAlgorithm::Lyra2;
+    if (nHeight >= (fTestNet ? HF_LYRA2VAR_HEIGHT_TESTNET : HF_LYRA2VAR_HEIGHT))
+        return MiningAlgorithm::Lyra2Var;
+    return MiningAlgorithm::Scrypt;
+}
+
+/** Block template shared by the mining threads */
+struct CMiningWork
+{
+    std::unique_ptr<CBlockTemplate> pblocktemplate;
+    const CBlockIndex* pindexPrev = nullptr;
+    unsigned int nTransactionsUpdated = 0;
+    int64_t nCreated = 0;
+    uint64_t nId = 0;
+};
+
+/**
+ * State shared by the FiroMiner threads. They all work on the same block template, built by the
+ * first thread finding the current one stale (new tip, mempool changed for a minute, or nonce
+ * range exhausted), and each of them searches its own slice of the nonce space.
+ */
+class CMinerEngine
+{
+private:
+    // Held while building a template, never while taking cs_main from elsewhere
+    std::mutex workMutex;
+    std::shared_ptr<const CMiningWork> work;
     unsigned int nExtraNonce = 0;
 
+    mutable std::mutex statsMutex;
+    CMinerStats stats;
+
+public:
+    std::atomic<uint64_t> nWorkId{0};
+    int nThreads = 0;
+
+    void Reset(int nThreadsIn)
+    {
+        {
+            std::lock_guard<std::mutex> lock(workMutex);
+            work.reset();
+            nExtraNonce = 0;
+        }
+        std::lock_guard<std::mutex> lock(statsMutex);
+        nThreads = nThreadsIn;
+        stats = CMinerStats();
+        stats.threads.resize(nThreads);
+    }
+
+    bool IsStale(const CMiningWork& current)
+    {
+        if (current.nId != nWorkId)
+            return true;
+        if (mempool.GetTransactionsUpdated() != current.nTransactionsUpdated && GetTime() - current.nCreated > 60)
+            return true;
+        LOCK(cs_main);
+        return current.pindexPrev != chainActive.Tip();
+    }
+
+    // Current template, rebuilt if the one with id nExhaustedId (if any) or the current one is stale
+    std::shared_ptr<const CMiningWork> GetWork(const CScript& scriptPubKey, uint64_t nExhaustedId)
+    {
+        std::lock_guard<std::mutex> lock(workMutex);
+        if (work && work->nId != nExhaustedId && !IsStale(*work))
+            return work;
+
+        int64_t nStart = GetTimeMicros();
+        std::shared_ptr<CMiningWork> newWork = std::make_shared<CMiningWork>();
+        newWork->nTransactionsUpdated = mempool.GetTransactionsUpdated();
+        {
+            LOCK(cs_main);
+            newWork->pindexPrev = chainActive.Tip();
+        }
+        newWork->pblocktemplate = BlockAssembler(Params()).CreateNewBlock(scriptPubKey, {});
+        if (!newWork->pblocktemplate)
+            return nullptr;
+        IncrementExtraNonce(&newWork->pblocktemplate->block, newWork->pindexPrev, nExtraNonce);
+        newWork->nCreated = GetTime();
+        newWork->nId = nWorkId + 1;
+        int64_t nElapsed = GetTimeMicros() - nStart;
+
+        {
+            std::lock_guard<std::mutex> statsLock(statsMutex);
+            stats.nTemplates++;
+            stats.nLastTemplateMicros = nElapsed;
+            stats.nTotalTemplateMicros += nElapsed;
+        }
+
+        work = newWork;
+        nWorkId = newWork->nId;
+        return work;
+    }
+
+    void UpdateThreadStats(int nThread, MiningAlgorithm algorithm, uint64_t nHashes, double dHashesPerSec)
+    {
+        std::lock_guard<std::mutex> lock(statsMutex);
+        if (nThread >= (int)stats.threads.size())
+            return;
+        CMinerThreadStats& threadStats = stats.threads[nThread];
+        threadStats.algorithm = GetMiningAlgorithmName(algorithm);
+        threadStats.nHashes = nHashes;
+        threadStats.dHashesPerSec = dHashesPerSec;
+    }
+
+    CMinerStats GetStats() const
+    {
+        std::lock_guard<std::mutex> lock(statsMutex);
+        return stats;
+    }
+};
+
+CMinerEngine minerEngine;
+
+/** Seconds over which the hash rate of a mining thread is measured */
+const int64_t MINER_HASHRATE_WINDOW = 5;
+
+} // namespace
+
+void static FiroMiner(const CChainParams &chainparams, int nThread) {
+    SetThreadPriority(THREAD_PRIORITY_LOWEST);
+    RenameThread("firo-miner");
+
     boost::shared_ptr<CReserveScript> coinbaseScript;
     GetMainSignals().ScriptForMining(coinbaseScript);
     bool fTestNet = chainparams.GetConsensus().IsTestnet();
+
+    // This thread's slice of the nonce space
+    const uint32_t nNonceBegin = ((uint64_t)1 << 32) * nThread / minerEngine.nThreads;
+    const uint32_t nNonceEnd = std::min<uint64_t>(((uint64_t)1 << 32) * (nThread + 1) / minerEngine.nThreads, 0xffff0000);
+    const uint64_t nNonce64Begin = (uint64_t)nThread << 48;
+
+    uint64_t nHashes = 0, nWindowHashes = 0;
+    int64_t nWindowStart = GetTimeMillis();
+    uint64_t nExhaustedId = 0;
+
     try {
         // Throw an error if no script was provided.  This can happen
         // due to some internal error but also if the keypool is empty.
@@ -1094,8 +1342,7 @@ void static FiroMiner(const CChainParams &chainparams) {
                     bool fHasZnodesWinnerForNextBlock;
                     const Consensus::Params &params = chainparams.GetConsensus();
                     {
-                        LOCK2(cs_main, mempool.cs);
-                        int nCount = 0;
+                        LOCK(cs_main);
                         fHasZnodesWinnerForNextBlock =
                                 params.IsRegtest() ||
                                 chainActive.Height()+1 >= chainparams.GetConsensus().DIP0003EnforcementHeight;
@@ -1106,87 +1353,84 @@ void static FiroMiner(const CChainParams &chainparams) {
                     MilliSleep(1000);
                 } while (true);
             }
+
             //
-            // Create new block
+            // Get the shared block template
             //
-            unsigned int nTransactionsUpdatedLast = mempool.GetTransactionsUpdated();
-            CBlockIndex *pindexPrev = chainActive.Tip();
-            if (pindexPrev) {
-                LogPrintf("loop pindexPrev->nHeight=%s\n", pindexPrev->nHeight);
-            }
-            LogPrintf("BEFORE: pblocktemplate\n");
-            std::unique_ptr<CBlockTemplate> pblocktemplate = BlockAssembler(Params()).CreateNewBlock(coinbaseScript->reserveScript, {});
-            LogPrintf("AFTER: pblocktemplate\n");
-            if (!pblocktemplate.get()) {
+            std::shared_ptr<const CMiningWork> work = minerEngine.GetWork(coinbaseScript->reserveScript, nExhaustedId);
+            if (!work) {
                 LogPrintf("Error in FiroMiner: Keypool ran out, please call keypoolrefill before restarting the mining thread\n");
                 return;
             }
-            CBlock *pblock = &pblocktemplate->block;
-            IncrementExtraNonce(pblock, pindexPrev, nExtraNonce);
+            const CBlockIndex *pindexPrev = work->pindexPrev;
+            CBlock block = work->pblocktemplate->block;
+            CBlock *pblock = &block;
+            pblock->nNonce = nNonceBegin;
+            pblock->nNonce64 = nNonce64Begin;
 
-            LogPrintf("Running FiroMiner with %u transactions in block (%u bytes)\n", pblock->vtx.size(),
-                      ::GetSerializeSize(*pblock, SER_NETWORK, PROTOCOL_VERSION));
+            if (nThread == 0)
+                LogPrintf("Running FiroMiner with %u transactions in block (%u bytes)\n", pblock->vtx.size(),
+                          ::GetSerializeSize(*pblock, SER_NETWORK, PROTOCOL_VERSION));
 
-            LogPrintf("BEFORE: search\n");
             //
             // Search
             //
-            int64_t nStart = GetTime();
             arith_uint256 hashTarget = arith_uint256().SetCompact(pblock->nBits);
-            LogPrintf("hashTarget: %s\n", hashTarget.ToString());
-            LogPrintf("fTestnet: %d\n", fTestNet);
-            LogPrintf("pindexPrev->nHeight: %s\n", pindexPrev->nHeight);
-            LogPrintf("pblock: %s\n", pblock->ToString());
-            LogPrintf("pblock->nVersion: %s\n", pblock->nVersion);
-            LogPrintf("pblock->nTime: %s\n", pblock->nTime);
-            LogPrintf("pblock->nNonce: %s\n", &pblock->nNonce);
-            LogPrintf("powLimit: %s\n", Params().GetConsensus().powLimit.ToString());
+            MiningAlgorithm algorithm = GetMiningAlgorithm(*pblock, pindexPrev->nHeight + 1, fTestNet);
+
+            // ProgPoW hashes the nonce apart from the rest of the header, which only changes with nTime
+            ProgPowEpochContextPtr epochContext;
+            uint256 progPowHeaderHash;
+            if (algorithm == MiningAlgorithm::ProgPow) {
+                epochContext = progpow_get_epoch_context(ethash::get_epoch_number(pblock->nHeight));
+                progPowHeaderHash = pblock->GetProgPowHeaderHash();
+            }
 
             while (true) {
                 // Check if something found
                 uint256 thash;
                 uint256 mix_hash;
+                bool fFound = false;
 
                 while (true) {
-                    if (pblock->IsProgPow()) {
-                        thash = pblock->GetProgPowHashFull(mix_hash);
-                    } else if (pblock->IsMTP()) {
+                    switch (algorithm) {
+                    case MiningAlgorithm::ProgPow:
+                        thash = progpow_hash_full(*epochContext, progPowHeaderHash, pblock->nHeight, pblock->nNonce64, mix_hash);
+                        break;
+                    case MiningAlgorithm::MTP:
                         thash = mtp::hash(*pblock, Params().GetConsensus().powLimit);
                         pblock->mtpHashValue = thash;
-                    } else if (!fTestNet && pindexPrev->nHeight + 1 >= HF_LYRA2Z_HEIGHT) {
+                        break;
+                    case MiningAlgorithm::Lyra2Z:
                         lyra2z_hash(BEGIN(pblock->nVersion), BEGIN(thash));
-                    } else if (!fTestNet && pindexPrev->nHeight + 1 >= HF_LYRA2_HEIGHT) {
+                        break;
+                    case MiningAlgorithm::Lyra2:
                         LYRA2(BEGIN(thash), 32, BEGIN(pblock->nVersion), 80, BEGIN(pblock->nVersion), 80, 2, 8192, 256);
-                    } else if (!fTestNet && pindexPrev->nHeight + 1 >= HF_LYRA2VAR_HEIGHT) {
+                        break;
+                    case MiningAlgorithm::Lyra2Var:
                         LYRA2(BEGIN(thash), 32, BEGIN(pblock->nVersion), 80, BEGIN(pblock->nVersion), 80, 2,
                               pindexPrev->nHeight + 1, 256);
-                    } else if (fTestNet && pindexPrev->nHeight + 1 >= HF_LYRA2Z_HEIGHT_TESTNET) { // testnet
-                        lyra2z_hash(BEGIN(pblock->nVersion), BEGIN(thash));
-                    } else if (fTestNet && pindexPrev->nHeight + 1 >= HF_LYRA2_HEIGHT_TESTNET) { // testnet
-                        LYRA2(BEGIN(thash), 32, BEGIN(pblock->nVersion), 80, BEGIN(pblock->nVersion), 80, 2, 8192, 256);
-                    } else if (fTestNet && pindexPrev->nHeight + 1 >= HF_LYRA2VAR_HEIGHT_TESTNET) { // testnet
-                        LYRA2(BEGIN(thash), 32, BEGIN(pblock->nVersion), 80, BEGIN(pblock->nVersion), 80, 2, pindexPrev->nHeight + 1, 256);
-                    } else {
+                        break;
+                    case MiningAlgorithm::Scrypt: {
                         unsigned long int scrypt_scratpad_size_current_block =
                                 ((1 << (GetNfactor(pblock->nTime) + 1)) * 128) + 63;
                         char *scratchpad = (char *) malloc(scrypt_scratpad_size_current_block * sizeof(char));
                         scrypt_N_1_1_256_sp_generic(BEGIN(pblock->nVersion), BEGIN(thash), scratchpad,
                                                     GetNfactor(pblock->nTime));
-//                        LogPrintf("scrypt thash: %s\n", thash.ToString().c_str());
-//                        LogPrintf("hashTarget: %s\n", hashTarget.ToString().c_str());
                         free(scratchpad);
+                        break;
+                    }
                     }
+                    ++nHashes;
+                    ++nWindowHashes;
 
                     boost::this_thread::interruption_point();
 
-                    //LogPrintf("*****\nhash   : %s  \ntarget : %s\n", UintToArith256(thash).ToString(), hashTarget.ToString());
                     auto powTarget = UintToArith256(thash);
                     if (powTarget <= hashTarget) {
                         pblock->mix_hash = mix_hash; // Store ProgPoW mix_hash
                         // Found a solution
-                        LogPrintf("Found a solution. Hash: %s", powTarget.ToString());
                         SetThreadPriority(THREAD_PRIORITY_NORMAL);
-//                        CheckWork(pblock, *pwallet, reservekey);
                         LogPrintf("FiroMiner:\n");
                         LogPrintf("proof-of-work found  \n  hash: %s  \ntarget: %s\n", powTarget.ToString(), hashTarget.ToString());
                         ProcessBlockFound(pblock, chainparams);
@@ -1195,6 +1439,9 @@ void static FiroMiner(const CChainParams &chainparams) {
                         // In regression test mode, stop mining after a block is found.
                         if (chainparams.MineBlocksOnDemand())
                             throw boost::thread_interrupted();
+                        // Don't search the same template again if the block didn't make it
+                        nExhaustedId = work->nId;
+                        fFound = true;
                         break;
                     }
                     pblock->nNonce += 1;
@@ -1202,24 +1449,41 @@ void static FiroMiner(const CChainParams &chainparams) {
                     if ((pblock->nNonce & 0xFF) == 0)
                         break;
                 }
+
+                int64_t nNow = GetTimeMillis();
+                if (nNow - nWindowStart >= MINER_HASHRATE_WINDOW * 1000) {
+                    minerEngine.UpdateThreadStats(nThread, algorithm, nHashes, nWindowHashes * 1000.0 / (nNow - nWindowStart));
+                    nWindowHashes = 0;
+                    nWindowStart = nNow;
+                }
+
+                // The tip is about to change, the next template will be built on top of our block
+                if (fFound)
+                    break;
                 // Regtest mode doesn't require peers
                 if (g_connman->GetNodeCount(CConnman::CONNECTIONS_ALL) == 0 && chainparams.MiningRequiresPeers())
                     break;
-                if (pblock->nNonce >= 0xffff0000)
-                    break;
-                if (mempool.GetTransactionsUpdated() != nTransactionsUpdatedLast && GetTime() - nStart > 60)
+                if (pblock->nNonce >= nNonceEnd) {
+                    // Ask for a template with another extra nonce
+                    nExhaustedId = work->nId;
                     break;
-                if (pindexPrev != chainActive.Tip())
+                }
+                if (minerEngine.IsStale(*work))
                     break;
 
                 // Update nTime every few seconds
-                if (UpdateTime(pblock, chainparams.GetConsensus(), pindexPrev) < 0)
-                    break; // Recreate the block if the clock has run backwards,
-                // so that we can use the correct time.
+                if (UpdateTime(pblock, chainparams.GetConsensus(), pindexPrev) < 0) {
+                    // Recreate the block if the clock has run backwards,
+                    // so that we can use the correct time.
+                    nExhaustedId = work->nId;
+                    break;
+                }
                 if (chainparams.GetConsensus().fPowAllowMinDifficultyBlocks) {
                     // Changing pblock->nTime can change work required on testnet:
                     hashTarget.SetCompact(pblock->nBits);
                 }
+                if (algorithm == MiningAlgorithm::ProgPow)
+                    progPowHeaderHash = pblock->GetProgPowHeaderHash();
             }
         }
     }
@@ -1242,7 +1506,9 @@ void GenerateBitcoins(bool fGenerate, int nThreads, const CChainParams& chainpar
 
     if (minerThreads != NULL)
     {
+        // The threads share the engine state, let them finish before it is reset
         minerThreads->interrupt_all();
+        minerThreads->join_all();
         delete minerThreads;
         minerThreads = NULL;
     }
@@ -1250,9 +1516,15 @@ void GenerateBitcoins(bool fGenerate, int nThreads, const CChainParams& chainpar
     if (nThreads == 0 || !fGenerate)
         return;
 
+    minerEngine.Reset(nThreads);
     minerThreads = new boost::thread_group();
     for (int i = 0; i < nThreads; i++)
-        minerThreads->create_thread(boost::bind(&FiroMiner, boost::cref(chainparams)));
+        minerThreads->create_thread(boost::bind(&FiroMiner, boost::cref(chainparams), i));
+}
+
+CMinerStats GetMinerStats()
+{
+    return minerEngine.GetStats();
 }
 
 void IncrementExtraNonce(CBlock* pblock, const CBlockIndex* pindexPrev, unsigned int& nExtraNonce)
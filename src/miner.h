@@ -196,6 +196,12 @@ private:
       * Increments nPackagesSelected / nDescendantsUpdated with corresponding
       * statistics from the package selection (for logging statistics). */
     void addPackageTxs(int &nPackagesSelected, int &nDescendantsUpdated);
+    /** Add the transactions picked for the previous template again, if it was built on the same tip
+      * and nothing it could have picked has left the mempool since. Returns false if it can't be done,
+      * the block is untouched then */
+    bool resumeTxSelection(const CBlockIndex* pindexPrev);
+    /** Remember the transactions picked for this template for resumeTxSelection() */
+    void saveTxSelection(const CBlockIndex* pindexPrev);
 
     // helper function for addPriorityTxs
     /** Test if tx will still "fit" in the block */
@@ -236,4 +242,23 @@ int64_t UpdateTime(CBlockHeader* pblock, const Consensus::Params& consensusParam
 /** Run the miner threads */
 void GenerateBitcoins(bool fGenerate, int nThreads, const CChainParams& chainparams);
 
+/** Hash rate of a miner thread */
+struct CMinerThreadStats
+{
+    std::string algorithm;
+    uint64_t nHashes = 0;
+    double dHashesPerSec = 0;
+};
+
+/** Miner threads activity since they were started, reported by getmininginfo */
+struct CMinerStats
+{
+    std::vector<CMinerThreadStats> threads;
+    uint64_t nTemplates = 0;
+    int64_t nLastTemplateMicros = 0;
+    int64_t nTotalTemplateMicros = 0;
+};
+
+CMinerStats GetMinerStats();
+
 #endif // BITCOIN_MINER_H
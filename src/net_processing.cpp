@@ -32,6 +32,7 @@
 
 #include "masternode-payments.h"
 #include "masternode-sync.h"
+#include "lelantus.h"
 
 #include "evo/deterministicmns.h"
 #include "evo/mnauth.h"
@@ -137,6 +138,19 @@ namespace {
     MapRelay mapRelay;
     /** Expiration-time ordered list of (expire time, relay map entry) pairs, protected by cs_main). */
     std::deque<std::pair<int64_t, MapRelay::iterator>> vRelayExpiration;
+
+    /**
+     * Lelantus JoinSplits received from peers and held back for up to -joinsplitbatchwindow
+     * milliseconds, so their proofs are verified in one batch before they go to the mempool.
+     * Protected by cs_main.
+     */
+    struct JoinSplitBatchEntry {
+        CTransactionRef tx;
+        NodeId fromPeer;
+    };
+    std::vector<JoinSplitBatchEntry> vJoinSplitBatch;
+    /** Time in milliseconds at which the pending batch is verified. Protected by cs_main. */
+    int64_t nJoinSplitBatchDeadline = 0;
 } // anon namespace
 
 //////////////////////////////////////////////////////////////////////////////
@@ -940,6 +954,8 @@ bool static AlreadyHave(const CInv& inv) EXCLUSIVE_LOCKS_REQUIRED(cs_main)
             return (recentRejects->contains(inv.hash) && !llmq::quorumInstantSendManager->IsLocked(inv.hash)) ||
                    mempool.exists(inv.hash) ||
                    mapOrphanTransactions.count(inv.hash) ||
+                   std::any_of(vJoinSplitBatch.begin(), vJoinSplitBatch.end(),
+                       [&inv](const JoinSplitBatchEntry& entry) { return entry.tx->GetHash() == inv.hash; }) ||
                    pcoinsTip->HaveCoinInCache(COutPoint(inv.hash, 0)) || // Best effort: only try output 0 and 1
                    pcoinsTip->HaveCoinInCache(COutPoint(inv.hash, 1));
         }
@@ -1332,6 +1348,248 @@ inline void static SendBlockTransactions(const CBlock& block, const BlockTransac
     connman.PushMessage(pfrom, msgMaker.Make(nSendFlags, NetMsgType::BLOCKTXN, resp));
 }
 
+/**
+ * Follow-up of a transaction just accepted to the mempool: mirror it into the Dandelion stempool,
+ * relay it and retry the orphan transactions which depend on it.
+ */
+static void RelayAcceptedTransaction(const CTransactionRef& ptx, CConnman& connman, std::list<CTransactionRef>& lRemovedTxn) EXCLUSIVE_LOCKS_REQUIRED(cs_main)
+{
+    const CTransaction& tx = *ptx;
+    std::deque<COutPoint> vWorkQueue;
+    std::vector<uint256> vEraseQueue;
+    bool fMissingInputs = false;
+    CValidationState dummyState; // Dummy state for Dandelion stempool
+
+    // Changes to mempool should also be made to Dandelion stempool.
+    AcceptToMemoryPool(
+        txpools.getStemTxPool(),
+        dummyState,
+        ptx,
+        true, /* fLimitFree */
+        &fMissingInputs, /* pfMissingInputs */
+        nullptr,
+        false, /* fOverrideMempoolLimit */
+        0, /* nAbsurdFee */
+        true, /* isCheckWalletTransaction */
+        false /* markFiroSpendTransactionSerial */
+    );
+
+    if (CNode::isTxDandelionEmbargoed(tx.GetHash())) {
+        CNode::removeDandelionEmbargo(tx.GetHash());
+    }
+
+    mempool.check(pcoinsTip);
+    connman.RelayTransaction(tx);
+    for (unsigned int i = 0; i < tx.vout.size(); i++) {
+        vWorkQueue.emplace_back(tx.GetHash(), i);
+    }
+
+    // Recursively process any orphan transactions that depended on this one
+    std::set<NodeId> setMisbehaving;
+    while (!vWorkQueue.empty()) {
+        auto itByPrev = mapOrphanTransactionsByPrev.find(vWorkQueue.front());
+        vWorkQueue.pop_front();
+        if (itByPrev == mapOrphanTransactionsByPrev.end())
+            continue;
+        for (auto mi = itByPrev->second.begin();
+             mi != itByPrev->second.end();
+             ++mi)
+        {
+            const CTransactionRef& porphanTx = (*mi)->second.tx;
+            const CTransaction& orphanTx = *porphanTx;
+            const uint256& orphanHash = orphanTx.GetHash();
+            NodeId fromPeer = (*mi)->second.fromPeer;
+            bool fMissingInputs2 = false;
+            // Use a dummy CValidationState so someone can't setup nodes to counter-DoS based on orphan
+            // resolution (that is, feeding people an invalid transaction based on LegitTxX in order to get
+            // anyone relaying LegitTxX banned)
+            CValidationState stateDummy;
+            CValidationState stateDummyDandelion;
+
+
+            if (setMisbehaving.count(fromPeer))
+                continue;
+            if (AcceptToMemoryPool(mempool, stateDummy, porphanTx, true, &fMissingInputs2, &lRemovedTxn, false, 0, true)) {
+                LogPrint("mempool", "   accepted orphan tx %s\n", orphanHash.ToString());
+
+                // Changes to mempool should also be made to Dandelion stempool
+                AcceptToMemoryPool(
+                    txpools.getStemTxPool(),
+                    stateDummyDandelion,
+                    porphanTx,
+                    true, /* fLimitFree */
+                    &fMissingInputs2,  /* pfMissingInputs */
+                    nullptr,
+                    false, /* fOverrideMempoolLimit */
+                    0, /* nAbsurdFee */
+                    true, /* isCheckWalletTransaction */
+                    false /* markFiroSpendTransactionSerial */
+                );
+
+                connman.RelayTransaction(orphanTx);
+                for (unsigned int i = 0; i < orphanTx.vout.size(); i++) {
+                    vWorkQueue.emplace_back(orphanHash, i);
+                }
+                vEraseQueue.push_back(orphanHash);
+            }
+            else if (!fMissingInputs2)
+            {
+                int nDos = 0;
+                if (stateDummy.IsInvalid(nDos) && nDos > 0)
+                {
+                    // Punish peer that gave us an invalid orphan tx
+                    Misbehaving(fromPeer, nDos);
+                    setMisbehaving.insert(fromPeer);
+                    LogPrint("mempool", "   invalid orphan tx %s\n", orphanHash.ToString());
+                }
+                // Has inputs but not accepted to mempool
+                // Probably non-standard or insufficient fee/priority
+                LogPrint("mempool", "   removed orphan tx %s\n", orphanHash.ToString());
+                vEraseQueue.push_back(orphanHash);
+                if (!orphanTx.HasWitness() && !stateDummy.CorruptionPossible()) {
+                    // Do not use rejection cache for witness transactions or
+                    // witness-stripped transactions, as they can have been malleated.
+                    // See https://github.com/bitcoin/bitcoin/issues/8279 for details.
+                    assert(recentRejects);
+                    recentRejects->insert(orphanHash);
+                }
+            }
+            mempool.check(pcoinsTip);
+        }
+    }
+
+    BOOST_FOREACH(uint256 hash, vEraseQueue)
+        EraseOrphanTx(hash);
+}
+
+/**
+ * Remember a transaction rejected from the mempool so it isn't requested again and, for whitelisted
+ * peers with -whitelistforcerelay, relay it anyway unless it is invalid. pfrom may be null if the
+ * sending peer is gone.
+ */
+static void RejectTransaction(CNode* pfrom, const CTransactionRef& ptx, const CValidationState& state, CConnman& connman) EXCLUSIVE_LOCKS_REQUIRED(cs_main)
+{
+    const CTransaction& tx = *ptx;
+    if (!tx.HasWitness() && !state.CorruptionPossible()) {
+        // Do not use rejection cache for witness transactions or
+        // witness-stripped transactions, as they can have been malleated.
+        // See https://github.com/bitcoin/bitcoin/issues/8279 for details.
+        assert(recentRejects);
+        recentRejects->insert(tx.GetHash());
+        if (RecursiveDynamicUsage(*ptx) < 100000) {
+            AddToCompactExtraTransactions(ptx);
+        }
+    } else if (tx.HasWitness() && RecursiveDynamicUsage(*ptx) < 100000) {
+        AddToCompactExtraTransactions(ptx);
+    }
+
+    if (pfrom && pfrom->fWhitelisted && GetBoolArg("-whitelistforcerelay", DEFAULT_WHITELISTFORCERELAY)) {
+        // Always relay transactions received from whitelisted peers, even
+        // if they were already in the mempool or rejected from it due
+        // to policy, allowing the node to function as a gateway for
+        // nodes hidden behind it.
+        //
+        // Never relay transactions that we would assign a non-zero DoS
+        // score for, as we expect peers to do the same with us in that
+        // case.
+        int nDoS = 0;
+        if (!state.IsInvalid(nDoS) || nDoS == 0) {
+            LogPrintf("Force relaying tx %s from whitelisted peer=%d\n", tx.GetHash().ToString(), pfrom->id);
+            connman.RelayTransaction(tx);
+        } else {
+            LogPrintf("Not relaying invalid transaction %s from whitelisted peer=%d (%s)\n", tx.GetHash().ToString(), pfrom->id, FormatStateMessage(state));
+        }
+    }
+}
+
+/**
+ * Tell the peer why its transaction was not accepted and punish it if the transaction is invalid.
+ * pfrom may be null if the peer is gone, the misbehaviour is still recorded against nodeId.
+ */
+static void ReportRejectedTransaction(NodeId nodeId, CNode* pfrom, const CTransaction& tx, const CValidationState& state, CConnman& connman) EXCLUSIVE_LOCKS_REQUIRED(cs_main)
+{
+    int nDoS = 0;
+    if (state.IsInvalid(nDoS))
+    {
+        LogPrint("mempoolrej", "%s from peer=%d was not accepted: %s\n", tx.GetHash().ToString(),
+            nodeId,
+            FormatStateMessage(state));
+        if (pfrom && state.GetRejectCode() < REJECT_INTERNAL) // Never send AcceptToMemoryPool's internal codes over P2P
+            connman.PushMessage(pfrom, CNetMsgMaker(pfrom->GetSendVersion()).Make(NetMsgType::REJECT, std::string(NetMsgType::TX), (unsigned char)state.GetRejectCode(),
+                               state.GetRejectReason().substr(0, MAX_REJECT_MESSAGE_LENGTH), tx.GetHash()));
+        if (nDoS > 0) {
+            Misbehaving(nodeId, nDoS);
+        }
+    }
+}
+
+/** Hold a JoinSplit received from a peer until the batch it belongs to is verified. */
+void AddJoinSplitToBatch(const CTransactionRef& ptx, NodeId peer, int64_t nBatchWindow) EXCLUSIVE_LOCKS_REQUIRED(cs_main)
+{
+    if (vJoinSplitBatch.empty())
+        nJoinSplitBatchDeadline = GetTimeMillis() + nBatchWindow;
+    vJoinSplitBatch.push_back({ptx, peer});
+    if (vJoinSplitBatch.size() >= MAX_JOINSPLIT_BATCH_SIZE)
+        nJoinSplitBatchDeadline = GetTimeMillis();
+}
+
+/**
+ * Verify the JoinSplits held back by the TX message handler once their batch window is over. Proofs
+ * are checked in one batch first, AcceptToMemoryPool then verifies each transaction on its own only if
+ * the batch failed, so the invalid ones are found and their senders punished.
+ */
+void ProcessJoinSplitBatch(CConnman& connman) EXCLUSIVE_LOCKS_REQUIRED(cs_main)
+{
+    if (vJoinSplitBatch.empty() || GetTimeMillis() < nJoinSplitBatchDeadline)
+        return;
+
+    std::vector<JoinSplitBatchEntry> vBatch;
+    vBatch.swap(vJoinSplitBatch);
+
+    std::vector<CTransactionRef> vTxs;
+    vTxs.reserve(vBatch.size());
+    for (const JoinSplitBatchEntry& entry : vBatch)
+        vTxs.push_back(entry.tx);
+
+    if (!lelantus::BatchVerifyJoinSplits(vTxs))
+        LogPrint("mempool", "JoinSplit batch of %u txn failed, verifying one by one\n", vTxs.size());
+
+    std::list<CTransactionRef> lRemovedTxn;
+    for (const JoinSplitBatchEntry& entry : vBatch) {
+        const CTransaction& tx = *entry.tx;
+        if (AlreadyHave(CInv(MSG_TX, tx.GetHash())))
+            continue;
+
+        CValidationState state;
+        bool fMissingInputs = false;
+        if (AcceptToMemoryPool(mempool, state, entry.tx, true, &fMissingInputs, &lRemovedTxn, false, 0, true)) {
+            LogPrintf("Transaction %s received and added to the mempool.\n", tx.GetHash().ToString());
+            LogPrint("mempool", "AcceptToMemoryPool: peer=%d: accepted batched %s (poolsz %u txn, %u kB)\n",
+                entry.fromPeer,
+                tx.GetHash().ToString(),
+                mempool.size(), mempool.DynamicMemoryUsage() / 1000);
+
+            RelayAcceptedTransaction(entry.tx, connman, lRemovedTxn);
+            continue;
+        }
+
+        // same handling as in the TX message handler, without the peer specific parts if it is gone
+        bool fPeerFound = connman.ForNode(entry.fromPeer, [&](CNode* pfrom) {
+            RejectTransaction(pfrom, entry.tx, state, connman);
+            ReportRejectedTransaction(entry.fromPeer, pfrom, tx, state, connman);
+            return true;
+        });
+        if (!fPeerFound) {
+            RejectTransaction(nullptr, entry.tx, state, connman);
+            ReportRejectedTransaction(entry.fromPeer, nullptr, tx, state, connman);
+        }
+    }
+    lelantus::ClearBatchVerifiedJoinSplits();
+
+    for (const CTransactionRef& removedTx : lRemovedTxn)
+        AddToCompactExtraTransactions(removedTx);
+}
+
 bool static ProcessMessage(CNode* pfrom, const std::string& strCommand, CDataStream& vRecv, int64_t nTimeReceived, const CChainParams& chainparams, CConnman& connman, const std::atomic<bool>& interruptMsgProc)
 {
     LogPrint("net", "received: %s (%u bytes) peer=%d\n", SanitizeString(strCommand), vRecv.size(), pfrom->id);
@@ -2056,9 +2314,6 @@ bool static ProcessMessage(CNode* pfrom, const std::string& strCommand, CDataStr
             return true;
         }
 
-        std::deque<COutPoint> vWorkQueue;
-        std::vector<uint256> vEraseQueue;
-
         int nInvType = MSG_TX;
         CTransactionRef ptx;
 
@@ -2075,40 +2330,23 @@ bool static ProcessMessage(CNode* pfrom, const std::string& strCommand, CDataStr
         bool fMissingInputs = false;
         bool fMissingInputsSigma = false;
         CValidationState state;
-        CValidationState dummyState; // Dummy state for Dandelion stempool
 
         pfrom->setAskFor.erase(inv.hash);
         mapAlreadyAskedFor.erase(inv.hash);
 
+        // JoinSplits are verified in batches when a window is configured, see ProcessJoinSplitBatch()
+        int64_t nBatchWindow = GetArg("-joinsplitbatchwindow", DEFAULT_JOINSPLIT_BATCH_WINDOW);
+        if (nBatchWindow > 0 && tx.IsLelantusJoinSplit() && !AlreadyHave(inv)) {
+            AddJoinSplitToBatch(ptx, pfrom->GetId(), nBatchWindow);
+            pfrom->nLastTXTime = GetTime();
+            return true;
+        }
+
         std::list<CTransactionRef> lRemovedTxn;
 
         if (!AlreadyHave(inv) && AcceptToMemoryPool(mempool, state, ptx, true, &fMissingInputs, &lRemovedTxn, false, 0, true)) {
             LogPrintf("Transaction %s received and added to the mempool.\n", tx.GetHash().ToString());
 
-            // Changes to mempool should also be made to Dandelion stempool.
-            AcceptToMemoryPool(
-                txpools.getStemTxPool(),
-                dummyState,
-                ptx,
-                true, /* fLimitFree */
-                &fMissingInputs, /* pfMissingInputs */
-                nullptr,
-                false, /* fOverrideMempoolLimit */
-                0, /* nAbsurdFee */
-                true, /* isCheckWalletTransaction */
-                false /* markFiroSpendTransactionSerial */
-            );
-
-            if (CNode::isTxDandelionEmbargoed(tx.GetHash())) {
-                CNode::removeDandelionEmbargo(tx.GetHash());
-            }
-
-            mempool.check(pcoinsTip);
-            connman.RelayTransaction(tx);
-            for (unsigned int i = 0; i < tx.vout.size(); i++) {
-                vWorkQueue.emplace_back(inv.hash, i);
-            }
-
             pfrom->nLastTXTime = GetTime();
 
             LogPrint("mempool", "AcceptToMemoryPool: peer=%d: accepted %s (poolsz %u txn, %u kB)\n",
@@ -2116,82 +2354,7 @@ bool static ProcessMessage(CNode* pfrom, const std::string& strCommand, CDataStr
                 tx.GetHash().ToString(),
                 mempool.size(), mempool.DynamicMemoryUsage() / 1000);
 
-            // Recursively process any orphan transactions that depended on this one
-            std::set<NodeId> setMisbehaving;
-            while (!vWorkQueue.empty()) {
-                auto itByPrev = mapOrphanTransactionsByPrev.find(vWorkQueue.front());
-                vWorkQueue.pop_front();
-                if (itByPrev == mapOrphanTransactionsByPrev.end())
-                    continue;
-                for (auto mi = itByPrev->second.begin();
-                     mi != itByPrev->second.end();
-                     ++mi)
-                {
-                    const CTransactionRef& porphanTx = (*mi)->second.tx;
-                    const CTransaction& orphanTx = *porphanTx;
-                    const uint256& orphanHash = orphanTx.GetHash();
-                    NodeId fromPeer = (*mi)->second.fromPeer;
-                    bool fMissingInputs2 = false;
-                    // Use a dummy CValidationState so someone can't setup nodes to counter-DoS based on orphan
-                    // resolution (that is, feeding people an invalid transaction based on LegitTxX in order to get
-                    // anyone relaying LegitTxX banned)
-                    CValidationState stateDummy;
-                    CValidationState stateDummyDandelion;
-
-
-                    if (setMisbehaving.count(fromPeer))
-                        continue;
-                    if (AcceptToMemoryPool(mempool, stateDummy, porphanTx, true, &fMissingInputs2, &lRemovedTxn, false, 0, true)) {
-                        LogPrint("mempool", "   accepted orphan tx %s\n", orphanHash.ToString());
-
-                        // Changes to mempool should also be made to Dandelion stempool
-                        AcceptToMemoryPool(
-                            txpools.getStemTxPool(),
-                            stateDummyDandelion,
-                            porphanTx,
-                            true, /* fLimitFree */
-                            &fMissingInputs2,  /* pfMissingInputs */
-                            nullptr,
-                            false, /* fOverrideMempoolLimit */
-                            0, /* nAbsurdFee */
-                            true, /* isCheckWalletTransaction */
-                            false /* markFiroSpendTransactionSerial */
-                        );
-
-                        connman.RelayTransaction(orphanTx);
-                        for (unsigned int i = 0; i < orphanTx.vout.size(); i++) {
-                            vWorkQueue.emplace_back(orphanHash, i);
-                        }
-                        vEraseQueue.push_back(orphanHash);
-                    }
-                    else if (!fMissingInputs2)
-                    {
-                        int nDos = 0;
-                        if (stateDummy.IsInvalid(nDos) && nDos > 0)
-                        {
-                            // Punish peer that gave us an invalid orphan tx
-                            Misbehaving(fromPeer, nDos);
-                            setMisbehaving.insert(fromPeer);
-                            LogPrint("mempool", "   invalid orphan tx %s\n", orphanHash.ToString());
-                        }
-                        // Has inputs but not accepted to mempool
-                        // Probably non-standard or insufficient fee/priority
-                        LogPrint("mempool", "   removed orphan tx %s\n", orphanHash.ToString());
-                        vEraseQueue.push_back(orphanHash);
-                        if (!orphanTx.HasWitness() && !stateDummy.CorruptionPossible()) {
-                            // Do not use rejection cache for witness transactions or
-                            // witness-stripped transactions, as they can have been malleated.
-                            // See https://github.com/bitcoin/bitcoin/issues/8279 for details.
-                            assert(recentRejects);
-                            recentRejects->insert(orphanHash);
-                        }
-                    }
-                    mempool.check(pcoinsTip);
-                }
-            }
-
-            BOOST_FOREACH(uint256 hash, vEraseQueue)
-                EraseOrphanTx(hash);
+            RelayAcceptedTransaction(ptx, connman, lRemovedTxn);
         }
         else if (fMissingInputs)
         {
@@ -2223,54 +2386,13 @@ bool static ProcessMessage(CNode* pfrom, const std::string& strCommand, CDataStr
                 recentRejects->insert(tx.GetHash());
             }
         } else {
-            if (!tx.HasWitness() && !state.CorruptionPossible()) {
-                // Do not use rejection cache for witness transactions or
-                // witness-stripped transactions, as they can have been malleated.
-                // See https://github.com/bitcoin/bitcoin/issues/8279 for details.
-                assert(recentRejects);
-                recentRejects->insert(tx.GetHash());
-                if (RecursiveDynamicUsage(*ptx) < 100000) {
-                    AddToCompactExtraTransactions(ptx);
-                }
-            } else if (tx.HasWitness() && RecursiveDynamicUsage(*ptx) < 100000) {
-                AddToCompactExtraTransactions(ptx);
-            }
-
-            if (pfrom->fWhitelisted && GetBoolArg("-whitelistforcerelay", DEFAULT_WHITELISTFORCERELAY)) {
-                // Always relay transactions received from whitelisted peers, even
-                // if they were already in the mempool or rejected from it due
-                // to policy, allowing the node to function as a gateway for
-                // nodes hidden behind it.
-                //
-                // Never relay transactions that we would assign a non-zero DoS
-                // score for, as we expect peers to do the same with us in that
-                // case.
-                int nDoS = 0;
-                if (!state.IsInvalid(nDoS) || nDoS == 0) {
-                    LogPrintf("Force relaying tx %s from whitelisted peer=%d\n", tx.GetHash().ToString(), pfrom->id);
-                    connman.RelayTransaction(tx);
-                } else {
-                    LogPrintf("Not relaying invalid transaction %s from whitelisted peer=%d (%s)\n", tx.GetHash().ToString(), pfrom->id, FormatStateMessage(state));
-                }
-            }
+            RejectTransaction(pfrom, ptx, state, connman);
         }
 
         for (const CTransactionRef& removedTx : lRemovedTxn)
             AddToCompactExtraTransactions(removedTx);
 
-        int nDoS = 0;
-        if (state.IsInvalid(nDoS))
-        {
-            LogPrint("mempoolrej", "%s from peer=%d was not accepted: %s\n", tx.GetHash().ToString(),
-                pfrom->id,
-                FormatStateMessage(state));
-            if (state.GetRejectCode() < REJECT_INTERNAL) // Never send AcceptToMemoryPool's internal codes over P2P
-                connman.PushMessage(pfrom, msgMaker.Make(NetMsgType::REJECT, strCommand, (unsigned char)state.GetRejectCode(),
-                                   state.GetRejectReason().substr(0, MAX_REJECT_MESSAGE_LENGTH), inv.hash));
-            if (nDoS > 0) {
-                Misbehaving(pfrom->GetId(), nDoS);
-            }
-        }
+        ReportRejectedTransaction(pfrom->GetId(), pfrom, tx, state, connman);
     }
 
 
@@ -3260,6 +3382,8 @@ bool SendMessages(CNode* pto, CConnman& connman, const std::atomic<bool>& interr
         if (!lockMain)
             return true;
 
+        ProcessJoinSplitBatch(connman);
+
         if (SendRejectsAndCheckIfBanned(pto, connman))
             return true;
         CNodeState &state = *State(pto->GetId());
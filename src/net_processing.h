@@ -17,6 +17,10 @@ static const int64_t ORPHAN_TX_EXPIRE_TIME = 20 * 60;
 static const int64_t ORPHAN_TX_EXPIRE_INTERVAL = 5 * 60;
 /** Default number of orphan+recently-replaced txn to keep around for block reconstruction */
 static const unsigned int DEFAULT_BLOCK_RECONSTRUCTION_EXTRA_TXN = 100;
+/** Default for -joinsplitbatchwindow, milliseconds to hold received JoinSplits for batch verification (0 = disabled) */
+static const int64_t DEFAULT_JOINSPLIT_BATCH_WINDOW = 0;
+/** Maximum number of JoinSplits held for one batch, a full batch is verified without waiting for the window */
+static const size_t MAX_JOINSPLIT_BATCH_SIZE = 100;
 
 /** The maximum rate of address records we're willing to process on average.
  * Is bypassed for whitelisted connections. */
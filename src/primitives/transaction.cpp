@@ -6,6 +6,7 @@
 #include "primitives/transaction.h"
 #include "script/interpreter.h"
 #include "hash.h"
+#include "memusage.h"
 #include "tinyformat.h"
 #include "utilstrencodings.h"
 
@@ -127,9 +128,63 @@ uint256 CTransaction::GetWitnessHash() const
 }
 
 /* For backward compatibility, the hash is initialized to 0. TODO: remove the need for this default constructor entirely. */
-CTransaction::CTransaction() : nVersion(CTransaction::CURRENT_VERSION), nType(TRANSACTION_NORMAL), vin(), vout(), nLockTime(0), hash() {}
-CTransaction::CTransaction(const CMutableTransaction &tx) : nVersion(tx.nVersion), nType(tx.nType), vin(tx.vin), vout(tx.vout), nLockTime(tx.nLockTime), vExtraPayload(tx.vExtraPayload), hash(ComputeHash()) {}
-CTransaction::CTransaction(CMutableTransaction &&tx) : nVersion(tx.nVersion), nType(tx.nType), vin(std::move(tx.vin)), vout(std::move(tx.vout)), nLockTime(tx.nLockTime), vExtraPayload(std::move(tx.vExtraPayload)), hash(ComputeHash()) {}
+CTransaction::CTransaction() : nVersion(CTransaction::CURRENT_VERSION), nType(TRANSACTION_NORMAL), vin(), vout(), nLockTime(0), hash(), nParsedProofsUsage(0) {}
+CTransaction::CTransaction(const CMutableTransaction &tx) : nVersion(tx.nVersion), nType(tx.nType), vin(tx.vin), vout(tx.vout), nLockTime(tx.nLockTime), vExtraPayload(tx.vExtraPayload), hash(ComputeHash()), nParsedProofsUsage(0) {}
+CTransaction::CTransaction(CMutableTransaction &&tx) : nVersion(tx.nVersion), nType(tx.nType), vin(std::move(tx.vin)), vout(std::move(tx.vout)), nLockTime(tx.nLockTime), vExtraPayload(std::move(tx.vExtraPayload)), hash(ComputeHash()), nParsedProofsUsage(0) {}
+CTransaction::CTransaction(const CTransaction &tx) : nVersion(tx.nVersion), nType(tx.nType), vin(tx.vin), vout(tx.vout), nLockTime(tx.nLockTime), vExtraPayload(tx.vExtraPayload), hash(tx.hash), nParsedProofsUsage(0) {}
+
+// A decoded proof keeps every group element and scalar in a heap allocated secp256k1 object behind
+// a pointer. The usage is estimated as if the whole proof were made of group elements of 34 serialized
+// bytes, each taking a pointer and a secp256k1_gej (three field elements of five limbs and a flag).
+static size_t ParsedProofUsage(size_t nProofSize)
+{
+    static const size_t nGroupElementUsage = sizeof(void*) + memusage::MallocUsage(3 * 5 * sizeof(uint64_t) + sizeof(int));
+    return (nProofSize + 33) / 34 * nGroupElementUsage;
+}
+
+std::shared_ptr<const lelantus::JoinSplit> CTransaction::GetParsedJoinSplit() const
+{
+    return std::atomic_load(&parsedJoinSplit);
+}
+
+std::shared_ptr<const lelantus::JoinSplit> CTransaction::SetParsedJoinSplit(std::shared_ptr<const lelantus::JoinSplit> joinSplit, size_t nProofSize) const
+{
+    std::shared_ptr<const lelantus::JoinSplit> expected;
+    if (!std::atomic_compare_exchange_strong(&parsedJoinSplit, &expected, joinSplit))
+        return expected;
+    nParsedProofsUsage += ParsedProofUsage(nProofSize);
+    return joinSplit;
+}
+
+std::shared_ptr<const sigma::CoinSpend> CTransaction::GetParsedSigmaSpend(size_t nIn) const
+{
+    auto spends = std::atomic_load(&parsedSigmaSpends);
+    if (!spends || nIn >= spends->size())
+        return nullptr;
+    return std::atomic_load(&(*spends)[nIn]);
+}
+
+std::shared_ptr<const sigma::CoinSpend> CTransaction::SetParsedSigmaSpend(size_t nIn, std::shared_ptr<const sigma::CoinSpend> spend, size_t nProofSize) const
+{
+    if (nIn >= vin.size())
+        return spend;
+
+    auto spends = std::atomic_load(&parsedSigmaSpends);
+    if (!spends) {
+        // one slot per input, whichever thread gets here first installs the vector
+        auto newSpends = std::make_shared<std::vector<std::shared_ptr<const sigma::CoinSpend>>>(vin.size());
+        if (std::atomic_compare_exchange_strong(&parsedSigmaSpends, &spends, newSpends)) {
+            spends = newSpends;
+            nParsedProofsUsage += memusage::DynamicUsage(newSpends) + memusage::DynamicUsage(*newSpends);
+        }
+    }
+    std::shared_ptr<const sigma::CoinSpend> expected;
+    if (!std::atomic_compare_exchange_strong(&(*spends)[nIn], &expected, spend))
+        return expected;
+    nParsedProofsUsage += ParsedProofUsage(nProofSize);
+    return spend;
+}
+
 CAmount CTransaction::GetValueOut() const
 {
     CAmount nValueOut = 0;
@@ -11,12 +11,17 @@
 #include "serialize.h"
 #include "uint256.h"
 
+#include <atomic>
 #include <exception>
+#include <memory>
 
 static const int SERIALIZE_TRANSACTION_NO_WITNESS = 0x40000000;
 
 static const int WITNESS_SCALE_FACTOR = 4;
 
+namespace lelantus { class JoinSplit; }
+namespace sigma { class CoinSpend; }
+
 class CBadTxIn : public std::exception
 {
 };
@@ -392,6 +397,12 @@ private:
     /** Memory only. */
     const uint256 hash;
 
+    /** Memory only, privacy spend proofs parsed on first use. */
+    mutable std::shared_ptr<const lelantus::JoinSplit> parsedJoinSplit;
+    mutable std::shared_ptr<std::vector<std::shared_ptr<const sigma::CoinSpend>>> parsedSigmaSpends;
+    /** Memory only, estimated heap usage of the parsed proofs. */
+    mutable std::atomic<size_t> nParsedProofsUsage;
+
     uint256 ComputeHash() const;
 
 public:
@@ -402,6 +413,9 @@ public:
     CTransaction(const CMutableTransaction &tx);
     CTransaction(CMutableTransaction &&tx);
 
+    /** The copy starts without the parsed proofs, they are filled in again when needed. */
+    CTransaction(const CTransaction &tx);
+
     template <typename Stream>
     inline void Serialize(Stream& s) const {
         SerializeTransaction(*this, s);
@@ -423,6 +437,19 @@ public:
     // Compute a hash that includes both transaction and witness data
     uint256 GetWitnessHash() const;
 
+    // Parsed Lelantus joinsplit and Sigma spend proofs kept for the lifetime of the transaction,
+    // filled in by lelantus::ParseLelantusJoinSplit and sigma::ParseSigmaSpend. Safe to use
+    // from several threads, a null pointer means the proof was not parsed yet. The setters take
+    // the serialized size of the proof and return the proof kept, which is the first one set.
+    std::shared_ptr<const lelantus::JoinSplit> GetParsedJoinSplit() const;
+    std::shared_ptr<const lelantus::JoinSplit> SetParsedJoinSplit(std::shared_ptr<const lelantus::JoinSplit> joinSplit, size_t nProofSize) const;
+    std::shared_ptr<const sigma::CoinSpend> GetParsedSigmaSpend(size_t nIn) const;
+    std::shared_ptr<const sigma::CoinSpend> SetParsedSigmaSpend(size_t nIn, std::shared_ptr<const sigma::CoinSpend> spend, size_t nProofSize) const;
+    // Estimated heap usage of the parsed proofs, part of RecursiveDynamicUsage
+    size_t GetParsedProofsUsage() const {
+        return nParsedProofsUsage;
+    }
+
     // Return sum of txouts.
     CAmount GetValueOut() const;
     // GetValueIn() is a method on CCoinsViewCache, because
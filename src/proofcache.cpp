@@ -0,0 +1,93 @@
+// Copyright (c) 2021 The Firo Core Developers
+// Distributed under the MIT software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#include "proofcache.h"
+
+#include "cuckoocache.h"
+#include "random.h"
+#include "serialize.h"
+#include "util.h"
+
+#include <boost/thread.hpp>
+
+namespace {
+
+// The keys are salted hashes already, any 32 bits of them will do
+class ProofCacheHasher
+{
+public:
+    template <uint8_t hash_select>
+    uint32_t operator()(const uint256& key) const
+    {
+        static_assert(hash_select < 8, "ProofCacheHasher only has 8 hashes available.");
+        uint32_t u;
+        std::memcpy(&u, key.begin() + 4 * hash_select, 4);
+        return u;
+    }
+};
+
+class CProofCache
+{
+private:
+    uint256 nonce;
+    CuckooCache::cache<uint256, ProofCacheHasher> setValid;
+    boost::shared_mutex cs_proofcache;
+
+public:
+    CProofCache()
+    {
+        GetRandBytes(nonce.begin(), 32);
+    }
+
+    CHashWriter GetKeyWriter(const uint256& txHash) const
+    {
+        CHashWriter writer(SER_GETHASH, 0);
+        writer << nonce << txHash;
+        return writer;
+    }
+
+    bool Get(const uint256& key)
+    {
+        boost::shared_lock<boost::shared_mutex> lock(cs_proofcache);
+        return setValid.contains(key, false);
+    }
+
+    void Set(uint256 key)
+    {
+        boost::unique_lock<boost::shared_mutex> lock(cs_proofcache);
+        setValid.insert(key);
+    }
+
+    uint32_t setup_bytes(size_t n)
+    {
+        return setValid.setup_bytes(n);
+    }
+};
+
+CProofCache proofCache;
+
+} // namespace
+
+void InitProofCache()
+{
+    size_t nMaxCacheSize = std::min(std::max((int64_t)0, GetArg("-maxproofcachesize", DEFAULT_MAX_PROOF_CACHE_SIZE)), MAX_MAX_PROOF_CACHE_SIZE) * ((size_t) 1 << 20);
+    size_t nElems = proofCache.setup_bytes(nMaxCacheSize);
+    LogPrintf("Using %zu MiB out of %zu requested for proof cache, able to store %zu elements\n",
+            (nElems*sizeof(uint256)) >>20, nMaxCacheSize>>20, nElems);
+}
+
+CHashWriter GetProofCacheKeyWriter(const uint256& txHash)
+{
+    return proofCache.GetKeyWriter(txHash);
+}
+
+bool IsProofVerified(const uint256& key)
+{
+    return proofCache.Get(key);
+}
+
+void SetProofVerified(const uint256& key)
+{
+    proofCache.Set(key);
+}
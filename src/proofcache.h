@@ -0,0 +1,34 @@
+// Copyright (c) 2021 The Firo Core Developers
+// Distributed under the MIT software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#ifndef FIRO_PROOFCACHE_H
+#define FIRO_PROOFCACHE_H
+
+#include "hash.h"
+#include "uint256.h"
+
+// Limit the verified proof cache to 4MB, over 100000 entries. There are far fewer privacy
+// spends waiting in the mempool
+static const unsigned int DEFAULT_MAX_PROOF_CACHE_SIZE = 4;
+// Maximum proof cache size allowed
+static const int64_t MAX_MAX_PROOF_CACHE_SIZE = 1024;
+
+/**
+ * Cache of the Sigma and Lelantus spend proofs which passed verification when their transaction
+ * was accepted to the mempool, so they are not verified again when the block containing it is
+ * connected. An entry is a salted hash of the transaction and of everything picking the anonymity
+ * sets the proofs were checked against (group ids, last block of each set, number of coins, ...),
+ * so a proof is only skipped when it would be checked against the very same sets.
+ */
+
+// To be called once in AppInit2/TestingSetup to initialize the proof cache
+void InitProofCache();
+
+// Writer for the key of the proofs of a transaction, already holding the salt
+CHashWriter GetProofCacheKeyWriter(const uint256& txHash);
+
+bool IsProofVerified(const uint256& key);
+void SetProofVerified(const uint256& key);
+
+#endif // FIRO_PROOFCACHE_H
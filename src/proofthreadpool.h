@@ -0,0 +1,232 @@
+#ifndef FIRO_PROOFTHREADPOOL_H
+#define FIRO_PROOFTHREADPOOL_H
+
+#include <atomic>
+#include <chrono>
+#include <deque>
+#include <exception>
+#include <functional>
+#include <future>
+#include <memory>
+#include <list>
+#include <vector>
+
+#include <boost/thread/locks.hpp>
+#include <boost/thread/mutex.hpp>
+#include <boost/thread/shared_mutex.hpp>
+#include <boost/thread/condition_variable.hpp>
+
+// our code currently relies on boost disable_interruption. This will go away with core upgrade
+#include <boost/thread/thread_only.hpp>
+
+// Process-wide thread pool for proof verification and generation. It is created once (sized by
+// -proofthreads in init.cpp, or lazily on first use) and keeps its threads for the life of the
+// process. Every worker owns a task deque and idle workers steal from the others, so callers post
+// all of their independent tasks at once and wait on the individual futures instead of processing
+// them in waves.
+class ProofThreadPool {
+private:
+    struct Worker {
+        boost::mutex                            mutex;
+        std::deque<std::function<void()>>       tasks;
+    };
+
+    std::vector<std::unique_ptr<Worker>>      workers;
+    std::list<boost::thread>                  threads;
+    boost::shared_mutex                       state_mutex;
+    boost::mutex                              wakeup_mutex;
+    boost::condition_variable                 wakeup_condition;
+    std::atomic<std::size_t>                  pending{0};
+    std::atomic<std::size_t>                  next_worker{0};
+
+    bool                                      running = false;
+    bool                                      stopped = false;
+    bool                                      shutdown = false;
+
+    // index of the worker owning the current thread, or -1 for threads outside of the pool
+    static inline thread_local int            current_worker = -1;
+
+    ProofThreadPool() {}
+
+    // Take one task, own queue first (newest task), then steal from the others (oldest task)
+    bool RunPendingTask(std::size_t preferred) {
+        std::function<void()> job;
+        for (std::size_t i = 0; i < workers.size() && !job; ++i) {
+            Worker& worker = *workers[(preferred + i) % workers.size()];
+            boost::unique_lock<boost::mutex> lock(worker.mutex);
+            if (worker.tasks.empty())
+                continue;
+            if (i == 0) {
+                job = std::move(worker.tasks.back());
+                worker.tasks.pop_back();
+            } else {
+                job = std::move(worker.tasks.front());
+                worker.tasks.pop_front();
+            }
+        }
+
+        if (!job)
+            return false;
+
+        --pending;
+        job();
+        return true;
+    }
+
+    void ThreadProc(int index) {
+        current_worker = index;
+        for (;;) {
+            if (RunPendingTask(index))
+                continue;
+
+            boost::unique_lock<boost::mutex> lock(wakeup_mutex);
+            wakeup_condition.wait(lock, [this] { return pending > 0 || shutdown; });
+            if (shutdown && pending == 0)
+                break;
+        }
+        current_worker = -1;
+    }
+
+    void Push(std::function<void()> job) {
+        {
+            boost::shared_lock<boost::shared_mutex> lock(state_mutex);
+            if (running) {
+                // tasks posted from a worker stay on its own deque, others are spread round-robin
+                std::size_t index = current_worker >= 0 ? current_worker : next_worker++ % workers.size();
+                {
+                    boost::unique_lock<boost::mutex> workerLock(workers[index]->mutex);
+                    workers[index]->tasks.emplace_back(std::move(job));
+                }
+                ++pending;
+                {
+                    boost::unique_lock<boost::mutex> wakeupLock(wakeup_mutex);
+                }
+                wakeup_condition.notify_one();
+                return;
+            }
+        }
+
+        // lazy start when the pool is used before init (tests, tools), run inline after Stop()
+        if (!stopped && Start(0)) {
+            Push(std::move(job));
+            return;
+        }
+        job();
+    }
+
+public:
+    ~ProofThreadPool() {
+        Stop();
+    }
+
+    static ProofThreadPool& GetInstance() {
+        static ProofThreadPool instance;
+        return instance;
+    }
+
+    // Start the worker threads, 0 means one thread per core. Returns false if the pool was stopped
+    bool Start(std::size_t thread_number) {
+        boost::unique_lock<boost::shared_mutex> lock(state_mutex);
+        if (stopped)
+            return false;
+        if (running)
+            return true;
+
+        if (thread_number == 0)
+            thread_number = std::max(1u, boost::thread::hardware_concurrency());
+
+        shutdown = false;
+        workers.clear();
+        for (std::size_t i = 0; i < thread_number; ++i)
+            workers.emplace_back(new Worker());
+        for (std::size_t i = 0; i < thread_number; ++i)
+            threads.emplace_back(std::bind(&ProofThreadPool::ThreadProc, this, (int)i));
+        running = true;
+        return true;
+    }
+
+    // Finish all queued tasks and join the threads. Tasks posted afterwards run on the caller's thread
+    void Stop() {
+        {
+            boost::unique_lock<boost::shared_mutex> lock(state_mutex);
+            stopped = true;
+            if (!running)
+                return;
+            running = false;
+            boost::unique_lock<boost::mutex> wakeupLock(wakeup_mutex);
+            shutdown = true;
+        }
+        wakeup_condition.notify_all();
+
+        for (boost::thread &t: threads)
+            t.join();
+        threads.clear();
+
+        // tasks which were posted while the workers were exiting
+        while (RunPendingTask(0)) {}
+    }
+
+    // Post a task to the pool and return a future to wait for its completion
+    template <typename Function>
+    auto PostTask(Function task) -> std::future<decltype(task())> {
+        typedef decltype(task()) Result;
+        auto packagedTask = std::make_shared<std::packaged_task<Result()>>(std::move(task));
+        std::future<Result> ret = packagedTask->get_future();
+        Push([packagedTask]() { (*packagedTask)(); });
+        return ret;
+    }
+
+    // Wait for a task posted to this pool. When called from one of the pool threads it keeps executing
+    // queued tasks until the future is ready, so tasks may post and wait for nested tasks without deadlock
+    template <typename Result>
+    Result WaitFor(std::future<Result>& future) {
+        if (current_worker >= 0) {
+            while (future.wait_for(std::chrono::seconds(0)) != std::future_status::ready) {
+                if (!RunPendingTask(current_worker))
+                    future.wait_for(std::chrono::milliseconds(1));
+            }
+        }
+        return future.get();
+    }
+
+    // Post every job and wait until all of them have finished, rethrowing the first failure.
+    // Matches secp_primitives::MultiExponent::TaskRunner
+    void RunAll(const std::vector<std::function<void()>>& jobs) {
+        std::vector<std::future<void>> tasks;
+        tasks.reserve(jobs.size());
+        for (const std::function<void()>& job : jobs)
+            tasks.emplace_back(PostTask(job));
+
+        std::exception_ptr error;
+        for (std::future<void>& task : tasks) {
+            try {
+                WaitFor(task);
+            } catch (...) {
+                if (!error)
+                    error = std::current_exception();
+            }
+        }
+        if (error)
+            std::rethrow_exception(error);
+    }
+
+    // Number of threads tasks are spread across, used by callers to decide how to partition their work
+    std::size_t GetNumberOfThreads() {
+        boost::shared_lock<boost::shared_mutex> lock(state_mutex);
+        if (running)
+            return workers.size();
+        return stopped ? 1 : std::max(1u, boost::thread::hardware_concurrency());
+    }
+};
+
+
+// helper class to put thread interruption on pause
+class DoNotDisturb {
+private:
+    boost::this_thread::disable_interruption dnd;
+public:
+    DoNotDisturb() {}
+};
+
+
+#endif
\ No newline at end of file
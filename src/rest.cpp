@@ -7,6 +7,7 @@
 #include "chainparams.h"
 #include "primitives/block.h"
 #include "primitives/transaction.h"
+#include "sigma/coin.h"
 #include "validation.h"
 #include "httpserver.h"
 #include "rpc/server.h"
@@ -16,6 +17,9 @@
 #include "utilstrencodings.h"
 #include "version.h"
 
+#include <secp256k1/include/GroupElement.h>
+#include <secp256k1/include/Scalar.h>
+
 #include <boost/algorithm/string.hpp>
 
 #include <univalue.h>
@@ -72,6 +76,25 @@ static bool RESTERR(HTTPRequest* req, enum HTTPStatusCode status, std::string me
     return false;
 }
 
+// Reply with the error thrown by an RPC call, an invalid parameter means that the requested data was not found
+static bool RESTERR(HTTPRequest* req, const UniValue& objError)
+{
+    const UniValue& code = find_value(objError, "code");
+    const UniValue& message = find_value(objError, "message");
+    enum HTTPStatusCode status = code.isNum() && code.get_int() == RPC_INVALID_PARAMETER ? HTTP_NOT_FOUND : HTTP_INTERNAL_SERVER_ERROR;
+    return RESTERR(req, status, message.isStr() ? message.get_str() : objError.write());
+}
+
+// Write data as hex a piece at a time, without building the whole hex string
+static void WriteHexReplyBody(HTTPRequest* req, const char* data, size_t size)
+{
+    static const size_t HEX_CHUNK_SIZE = 1 << 16;
+    for (size_t pos = 0; pos < size; pos += HEX_CHUNK_SIZE) {
+        std::string strHex = HexStr(data + pos, data + std::min(size, pos + HEX_CHUNK_SIZE));
+        req->WriteReplyBody(strHex.data(), strHex.size());
+    }
+}
+
 static enum RetFormat ParseDataFormat(std::string& param, const std::string& strReq)
 {
     const std::string::size_type pos = strReq.rfind('.');
@@ -233,16 +256,16 @@ static bool rest_block(HTTPRequest* req,
 
     switch (rf) {
     case RF_BINARY: {
-        std::string binaryBlock = ssBlock.str();
         req->WriteHeader("Content-Type", "application/octet-stream");
-        req->WriteReply(HTTP_OK, binaryBlock);
+        req->WriteReplyBody(ssBlock.data(), ssBlock.size());
+        req->WriteReply(HTTP_OK);
         return true;
     }
 
     case RF_HEX: {
-        std::string strHex = HexStr(ssBlock.begin(), ssBlock.end()) + "\n";
         req->WriteHeader("Content-Type", "text/plain");
-        req->WriteReply(HTTP_OK, strHex);
+        WriteHexReplyBody(req, ssBlock.data(), ssBlock.size());
+        req->WriteReply(HTTP_OK, "\n");
         return true;
     }
 
@@ -276,6 +299,275 @@ static bool rest_block_notxdetails(HTTPRequest* req, const std::string& strURIPa
 // A bit of a hack - dependency on a function defined in rpc/blockchain.cpp
 UniValue getblockchaininfo(const JSONRPCRequest& request);
 
+// Dependencies on functions defined in rpc/misc.cpp
+bool GetLelantusAnonymitySet(int coinGroupId, const uint256& startBlockHash, uint256& blockHash, std::vector<unsigned char>& setHash, bool& fDelta, std::string& coins);
+void GetLelantusUsedCoinSerials(std::size_t startNumber, std::size_t limit, uint256& blockHash, std::size_t& total, std::string& serials);
+UniValue getlelantusanonymityset(const JSONRPCRequest& request);
+UniValue getlelantususedcoinserials(const JSONRPCRequest& request);
+bool GetSigmaAnonymitySet(sigma::CoinDenomination denomination, int coinGroupId, uint256& blockHash, std::string& coins);
+void GetSigmaUsedCoinSerials(std::string& serials);
+UniValue SigmaAnonymitySetToJSON(const uint256& blockHash, const std::string& coins);
+UniValue SigmaUsedCoinSerialsToJSON(const std::string& serials);
+
+static bool rest_sigma_anonymityset(HTTPRequest* req, const std::string& strURIPart)
+{
+    if (!CheckWarmup(req))
+        return false;
+    std::string param;
+    const RetFormat rf = ParseDataFormat(param, strURIPart);
+    std::vector<std::string> path;
+    boost::split(path, param, boost::is_any_of("/"));
+
+    if (path.size() != 2)
+        return RESTERR(req, HTTP_BAD_REQUEST, "Invalid URI format. Use /rest/sigma/anonymityset/<denomination>/<coinGroupId>.<ext>.");
+
+    int64_t intDenom;
+    sigma::CoinDenomination denomination;
+    if (!ParseInt64(path[0], &intDenom) || !sigma::IntegerToDenomination(intDenom, denomination))
+        return RESTERR(req, HTTP_BAD_REQUEST, "Invalid denomination: " + path[0]);
+
+    int32_t coinGroupId;
+    if (!ParseInt32(path[1], &coinGroupId))
+        return RESTERR(req, HTTP_BAD_REQUEST, "Invalid coin group id: " + path[1]);
+
+    uint256 blockHash;
+    std::string coins;
+    if (!GetSigmaAnonymitySet(denomination, coinGroupId, blockHash, coins))
+        return RESTERR(req, HTTP_NOT_FOUND, "Coin group " + path[1] + " of denomination " + path[0] + " not found");
+
+    // the coins follow as raw serialized group elements in anonymity set order
+    CDataStream ssHeader(SER_NETWORK, PROTOCOL_VERSION);
+    ssHeader << blockHash;
+    WriteCompactSize(ssHeader, coins.size() / GroupElement::serialize_size);
+
+    switch (rf) {
+    case RF_BINARY: {
+        req->WriteHeader("Content-Type", "application/octet-stream");
+        req->WriteReplyBody(ssHeader.data(), ssHeader.size());
+        req->WriteReplyBody(coins.data(), coins.size());
+        req->WriteReply(HTTP_OK);
+        return true;
+    }
+
+    case RF_HEX: {
+        req->WriteHeader("Content-Type", "text/plain");
+        WriteHexReplyBody(req, ssHeader.data(), ssHeader.size());
+        WriteHexReplyBody(req, coins.data(), coins.size());
+        req->WriteReply(HTTP_OK, "\n");
+        return true;
+    }
+
+    case RF_JSON: {
+        std::string strJSON = SigmaAnonymitySetToJSON(blockHash, coins).write() + "\n";
+        req->WriteHeader("Content-Type", "application/json");
+        req->WriteReply(HTTP_OK, strJSON);
+        return true;
+    }
+
+    default: {
+        return RESTERR(req, HTTP_NOT_FOUND, "output format not found (available: " + AvailableDataFormatsString() + ")");
+    }
+    }
+
+    // not reached
+    return true; // continue to process further HTTP reqs on this cxn
+}
+
+static bool rest_sigma_usedserials(HTTPRequest* req, const std::string& strURIPart)
+{
+    if (!CheckWarmup(req))
+        return false;
+    std::string param;
+    const RetFormat rf = ParseDataFormat(param, strURIPart);
+
+    std::string serials;
+    GetSigmaUsedCoinSerials(serials);
+
+    // the serials follow as raw serialized scalars
+    CDataStream ssHeader(SER_NETWORK, PROTOCOL_VERSION);
+    WriteCompactSize(ssHeader, serials.size() / Scalar::memoryRequired());
+
+    switch (rf) {
+    case RF_BINARY: {
+        req->WriteHeader("Content-Type", "application/octet-stream");
+        req->WriteReplyBody(ssHeader.data(), ssHeader.size());
+        req->WriteReplyBody(serials.data(), serials.size());
+        req->WriteReply(HTTP_OK);
+        return true;
+    }
+
+    case RF_HEX: {
+        req->WriteHeader("Content-Type", "text/plain");
+        WriteHexReplyBody(req, ssHeader.data(), ssHeader.size());
+        WriteHexReplyBody(req, serials.data(), serials.size());
+        req->WriteReply(HTTP_OK, "\n");
+        return true;
+    }
+
+    case RF_JSON: {
+        std::string strJSON = SigmaUsedCoinSerialsToJSON(serials).write() + "\n";
+        req->WriteHeader("Content-Type", "application/json");
+        req->WriteReply(HTTP_OK, strJSON);
+        return true;
+    }
+
+    default: {
+        return RESTERR(req, HTTP_NOT_FOUND, "output format not found (available: " + AvailableDataFormatsString() + ")");
+    }
+    }
+
+    // not reached
+    return true; // continue to process further HTTP reqs on this cxn
+}
+
+static bool rest_lelantus_anonymityset(HTTPRequest* req, const std::string& strURIPart)
+{
+    if (!CheckWarmup(req))
+        return false;
+    std::string param;
+    const RetFormat rf = ParseDataFormat(param, strURIPart);
+    std::vector<std::string> path;
+    boost::split(path, param, boost::is_any_of("/"));
+
+    if (path.size() > 2)
+        return RESTERR(req, HTTP_BAD_REQUEST, "Invalid URI format. Use /rest/lelantus/anonymityset/<coinGroupId>/<startBlockHash>.<ext>.");
+
+    int32_t coinGroupId;
+    if (!ParseInt32(path[0], &coinGroupId))
+        return RESTERR(req, HTTP_BAD_REQUEST, "Invalid coin group id: " + path[0]);
+
+    uint256 startBlockHash;
+    if (path.size() > 1 && !ParseHashStr(path[1], startBlockHash))
+        return RESTERR(req, HTTP_BAD_REQUEST, "Invalid hash: " + path[1]);
+
+    if (rf == RF_JSON) {
+        JSONRPCRequest jsonRequest;
+        jsonRequest.params = UniValue(UniValue::VARR);
+        jsonRequest.params.push_back(coinGroupId);
+        if (path.size() > 1)
+            jsonRequest.params.push_back(path[1]);
+        std::string strJSON;
+        try {
+            strJSON = getlelantusanonymityset(jsonRequest).write() + "\n";
+        } catch (const UniValue& objError) {
+            return RESTERR(req, objError);
+        }
+        req->WriteHeader("Content-Type", "application/json");
+        req->WriteReply(HTTP_OK, strJSON);
+        return true;
+    }
+
+    uint256 blockHash;
+    std::vector<unsigned char> setHash;
+    bool fDelta = false;
+    std::string coins;
+    if (!GetLelantusAnonymitySet(coinGroupId, startBlockHash, blockHash, setHash, fDelta, coins))
+        return RESTERR(req, HTTP_NOT_FOUND, "Coin group " + path[0] + " not found");
+
+    // the coins follow as raw serialized group elements in anonymity set order
+    CDataStream ssHeader(SER_NETWORK, PROTOCOL_VERSION);
+    ssHeader << blockHash;
+    ssHeader << setHash;
+    ssHeader << fDelta;
+    WriteCompactSize(ssHeader, coins.size() / GroupElement::serialize_size);
+
+    switch (rf) {
+    case RF_BINARY: {
+        req->WriteHeader("Content-Type", "application/octet-stream");
+        req->WriteReplyBody(ssHeader.data(), ssHeader.size());
+        req->WriteReplyBody(coins.data(), coins.size());
+        req->WriteReply(HTTP_OK);
+        return true;
+    }
+
+    case RF_HEX: {
+        req->WriteHeader("Content-Type", "text/plain");
+        WriteHexReplyBody(req, ssHeader.data(), ssHeader.size());
+        WriteHexReplyBody(req, coins.data(), coins.size());
+        req->WriteReply(HTTP_OK, "\n");
+        return true;
+    }
+
+    default: {
+        return RESTERR(req, HTTP_NOT_FOUND, "output format not found (available: " + AvailableDataFormatsString() + ")");
+    }
+    }
+
+    // not reached
+    return true; // continue to process further HTTP reqs on this cxn
+}
+
+static bool rest_lelantus_usedserials(HTTPRequest* req, const std::string& strURIPart)
+{
+    if (!CheckWarmup(req))
+        return false;
+    std::string param;
+    const RetFormat rf = ParseDataFormat(param, strURIPart);
+    std::vector<std::string> path;
+    boost::split(path, param, boost::is_any_of("/"));
+
+    if (path.size() > 2)
+        return RESTERR(req, HTTP_BAD_REQUEST, "Invalid URI format. Use /rest/lelantus/usedserials/<startNumber>/<limit>.<ext>.");
+
+    int32_t startNumber = 0, limit = 0;
+    if (!path[0].empty() && (!ParseInt32(path[0], &startNumber) || startNumber < 0))
+        return RESTERR(req, HTTP_BAD_REQUEST, "Invalid start number: " + path[0]);
+    if (path.size() > 1 && (!ParseInt32(path[1], &limit) || limit < 0))
+        return RESTERR(req, HTTP_BAD_REQUEST, "Invalid limit: " + path[1]);
+
+    if (rf == RF_JSON) {
+        JSONRPCRequest jsonRequest;
+        jsonRequest.params = UniValue(UniValue::VARR);
+        jsonRequest.params.push_back(startNumber);
+        jsonRequest.params.push_back(limit);
+        std::string strJSON;
+        try {
+            strJSON = getlelantususedcoinserials(jsonRequest).write() + "\n";
+        } catch (const UniValue& objError) {
+            return RESTERR(req, objError);
+        }
+        req->WriteHeader("Content-Type", "application/json");
+        req->WriteReply(HTTP_OK, strJSON);
+        return true;
+    }
+
+    uint256 blockHash;
+    std::size_t total;
+    std::string serials;
+    GetLelantusUsedCoinSerials(startNumber, limit, blockHash, total, serials);
+
+    // the serials follow as raw serialized scalars in chain order
+    CDataStream ssHeader(SER_NETWORK, PROTOCOL_VERSION);
+    ssHeader << blockHash;
+    ssHeader << (uint64_t)total;
+    WriteCompactSize(ssHeader, serials.size() / Scalar::memoryRequired());
+
+    switch (rf) {
+    case RF_BINARY: {
+        req->WriteHeader("Content-Type", "application/octet-stream");
+        req->WriteReplyBody(ssHeader.data(), ssHeader.size());
+        req->WriteReplyBody(serials.data(), serials.size());
+        req->WriteReply(HTTP_OK);
+        return true;
+    }
+
+    case RF_HEX: {
+        req->WriteHeader("Content-Type", "text/plain");
+        WriteHexReplyBody(req, ssHeader.data(), ssHeader.size());
+        WriteHexReplyBody(req, serials.data(), serials.size());
+        req->WriteReply(HTTP_OK, "\n");
+        return true;
+    }
+
+    default: {
+        return RESTERR(req, HTTP_NOT_FOUND, "output format not found (available: " + AvailableDataFormatsString() + ")");
+    }
+    }
+
+    // not reached
+    return true; // continue to process further HTTP reqs on this cxn
+}
+
 static bool rest_chaininfo(HTTPRequest* req, const std::string& strURIPart)
 {
     if (!CheckWarmup(req))
@@ -603,6 +895,10 @@ static const struct {
       {"/rest/mempool/contents", rest_mempool_contents},
       {"/rest/headers/", rest_headers},
       {"/rest/getutxos", rest_getutxos},
+      {"/rest/lelantus/anonymityset/", rest_lelantus_anonymityset},
+      {"/rest/lelantus/usedserials/", rest_lelantus_usedserials},
+      {"/rest/sigma/anonymityset/", rest_sigma_anonymityset},
+      {"/rest/sigma/usedserials", rest_sigma_usedserials},
 };
 
 bool StartREST()
@@ -193,6 +193,9 @@ static const CRPCConvertParam vRPCConvertParams[] =
     { "getmintmetadata", 0 },
     { "getusedcoinserials", 0 },
     { "getlatestcoinids", 0 },
+    { "getlelantusanonymityset", 0 },
+    { "getlelantususedcoinserials", 0 },
+    { "getlelantususedcoinserials", 1 },
 
     /* Elysium - data retrieval calls */
 	{ "elysium_gettradehistoryforaddress", 1 },
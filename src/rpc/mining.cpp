@@ -324,6 +324,18 @@ UniValue getmininginfo(const JSONRPCRequest& request)
             "  \"pooledtx\": n              (numeric) The size of the mempool\n"
             "  \"testnet\": true|false      (boolean) If using testnet or not\n"
             "  \"chain\": \"xxxx\",           (string) current network name as defined in BIP70 (main, test, regtest)\n"
+            "  \"hashespersec\": nnn,       (numeric) The hash rate of the internal miner threads\n"
+            "  \"minerthreads\": [          (array) The internal miner threads\n"
+            "    {\n"
+            "      \"algorithm\": \"xxxx\",   (string) The PoW algorithm of the block being mined\n"
+            "      \"hashes\": nnn,         (numeric) The number of hashes computed since the thread started\n"
+            "      \"hashespersec\": nnn    (numeric) The recent hash rate of the thread\n"
+            "    }\n"
+            "    ,...\n"
+            "  ],\n"
+            "  \"templates\": nnn,          (numeric) The number of block templates built by the internal miner\n"
+            "  \"lasttemplatems\": nnn,     (numeric) The time it took to build the last one, in milliseconds\n"
+            "  \"avgtemplatems\": nnn       (numeric) The average time it took to build one, in milliseconds\n"
             "}\n"
             "\nExamples:\n"
             + HelpExampleCli("getmininginfo", "")
@@ -344,6 +356,23 @@ UniValue getmininginfo(const JSONRPCRequest& request)
     obj.push_back(Pair("networkhashps",    getnetworkhashps(request)));
     obj.push_back(Pair("pooledtx",         (uint64_t)mempool.size()));
     obj.push_back(Pair("chain",            Params().NetworkIDString()));
+
+    CMinerStats minerStats = GetMinerStats();
+    UniValue threads(UniValue::VARR);
+    double dHashesPerSec = 0;
+    for (const CMinerThreadStats& threadStats : minerStats.threads) {
+        UniValue thread(UniValue::VOBJ);
+        thread.push_back(Pair("algorithm",    threadStats.algorithm));
+        thread.push_back(Pair("hashes",       threadStats.nHashes));
+        thread.push_back(Pair("hashespersec", threadStats.dHashesPerSec));
+        threads.push_back(thread);
+        dHashesPerSec += threadStats.dHashesPerSec;
+    }
+    obj.push_back(Pair("hashespersec",     dHashesPerSec));
+    obj.push_back(Pair("minerthreads",     threads));
+    obj.push_back(Pair("templates",        minerStats.nTemplates));
+    obj.push_back(Pair("lasttemplatems",   minerStats.nLastTemplateMicros / 1000.0));
+    obj.push_back(Pair("avgtemplatems",    minerStats.nTemplates ? minerStats.nTotalTemplateMicros / 1000.0 / minerStats.nTemplates : 0.0));
     return obj;
 }
 
@@ -6,6 +6,7 @@
 #include "base58.h"
 #include "clientversion.h"
 #include "init.h"
+#include "lelantus.h"
 #include "validation.h"
 #include "net.h"
 #include "netbase.h"
@@ -921,6 +922,73 @@ UniValue getaddressbalance(const JSONRPCRequest& request)
 
 }
 
+// Serialized Sigma coins and serials served to light wallets. Sigma mints and spends are disabled,
+// so unlike the Lelantus ones below they are not cached.
+
+bool GetSigmaAnonymitySet(
+        sigma::CoinDenomination denomination,
+        int coinGroupId,
+        uint256& blockHash,
+        std::string& coins)
+{
+    std::vector<sigma::PublicCoin> publicCoins;
+    {
+        LOCK(cs_main);
+        sigma::CSigmaState* sigmaState = sigma::CSigmaState::GetState();
+        sigmaState->GetCoinSetForSpend(
+                &chainActive,
+                chainActive.Height() - (ZC_MINT_CONFIRMATIONS - 1),
+                denomination,
+                coinGroupId,
+                blockHash,
+                publicCoins);
+    }
+
+    coins.resize(publicCoins.size() * GroupElement::serialize_size);
+    unsigned char *buffer = reinterpret_cast<unsigned char *>(&coins[0]);
+    for (sigma::PublicCoin const & coin : publicCoins)
+        buffer = coin.getValue().serialize(buffer);
+
+    return !blockHash.IsNull();
+}
+
+void GetSigmaUsedCoinSerials(std::string& serials)
+{
+    sigma::CSigmaState* sigmaState = sigma::CSigmaState::GetState();
+    LOCK(cs_main);
+    sigma::spend_info_container const & spends = sigmaState->GetSpends();
+
+    serials.resize(spends.size() * Scalar::memoryRequired());
+    unsigned char *buffer = reinterpret_cast<unsigned char *>(&serials[0]);
+    for (auto const & spend : spends)
+        buffer = spend.first.serialize(buffer);
+}
+
+UniValue SigmaAnonymitySetToJSON(const uint256& blockHash, const std::string& coins)
+{
+    UniValue serializedCoins(UniValue::VARR);
+    for (std::size_t i = 0; i < coins.size(); i += GroupElement::serialize_size)
+        serializedCoins.push_back(HexStr(coins.begin() + i, coins.begin() + i + GroupElement::serialize_size));
+
+    UniValue ret(UniValue::VOBJ);
+    ret.push_back(Pair("blockHash", blockHash.GetHex()));
+    ret.push_back(Pair("serializedCoins", serializedCoins));
+
+    return ret;
+}
+
+UniValue SigmaUsedCoinSerialsToJSON(const std::string& serials)
+{
+    UniValue serializedSerials(UniValue::VARR);
+    for (std::size_t i = 0; i < serials.size(); i += Scalar::memoryRequired())
+        serializedSerials.push_back(HexStr(serials.begin() + i, serials.begin() + i + Scalar::memoryRequired()));
+
+    UniValue ret(UniValue::VOBJ);
+    ret.push_back(Pair("serials", serializedSerials));
+
+    return ret;
+}
+
 UniValue getanonymityset(const JSONRPCRequest& request)
 {
     if (request.fHelp || request.params.size() != 2)
@@ -937,6 +1005,7 @@ UniValue getanonymityset(const JSONRPCRequest& request)
                         "  \"blockHash\"   (string) Latest block hash for anonymity set\n"
                         "  \"anonymityset\"(std::string[]) array of Serialized GroupElements\n"
                         "}\n"
+                        "\nThe same data is available in binary form from /rest/sigma/anonymityset/<denomination>/<coinGroupId>.bin\n"
                 + HelpExampleCli("getanonymityset", "100000000 1")
                 + HelpExampleRpc("getanonymityset", "\"100000000\", \"1\"")
         );
@@ -955,31 +1024,10 @@ UniValue getanonymityset(const JSONRPCRequest& request)
     sigma::IntegerToDenomination(intDenom, denomination);
 
     uint256 blockHash;
-    std::vector<sigma::PublicCoin> coins;
+    std::string coins;
+    GetSigmaAnonymitySet(denomination, coinGroupId, blockHash, coins);
 
-    {
-        LOCK(cs_main);
-        sigma::CSigmaState* sigmaState = sigma::CSigmaState::GetState();
-        sigmaState->GetCoinSetForSpend(
-                &chainActive,
-                chainActive.Height() - (ZC_MINT_CONFIRMATIONS - 1),
-                denomination,
-                coinGroupId,
-                blockHash,
-                coins);
-    }
-
-    UniValue serializedCoins(UniValue::VARR);
-    for(sigma::PublicCoin const & coin : coins) {
-        std::vector<unsigned char> vch = coin.getValue().getvch();
-        serializedCoins.push_back(HexStr(vch.begin(), vch.end()));
-    }
-
-    UniValue ret(UniValue::VOBJ);
-    ret.push_back(Pair("blockHash", blockHash.GetHex()));
-    ret.push_back(Pair("serializedCoins", serializedCoins));
-
-    return ret;
+    return SigmaAnonymitySetToJSON(blockHash, coins);
 }
 
 UniValue getmintmetadata(const JSONRPCRequest& request)
@@ -1043,23 +1091,13 @@ UniValue getusedcoinserials(const JSONRPCRequest& request)
                 "{\n"
                 "  \"serials\" (std::string[]) array of Serialized Scalars\n"
                 "}\n"
+                "\nThe same data is available in binary form from /rest/sigma/usedserials.bin\n"
         );
 
-    sigma::CSigmaState* sigmaState = sigma::CSigmaState::GetState();
-    sigma::spend_info_container serials;
-    {
-        LOCK(cs_main);
-        serials = sigmaState->GetSpends();
-    }
-
-    UniValue serializedSerials(UniValue::VARR);
-    for ( auto it = serials.begin(); it != serials.end(); ++it )
-        serializedSerials.push_back(it->first.GetHex());
-
-    UniValue ret(UniValue::VOBJ);
-    ret.push_back(Pair("serials", serializedSerials));
+    std::string serials;
+    GetSigmaUsedCoinSerials(serials);
 
-    return ret;
+    return SigmaUsedCoinSerialsToJSON(serials);
 }
 
 UniValue getlatestcoinids(const JSONRPCRequest& request)
@@ -1102,6 +1140,273 @@ UniValue getlatestcoinids(const JSONRPCRequest& request)
     return ret;
 }
 
+namespace {
+
+// Serialized Lelantus coins and serials served to light wallets. The cache is extended as the chain
+// grows so that polling for new coins and serials doesn't walk the chain and serialize the whole set
+// again, and is rebuilt from the point of divergence after a reorg. Guarded by cs_main.
+
+const std::size_t COIN_SIZE = GroupElement::serialize_size;
+const std::size_t SERIAL_SIZE = Scalar::memoryRequired();
+
+struct CachedCoinSet {
+    bool fSkipBlacklisted = false;
+    // block entries of the set the coins were cached for
+    std::vector<const CBlockIndex *> blocks;
+    // coins in the order they are stored in the state, the reverse of the anonymity set order
+    std::string coins;
+};
+
+struct CachedSerials {
+    const CBlockIndex *lastBlock = nullptr;
+    // blocks having serials and the number of serials up to and including each of them
+    std::vector<std::pair<const CBlockIndex *, std::size_t>> blocks;
+    // serials in the order of the chain, sorted within a block
+    std::string serials;
+};
+
+std::map<int, CachedCoinSet> cachedCoinSets;
+CachedSerials cachedSerials;
+
+// Number of coins of the set as of the given block, in the list that GetCoins uses for it
+std::size_t GetCoinSetEnd(lelantus::CLelantusState::AnonymitySet::BlockEntry const &entry, bool fSkipBlacklisted)
+{
+    return fSkipBlacklisted ? entry.filteredCoinsEnd : entry.coinsEnd;
+}
+
+CachedCoinSet const &UpdateCachedCoinSet(
+        int coinGroupId,
+        lelantus::CLelantusState::AnonymitySet const &coinSet,
+        lelantus::CLelantusState::AnonymitySet::BlockEntry const &last,
+        bool fSkipBlacklisted)
+{
+    AssertLockHeld(cs_main);
+
+    CachedCoinSet &cached = cachedCoinSets[coinGroupId];
+    auto const &blocks = coinSet.GetBlocks();
+    std::size_t nBlocks = &last - blocks.data() + 1;
+
+    // the blacklist started to apply, all the cached coins are in the wrong list
+    if (cached.fSkipBlacklisted != fSkipBlacklisted) {
+        cached = CachedCoinSet();
+        cached.fSkipBlacklisted = fSkipBlacklisted;
+    }
+
+    // after a reorg only the coins of the blocks past the point of divergence are dropped
+    std::size_t nKept = std::min(cached.blocks.size(), nBlocks);
+    if (nKept > 0 && blocks[nKept - 1].block != cached.blocks[nKept - 1]) {
+        nKept = 0;
+        while (blocks[nKept].block == cached.blocks[nKept])
+            nKept++;
+    }
+    if (nKept < cached.blocks.size()) {
+        cached.blocks.resize(nKept);
+        cached.coins.resize(nKept > 0 ? GetCoinSetEnd(blocks[nKept - 1], fSkipBlacklisted) * COIN_SIZE : 0);
+    }
+
+    // the range starts at the latest coin, coin i of the stored order is at end - 1 - i
+    auto coins = coinSet.GetCoins(last, fSkipBlacklisted);
+    std::size_t end = coins.second - coins.first;
+    std::size_t cachedEnd = cached.coins.size() / COIN_SIZE;
+    if (cachedEnd < end) {
+        cached.coins.resize(end * COIN_SIZE);
+        unsigned char *buffer = reinterpret_cast<unsigned char *>(&cached.coins[0]);
+        for (std::size_t i = cachedEnd; i < end; i++)
+            (coins.first + (end - 1 - i))->getValue().serialize(buffer + i * COIN_SIZE);
+    }
+
+    for (std::size_t i = cached.blocks.size(); i < nBlocks; i++)
+        cached.blocks.push_back(blocks[i].block);
+    return cached;
+}
+
+CachedSerials const &UpdateCachedSerials()
+{
+    AssertLockHeld(cs_main);
+
+    if (cachedSerials.lastBlock && !chainActive.Contains(cachedSerials.lastBlock)) {
+        cachedSerials.lastBlock = chainActive.FindFork(cachedSerials.lastBlock);
+        while (!cachedSerials.blocks.empty()
+                && (!cachedSerials.lastBlock || cachedSerials.blocks.back().first->nHeight > cachedSerials.lastBlock->nHeight)) {
+            cachedSerials.blocks.pop_back();
+        }
+        cachedSerials.serials.resize(cachedSerials.blocks.empty() ? 0 : cachedSerials.blocks.back().second * SERIAL_SIZE);
+    }
+
+    CBlockIndex *index = cachedSerials.lastBlock ? chainActive.Next(cachedSerials.lastBlock) : chainActive.Genesis();
+    for (; index; index = chainActive.Next(index)) {
+        if (!index->lelantusSpentSerials.empty()) {
+            std::vector<std::array<unsigned char, SERIAL_SIZE>> blockSerials(index->lelantusSpentSerials.size());
+            auto serial = blockSerials.begin();
+            for (auto const &spend : index->lelantusSpentSerials)
+                spend.first.serialize((serial++)->data());
+            std::sort(blockSerials.begin(), blockSerials.end());
+
+            for (auto const &s : blockSerials)
+                cachedSerials.serials.append(reinterpret_cast<const char *>(s.data()), s.size());
+            cachedSerials.blocks.emplace_back(index, cachedSerials.serials.size() / SERIAL_SIZE);
+        }
+        cachedSerials.lastBlock = index;
+    }
+
+    return cachedSerials;
+}
+
+} // namespace
+
+bool GetLelantusAnonymitySet(
+        int coinGroupId,
+        const uint256& startBlockHash,
+        uint256& blockHash,
+        std::vector<unsigned char>& setHash,
+        bool& fDelta,
+        std::string& coins)
+{
+    LOCK(cs_main);
+
+    lelantus::CLelantusState* lelantusState = lelantus::CLelantusState::GetState();
+    lelantus::CLelantusState::AnonymitySet const *coinSet = lelantusState->GetCachedAnonymitySet(coinGroupId);
+    lelantus::CLelantusState::AnonymitySet::BlockEntry const *last =
+        coinSet ? coinSet->GetLastBlock(chainActive.Height() - (ZC_MINT_CONFIRMATIONS - 1)) : nullptr;
+    if (!last)
+        return false;
+
+    bool fSkipBlacklisted = chainActive.Height() >= ::Params().GetConsensus().nLelantusFixesStartBlock;
+    CachedCoinSet const &cached = UpdateCachedCoinSet(coinGroupId, *coinSet, *last, fSkipBlacklisted);
+    std::size_t end = cached.coins.size() / COIN_SIZE;
+
+    blockHash = last->block->GetBlockHash();
+    setHash = lelantus::GetAnonymitySetHash(last->block, last->coinGroupId);
+
+    std::size_t start = 0;
+    fDelta = false;
+    BlockMap::const_iterator it = mapBlockIndex.find(startBlockHash);
+    if (it != mapBlockIndex.end() && chainActive.Contains(it->second)) {
+        lelantus::CLelantusState::AnonymitySet::BlockEntry const *startEntry = coinSet->GetLastBlock(it->second->nHeight);
+        start = startEntry ? std::min(GetCoinSetEnd(*startEntry, fSkipBlacklisted), end) : 0;
+        fDelta = true;
+    }
+
+    // newest coins first
+    coins.clear();
+    coins.reserve((end - start) * COIN_SIZE);
+    for (std::size_t i = end; i > start; i--)
+        coins.append(cached.coins, (i - 1) * COIN_SIZE, COIN_SIZE);
+
+    return true;
+}
+
+void GetLelantusUsedCoinSerials(
+        std::size_t startNumber,
+        std::size_t limit,
+        uint256& blockHash,
+        std::size_t& total,
+        std::string& serials)
+{
+    LOCK(cs_main);
+
+    CachedSerials const &cached = UpdateCachedSerials();
+
+    blockHash = chainActive.Tip()->GetBlockHash();
+    total = cached.serials.size() / SERIAL_SIZE;
+
+    std::size_t start = std::min(startNumber, total);
+    std::size_t end = limit > 0 ? std::min(start + limit, total) : total;
+    serials.assign(cached.serials, start * SERIAL_SIZE, (end - start) * SERIAL_SIZE);
+}
+
+UniValue getlelantusanonymityset(const JSONRPCRequest& request)
+{
+    if (request.fHelp || request.params.size() < 1 || request.params.size() > 2)
+        throw std::runtime_error(
+                "getlelantusanonymityset coinGroupId ( \"startBlockHash\" )\n"
+                        "\nReturns the Lelantus anonymity set of the group, or the coins added to it after the given block.\n"
+                        "\nArguments:\n"
+                        "1. coinGroupId      (int, required) The coin group id\n"
+                        "2. startBlockHash   (string, optional) Block hash of the set the caller already has\n"
+                        "\nResult:\n"
+                        "{\n"
+                        "  \"blockHash\"   (string) Latest block hash for anonymity set\n"
+                        "  \"setHash\"     (string) Hash of the anonymity set as of blockHash\n"
+                        "  \"isDelta\"     (bool) Whether only the coins added after startBlockHash are returned, these\n"
+                        "                  precede the coins of the set already held. False if startBlockHash is not\n"
+                        "                  in the active chain\n"
+                        "  \"coins\"       (std::string[]) array of Serialized GroupElements in anonymity set order\n"
+                        "}\n"
+                        "\nThe same data is available in binary form from /rest/lelantus/anonymityset/<coinGroupId>/<startBlockHash>.bin\n"
+                + HelpExampleCli("getlelantusanonymityset", "1")
+                + HelpExampleCli("getlelantusanonymityset", "1 \"3e5bd4b6a2e7d8b5ab3c3e1c8c7d9f8e0a1b2c3d4e5f60718293a4b5c6d7e8f9\"")
+                + HelpExampleRpc("getlelantusanonymityset", "1, \"3e5bd4b6a2e7d8b5ab3c3e1c8c7d9f8e0a1b2c3d4e5f60718293a4b5c6d7e8f9\"")
+        );
+
+    int coinGroupId = request.params[0].get_int();
+    uint256 startBlockHash;
+    if (request.params.size() > 1)
+        startBlockHash = ParseHashV(request.params[1], "startBlockHash");
+
+    uint256 blockHash;
+    std::vector<unsigned char> setHash;
+    bool fDelta = false;
+    std::string coins;
+    if (!GetLelantusAnonymitySet(coinGroupId, startBlockHash, blockHash, setHash, fDelta, coins))
+        throw JSONRPCError(RPC_INVALID_PARAMETER, "Coin group not found");
+
+    UniValue serializedCoins(UniValue::VARR);
+    for (std::size_t i = 0; i < coins.size(); i += COIN_SIZE)
+        serializedCoins.push_back(HexStr(coins.begin() + i, coins.begin() + i + COIN_SIZE));
+
+    UniValue ret(UniValue::VOBJ);
+    ret.push_back(Pair("blockHash", blockHash.GetHex()));
+    ret.push_back(Pair("setHash", HexStr(setHash.begin(), setHash.end())));
+    ret.push_back(Pair("isDelta", fDelta));
+    ret.push_back(Pair("coins", serializedCoins));
+
+    return ret;
+}
+
+UniValue getlelantususedcoinserials(const JSONRPCRequest& request)
+{
+    if (request.fHelp || request.params.size() > 2)
+        throw std::runtime_error(
+                "getlelantususedcoinserials ( startNumber limit )\n"
+                "\nReturns the used Lelantus coin serials in the order they were spent in the chain.\n"
+                "\nArguments:\n"
+                "1. startNumber   (int, optional, default=0) Number of serials to skip, usually the total of the previous call\n"
+                "2. limit         (int, optional, default=0) Maximum number of serials to return, 0 for all of them\n"
+                "\nResult:\n"
+                "{\n"
+                "  \"blockHash\"   (string) Hash of the chain tip the serials are returned for\n"
+                "  \"total\"       (int) Total number of used serials\n"
+                "  \"serials\"     (std::string[]) array of Serialized Scalars\n"
+                "}\n"
+                "\nThe same data is available in binary form from /rest/lelantus/usedserials/<startNumber>/<limit>.bin\n"
+                + HelpExampleCli("getlelantususedcoinserials", "")
+                + HelpExampleCli("getlelantususedcoinserials", "1000 500")
+                + HelpExampleRpc("getlelantususedcoinserials", "1000, 500")
+        );
+
+    int startNumber = request.params.size() > 0 ? request.params[0].get_int() : 0;
+    int limit = request.params.size() > 1 ? request.params[1].get_int() : 0;
+    if (startNumber < 0 || limit < 0)
+        throw JSONRPCError(RPC_INVALID_PARAMETER, "startNumber and limit must not be negative");
+
+    uint256 blockHash;
+    std::size_t total;
+    std::string serials;
+    GetLelantusUsedCoinSerials(startNumber, limit, blockHash, total, serials);
+
+    UniValue serializedSerials(UniValue::VARR);
+    for (std::size_t i = 0; i < serials.size(); i += SERIAL_SIZE)
+        serializedSerials.push_back(HexStr(serials.begin() + i, serials.begin() + i + SERIAL_SIZE));
+
+    UniValue ret(UniValue::VOBJ);
+    ret.push_back(Pair("blockHash", blockHash.GetHex()));
+    ret.push_back(Pair("total", (uint64_t)total));
+    ret.push_back(Pair("serials", serializedSerials));
+
+    return ret;
+}
+
 UniValue getaddresstxids(const JSONRPCRequest& request)
 {
     if (request.fHelp || request.params.size() != 1)
@@ -1389,6 +1694,8 @@ static const CRPCCommand commands[] =
     { "mobile",             "getmintmetadata",        &getmintmetadata,        true  },
     { "mobile",             "getusedcoinserials",     &getusedcoinserials,     true  },
     { "mobile",             "getlatestcoinids",       &getlatestcoinids,       true  },
+    { "mobile",             "getlelantusanonymityset",    &getlelantusanonymityset,    true  },
+    { "mobile",             "getlelantususedcoinserials", &getlelantususedcoinserials, true  },
 
     { "hidden",             "setmocktime",            &setmocktime,            true,  {"timestamp"}},
     { "hidden",             "echo",                   &echo,                   true,  {"arg0","arg1","arg2","arg3","arg4","arg5","arg6","arg7","arg8","arg9"}},
@@ -106,10 +106,10 @@ void TxToJSON(const CTransaction& tx, const uint256 hashBlock, UniValue& entry)
         if (tx.IsCoinBase()) {
             in.push_back(Pair("coinbase", HexStr(txin.scriptSig.begin(), txin.scriptSig.end())));
         } else if (txin.IsSigmaSpend()) {
-            std::unique_ptr<sigma::CoinSpend> spend;
+            std::shared_ptr<const sigma::CoinSpend> spend;
             uint32_t pubcoinId;
             try {
-                std::tie(spend, pubcoinId) = sigma::ParseSigmaSpend(txin);
+                std::tie(spend, pubcoinId) = sigma::ParseSigmaSpend(tx, i);
             } catch (CBadTxIn&) {
                 throw JSONRPCError(RPC_DATABASE_ERROR, "An error occurred during processing the Sigma spend information");
             } catch (std::ios_base::failure &) {
@@ -123,7 +123,7 @@ void TxToJSON(const CTransaction& tx, const uint256 hashBlock, UniValue& entry)
         } else if (txin.IsLelantusJoinSplit()) {
             in.push_back("joinsplit");
             fillStdFields(in, txin);
-            std::unique_ptr <lelantus::JoinSplit> jsplit;
+            std::shared_ptr<const lelantus::JoinSplit> jsplit;
             try {
                 jsplit = lelantus::ParseLelantusJoinSplit(tx);
             }
@@ -336,6 +336,8 @@ static const CRPCCommand vRPCCommands[] =
     { "mobile",             "getmintmetadata",        &getmintmetadata,        true  },
     { "mobile",             "getusedcoinserials",     &getusedcoinserials,     true  },
     { "mobile",             "getlatestcoinids",       &getlatestcoinids,       true  },
+    { "mobile",             "getlelantusanonymityset",    &getlelantusanonymityset,    true  },
+    { "mobile",             "getlelantususedcoinserials", &getlelantususedcoinserials, true  },
 };
 
 CRPCTable::CRPCTable()
@@ -211,6 +211,8 @@ extern UniValue getanonymityset(const JSONRPCRequest& params);
 extern UniValue getmintmetadata(const JSONRPCRequest& params);
 extern UniValue getusedcoinserials(const JSONRPCRequest& params);
 extern UniValue getlatestcoinids(const JSONRPCRequest& params);
+extern UniValue getlelantusanonymityset(const JSONRPCRequest& params);
+extern UniValue getlelantususedcoinserials(const JSONRPCRequest& params);
 
 extern UniValue znode(const JSONRPCRequest &request);
 extern UniValue znodelist(const JSONRPCRequest &request);
@@ -0,0 +1,44 @@
+#ifndef SECP_FIXEDBASETABLE_H
+#define SECP_FIXEDBASETABLE_H
+
+#include <cstddef>
+#include <vector>
+#include "../include/GroupElement.h"
+#include "../include/Scalar.h"
+
+namespace secp_primitives {
+
+// Precomputed multiples of a fixed set of generators. Every scalar is split into 4-bit windows and the
+// table keeps all 15 nonzero multiples of each window, so multiplying a generator takes one mixed
+// addition per window and no doublings. Meant for generators which never change, about 60KB each.
+class FixedBaseTable {
+public:
+    static constexpr std::size_t window_bits = 4;
+    static constexpr std::size_t windows = 256 / window_bits;
+    static constexpr std::size_t window_entries = (1 << window_bits) - 1;
+
+public:
+    explicit FixedBaseTable(const std::vector<GroupElement>& generators);
+    ~FixedBaseTable();
+
+    FixedBaseTable(const FixedBaseTable& other) = delete;
+    FixedBaseTable& operator=(const FixedBaseTable& other) = delete;
+
+    std::size_t size() const;
+
+    const GroupElement& get_generator(std::size_t index) const;
+
+    // generators[index] * scalar
+    GroupElement multiply(std::size_t index, const Scalar& scalar) const;
+
+    // Sum of generators[offset + i] * scalars[i]
+    GroupElement multi_multiply(std::size_t offset, const std::vector<Scalar>& scalars) const;
+
+private:
+    std::vector<GroupElement> generators_;
+    void *table_; // secp256k1_ge_storage[generators * windows * window_entries]
+};
+
+}// namespace secp_primitives
+
+#endif //SECP_FIXEDBASETABLE_H
@@ -77,6 +77,13 @@ public:
   static constexpr size_t memoryRequired() { return serialize_size; }
   unsigned char* serialize() const;
   unsigned char* serialize(unsigned char* buffer) const;
+  // Serializes all elements one after another, sharing a single field inversion, returns the end of the written data
+  static unsigned char* serialize(const std::vector<GroupElement>& elements, unsigned char* buffer);
+
+  // Converts all elements to affine coordinates in place using a single batch inversion, so that
+  // serialization, hashing and comparison no longer need a field inversion per element.
+  // Deserialized points are already affine.
+  static void normalize(std::vector<GroupElement>& elements);
   // The function deserializes the GroupElement and checks the validity,
   // it accepts infinity point, handle it based on your use case
   unsigned const char* deserialize(unsigned const char* buffer);
@@ -110,6 +117,7 @@ public:
   GroupElement& set_base_g();
 
   friend class MultiExponent;
+  friend class FixedBaseTable;
 private:
     // Returns the secp object inside it.
     const void * get_value() const;
@@ -1,6 +1,8 @@
 #ifndef SECP_MULTIEXPONENT_H
 #define SECP_MULTIEXPONENT_H
 
+#include <cstddef>
+#include <functional>
 #include <vector>
 #include "../include/GroupElement.h"
 #include "../include/Scalar.h"
@@ -8,6 +10,10 @@
 namespace secp_primitives {
 
 class MultiExponent {
+public:
+    // Runs all of the given jobs, e.g. on a thread pool, and returns once every one of them has finished
+    typedef std::function<void(const std::vector<std::function<void()>>&)> TaskRunner;
+
 public:
     MultiExponent(const MultiExponent& other);
     MultiExponent(const std::vector<GroupElement>& generators, const std::vector<Scalar>& powers);
@@ -15,6 +21,12 @@ public:
 
     GroupElement get_multiple();
 
+    // Partial sum over the points [begin, end)
+    GroupElement get_multiple(std::size_t begin, std::size_t end) const;
+
+    // Splits the points into chunks, evaluates each chunk as a separate job passed to runner and sums the partial results
+    GroupElement get_multiple_parallel(std::size_t chunks, const TaskRunner& runner) const;
+
 private:
     void  *sc_; // secp256k1_scalar[]
     void  *pt_; // secp256k1_gej[]
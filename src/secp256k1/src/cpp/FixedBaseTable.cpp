@@ -0,0 +1,107 @@
+#include "../include/FixedBaseTable.h"
+
+#include "../include/secp256k1.h"
+#include "../field.h"
+#include "../field_impl.h"
+#include "../group.h"
+#include "../group_impl.h"
+#include "../scalar.h"
+#include "../scalar_impl.h"
+
+#include <stdexcept>
+
+namespace secp_primitives {
+
+namespace {
+
+const std::size_t generator_entries = FixedBaseTable::windows * FixedBaseTable::window_entries;
+
+// Add generator * scalar to r using the table of the generator
+void add_multiple(secp256k1_gej *r, const secp256k1_ge_storage *table, const secp256k1_scalar *scalar) {
+    unsigned char bytes[32];
+    secp256k1_scalar_get_b32(bytes, scalar);
+
+    secp256k1_ge ge;
+    for (std::size_t w = 0; w < FixedBaseTable::windows; ++w) {
+        // windows go from the least significant bits, bytes are big endian
+        unsigned int digit = (bytes[31 - w / 2] >> (4 * (w % 2))) & 0xf;
+        if (digit == 0)
+            continue;
+        secp256k1_ge_from_storage(&ge, &table[w * FixedBaseTable::window_entries + digit - 1]);
+        secp256k1_gej_add_ge_var(r, r, &ge, NULL);
+    }
+}
+
+}
+
+FixedBaseTable::FixedBaseTable(const std::vector<GroupElement>& generators)
+        : generators_(generators)
+        , table_(new secp256k1_ge_storage[generators.size() * generator_entries])
+{
+    std::vector<secp256k1_gej> multiples(generator_entries);
+    std::vector<secp256k1_ge> affine(generator_entries);
+    secp256k1_ge_storage *table = reinterpret_cast<secp256k1_ge_storage *>(table_);
+
+    for (std::size_t i = 0; i < generators_.size(); ++i) {
+        if (generators_[i].isInfinity()) {
+            delete []table;
+            throw std::invalid_argument("FixedBaseTable: generator is infinity");
+        }
+
+        // base is 16^w * generator for window w
+        secp256k1_gej base = *reinterpret_cast<const secp256k1_gej *>(generators_[i].get_value());
+        for (std::size_t w = 0; w < windows; ++w) {
+            secp256k1_gej *row = &multiples[w * window_entries];
+            row[0] = base;
+            for (std::size_t j = 1; j < window_entries; ++j)
+                secp256k1_gej_add_var(&row[j], &row[j - 1], &base, NULL);
+            secp256k1_gej_add_var(&base, &row[window_entries - 1], &base, NULL);
+        }
+
+        secp256k1_ge_set_all_gej_var(affine.data(), multiples.data(), generator_entries, NULL);
+        for (std::size_t j = 0; j < generator_entries; ++j)
+            secp256k1_ge_to_storage(&table[i * generator_entries + j], &affine[j]);
+    }
+}
+
+FixedBaseTable::~FixedBaseTable() {
+    delete []reinterpret_cast<secp256k1_ge_storage *>(table_);
+}
+
+std::size_t FixedBaseTable::size() const {
+    return generators_.size();
+}
+
+const GroupElement& FixedBaseTable::get_generator(std::size_t index) const {
+    return generators_.at(index);
+}
+
+GroupElement FixedBaseTable::multiply(std::size_t index, const Scalar& scalar) const {
+    if (index >= generators_.size())
+        throw std::out_of_range("FixedBaseTable: generator index is out of range");
+
+    secp256k1_gej r;
+    secp256k1_gej_set_infinity(&r);
+    add_multiple(
+        &r,
+        reinterpret_cast<const secp256k1_ge_storage *>(table_) + index * generator_entries,
+        reinterpret_cast<const secp256k1_scalar *>(scalar.get_value()));
+    return &r;
+}
+
+GroupElement FixedBaseTable::multi_multiply(std::size_t offset, const std::vector<Scalar>& scalars) const {
+    if (offset > generators_.size() || scalars.size() > generators_.size() - offset)
+        throw std::out_of_range("FixedBaseTable: generator index is out of range");
+
+    secp256k1_gej r;
+    secp256k1_gej_set_infinity(&r);
+    for (std::size_t i = 0; i < scalars.size(); ++i) {
+        add_multiple(
+            &r,
+            reinterpret_cast<const secp256k1_ge_storage *>(table_) + (offset + i) * generator_entries,
+            reinterpret_cast<const secp256k1_scalar *>(scalars[i].get_value()));
+    }
+    return &r;
+}
+
+}// namespace secp_primitives
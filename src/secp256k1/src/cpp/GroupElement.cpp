@@ -23,15 +23,76 @@
 
 static secp256k1_ecmult_context ctx;
 
+static const secp256k1_fe fe_one = SECP256K1_FE_CONST(0, 0, 0, 0, 0, 0, 0, 1);
+
+// Points in affine form (deserialized or normalized) are stored with z being exactly one,
+// this is the flag which lets the conversions below skip the field inversion.
+static bool is_affine(const secp256k1_gej &gej)
+{
+    return memcmp(gej.z.n, fe_one.n, sizeof(fe_one.n)) == 0;
+}
+
 // Converts the value from secp256k1_gej to secp256k1_ge and returns.
 static secp256k1_ge gej_to_ge(const secp256k1_gej &gej)
 {
     secp256k1_ge ge;
+    if (is_affine(gej)) {
+        ge.x = gej.x;
+        ge.y = gej.y;
+        ge.infinity = gej.infinity;
+        secp256k1_fe_normalize_var(&ge.x);
+        secp256k1_fe_normalize_var(&ge.y);
+        return ge;
+    }
+
     secp256k1_gej j(gej);
     secp256k1_ge_set_gej(&ge, &j);
     return ge;
 }
 
+// Converts all values to secp256k1_ge, sharing one inversion between the points not in affine form yet
+static std::vector<secp256k1_ge> gej_to_ge(const std::vector<const secp256k1_gej *>& values)
+{
+    std::vector<secp256k1_ge> result(values.size());
+    std::vector<secp256k1_gej> pending;
+    std::vector<std::size_t> pendingIndexes;
+    for (std::size_t i = 0; i < values.size(); ++i) {
+        const secp256k1_gej& gej = *values[i];
+        if (is_affine(gej) || gej.infinity) {
+            result[i] = gej_to_ge(gej);
+        } else {
+            pending.push_back(gej);
+            pendingIndexes.push_back(i);
+        }
+    }
+
+    if (!pending.empty()) {
+        std::vector<secp256k1_ge> converted(pending.size());
+        secp256k1_ge_set_all_gej_var(converted.data(), pending.data(), pending.size(), NULL);
+        for (std::size_t i = 0; i < pending.size(); ++i) {
+            secp256k1_fe_normalize_var(&converted[i].x);
+            secp256k1_fe_normalize_var(&converted[i].y);
+            result[pendingIndexes[i]] = converted[i];
+        }
+    }
+
+    return result;
+}
+
+static unsigned char* serialize_ge(const secp256k1_ge& value, unsigned char* buffer)
+{
+    secp256k1_fe x = value.x;
+    secp256k1_fe y = value.y;
+    secp256k1_fe_normalize(&x);
+    secp256k1_fe_normalize(&y);
+    unsigned char oddness = secp256k1_fe_is_odd(&y);
+    unsigned char infinity = value.infinity;
+    secp256k1_fe_get_b32(buffer, &x);
+    buffer[32] = oddness;
+    buffer[33] = infinity;
+    return buffer + secp_primitives::GroupElement::serialize_size;
+}
+
 //	Implements the algorithm from:
 //   Indifferentiable Hashing to Barreto-Naehrig Curves
 //    Pierre-Alain Fouque and Mehdi Tibouchi
@@ -506,17 +567,31 @@ unsigned char* GroupElement::serialize() const {
 }
 
 unsigned char* GroupElement::serialize(unsigned char* buffer) const {
-    secp256k1_ge value = gej_to_ge(*reinterpret_cast<secp256k1_gej *>(g_));
-    secp256k1_fe x = value.x;
-    secp256k1_fe y = value.y;
-    secp256k1_fe_normalize(&x);
-    secp256k1_fe_normalize(&y);
-    unsigned char oddness = secp256k1_fe_is_odd(&y);
-    unsigned char infinity = value.infinity;
-    secp256k1_fe_get_b32(buffer, &x);
-    buffer[32] = oddness;
-    buffer[33] = infinity;
-    return buffer + memoryRequired();
+    return serialize_ge(gej_to_ge(*reinterpret_cast<secp256k1_gej *>(g_)), buffer);
+}
+
+unsigned char* GroupElement::serialize(const std::vector<GroupElement>& elements, unsigned char* buffer) {
+    std::vector<const secp256k1_gej *> points;
+    points.reserve(elements.size());
+    for (const GroupElement& e : elements)
+        points.push_back(reinterpret_cast<const secp256k1_gej *>(e.g_));
+
+    for (const secp256k1_ge& value : gej_to_ge(points))
+        buffer = serialize_ge(value, buffer);
+    return buffer;
+}
+
+void GroupElement::normalize(std::vector<GroupElement>& elements) {
+    std::vector<const secp256k1_gej *> points;
+    points.reserve(elements.size());
+    for (const GroupElement& e : elements)
+        points.push_back(reinterpret_cast<const secp256k1_gej *>(e.g_));
+
+    std::vector<secp256k1_ge> values = gej_to_ge(points);
+    for (std::size_t i = 0; i < elements.size(); ++i) {
+        if (!values[i].infinity)
+            secp256k1_gej_set_ge(reinterpret_cast<secp256k1_gej *>(elements[i].g_), &values[i]);
+    }
 }
 
 const unsigned char* GroupElement::deserialize(const unsigned char* buffer) {
@@ -12,6 +12,8 @@
 #include "../src/scratch_impl.h"
 #include "../src/ecmult_impl.h"
 
+#include <algorithm>
+
 
 typedef struct {
     secp256k1_scalar *sc;
@@ -25,6 +27,50 @@ int ecmult_multi_callback(secp256k1_scalar *sc, secp256k1_gej *pt, size_t idx, v
     return 1;
 }
 
+namespace {
+
+// Largest scratch space a thread keeps for its next multiexponentiation, bigger ones are freed after use
+const size_t MAX_RETAINED_SCRATCH_SIZE = 256 * 1024;
+
+// Scratch space kept by a thread, so repeated multiexponentiations of similar size do not allocate
+// and free their buffers on every call
+class ScratchArena {
+public:
+    ~ScratchArena() {
+        secp256k1_scratch_destroy(scratch);
+    }
+
+    // Returns a scratch space allowing at least size bytes, a smaller one is replaced
+    secp256k1_scratch* acquire(size_t size) {
+        if (scratch != NULL && max_size < size) {
+            secp256k1_scratch_destroy(scratch);
+            scratch = NULL;
+        }
+        if (scratch == NULL) {
+            scratch = secp256k1_scratch_create(NULL, size);
+            max_size = size;
+        }
+        return scratch;
+    }
+
+    // Called once the scratch space is not used any more, frees it if it is too big to keep
+    void release() {
+        if (max_size > MAX_RETAINED_SCRATCH_SIZE) {
+            secp256k1_scratch_destroy(scratch);
+            scratch = NULL;
+            max_size = 0;
+        }
+    }
+
+private:
+    secp256k1_scratch *scratch = NULL;
+    size_t max_size = 0;
+};
+
+thread_local ScratchArena scratch_arena;
+
+}
+
 namespace secp_primitives {
 
 MultiExponent::MultiExponent(const MultiExponent& other)
@@ -56,29 +102,55 @@ MultiExponent::~MultiExponent(){
 }
 
 GroupElement MultiExponent::get_multiple() {
+    return get_multiple(0, n_points);
+}
+
+GroupElement MultiExponent::get_multiple(std::size_t begin, std::size_t end) const {
     secp256k1_gej r;
 
     ecmult_multi_data data;
-    data.sc = reinterpret_cast<secp256k1_scalar *>(sc_);
-    data.pt = reinterpret_cast<secp256k1_gej *>(pt_);
-
-    secp256k1_scratch *scratch;
-    if (n_points > ECMULT_PIPPENGER_THRESHOLD) {
-        int bucket_window = secp256k1_pippenger_bucket_window(n_points);
-        size_t scratch_size = secp256k1_pippenger_scratch_size(n_points, bucket_window);
-        scratch = secp256k1_scratch_create(NULL, scratch_size + PIPPENGER_SCRATCH_OBJECTS*ALIGNMENT);
+    data.sc = reinterpret_cast<secp256k1_scalar *>(sc_) + begin;
+    data.pt = reinterpret_cast<secp256k1_gej *>(pt_) + begin;
+
+    size_t n = end - begin;
+    size_t scratch_size;
+    if (n > ECMULT_PIPPENGER_THRESHOLD) {
+        int bucket_window = secp256k1_pippenger_bucket_window(n);
+        scratch_size = secp256k1_pippenger_scratch_size(n, bucket_window) + PIPPENGER_SCRATCH_OBJECTS*ALIGNMENT;
     } else {
-        size_t scratch_size = secp256k1_strauss_scratch_size(n_points);
-        scratch = secp256k1_scratch_create(NULL, scratch_size + STRAUSS_SCRATCH_OBJECTS*ALIGNMENT);
+        scratch_size = secp256k1_strauss_scratch_size(n) + STRAUSS_SCRATCH_OBJECTS*ALIGNMENT;
     }
 
     secp256k1_ecmult_context ctx;
 
-    secp256k1_ecmult_multi_var(&ctx, scratch, &r, NULL, ecmult_multi_callback, &data, n_points);
-
-    secp256k1_scratch_destroy(scratch);
+    secp256k1_ecmult_multi_var(&ctx, scratch_arena.acquire(scratch_size), &r, NULL, ecmult_multi_callback, &data, n);
+    scratch_arena.release();
 
     return  reinterpret_cast<secp256k1_scalar *>(&r);
 }
 
+GroupElement MultiExponent::get_multiple_parallel(std::size_t chunks, const TaskRunner& runner) const {
+    chunks = std::min(chunks, (std::size_t)n_points);
+    if (chunks <= 1)
+        return get_multiple(0, n_points);
+
+    std::size_t chunk_size = (n_points + chunks - 1) / chunks;
+    std::vector<GroupElement> partials(chunks);
+    std::vector<std::function<void()>> jobs;
+    jobs.reserve(chunks);
+    for (std::size_t i = 0; i < chunks; ++i) {
+        jobs.emplace_back([this, &partials, chunk_size, i]() {
+            std::size_t begin = std::min((std::size_t)n_points, i * chunk_size);
+            std::size_t end = std::min((std::size_t)n_points, begin + chunk_size);
+            partials[i] = get_multiple(begin, end);
+        });
+    }
+    runner(jobs);
+
+    GroupElement result;
+    for (const GroupElement& partial : partials)
+        result += partial;
+    return result;
+}
+
 }// namespace secp_primitives
@@ -15,6 +15,7 @@ typedef struct secp256k1_scratch_space_struct {
     void *data[SECP256K1_SCRATCH_MAX_FRAMES];
     size_t offset[SECP256K1_SCRATCH_MAX_FRAMES];
     size_t frame_size[SECP256K1_SCRATCH_MAX_FRAMES];
+    size_t capacity[SECP256K1_SCRATCH_MAX_FRAMES];
     size_t frame;
     size_t max_size;
     const secp256k1_callback* error_callback;
@@ -27,7 +28,7 @@ static void secp256k1_scratch_destroy(secp256k1_scratch* scratch);
 /** Attempts to allocate a new stack frame with `n` available bytes. Returns 1 on success, 0 on failure */
 static int secp256k1_scratch_allocate_frame(secp256k1_scratch* scratch, size_t n, size_t objects);
 
-/** Deallocates a stack frame */
+/** Deallocates a stack frame. The memory is kept for reuse by later frames until the scratch space is destroyed */
 static void secp256k1_scratch_deallocate_frame(secp256k1_scratch* scratch);
 
 /** Returns the maximum allocation the scratch space will allow */
@@ -13,6 +13,10 @@
 #include "sigma/coin.h"
 #include "primitives/mint_spend.h"
 #include "batchproof_container.h"
+#include "proofcache.h"
+#include "liblelantus/params.h"
+#include "proofthreadpool.h"
+#include "streams.h"
 
 #include <atomic>
 #include <sstream>
@@ -84,7 +88,7 @@ secp_primitives::GroupElement ParseSigmaMintScript(const CScript& script)
     return pub;
 }
 
-std::pair<std::unique_ptr<sigma::CoinSpend>, uint32_t> ParseSigmaSpend(const CTxIn& in)
+std::pair<std::shared_ptr<const sigma::CoinSpend>, uint32_t> ParseSigmaSpend(const CTxIn& in)
 {
     uint32_t groupId = in.prevout.n;
 
@@ -98,18 +102,33 @@ std::pair<std::unique_ptr<sigma::CoinSpend>, uint32_t> ParseSigmaSpend(const CTx
         PROTOCOL_VERSION
     );
 
-    std::unique_ptr<sigma::CoinSpend> spend(new sigma::CoinSpend(sigma::Params::get_default(), serialized));
+    std::shared_ptr<const sigma::CoinSpend> spend = std::make_shared<sigma::CoinSpend>(sigma::Params::get_default(), serialized);
 
     return std::make_pair(std::move(spend), groupId);
 }
 
-// This function will not report an error only if the transaction is sigma spend.
-CAmount GetSpendAmount(const CTxIn& in) {
+std::pair<std::shared_ptr<const sigma::CoinSpend>, uint32_t> ParseSigmaSpend(const CTransaction& tx, size_t nIn)
+{
+    const CTxIn& in = tx.vin.at(nIn);
+
+    // the proof of a transaction never changes, decode it only once
+    std::shared_ptr<const sigma::CoinSpend> spend = tx.GetParsedSigmaSpend(nIn);
+    if (spend)
+        return std::make_pair(std::move(spend), in.prevout.n);
+
+    auto result = ParseSigmaSpend(in);
+    result.first = tx.SetParsedSigmaSpend(nIn, result.first, in.scriptSig.size());
+    return result;
+}
+
+// Denomination of a sigma spend input parsed by parseSpend, 0 for other inputs and for spends that don't parse.
+template <typename ParseSpend>
+static CAmount GetSpendAmount(const CTxIn& in, ParseSpend parseSpend) {
     if (in.IsSigmaSpend()) {
-        std::unique_ptr<sigma::CoinSpend> spend;
+        std::shared_ptr<const sigma::CoinSpend> spend;
 
         try {
-            std::tie(spend, std::ignore) = ParseSigmaSpend(in);
+            std::tie(spend, std::ignore) = parseSpend();
         } catch (const std::ios_base::failure& e) {
             LogPrintf("GetSpendAmount: io error %s\n", e.what());
             return 0;
@@ -123,10 +142,16 @@ CAmount GetSpendAmount(const CTxIn& in) {
     return 0;
 }
 
+// This function will not report an error only if the transaction is sigma spend.
+CAmount GetSpendAmount(const CTxIn& in) {
+    return GetSpendAmount(in, [&in]() { return ParseSigmaSpend(in); });
+}
+
 CAmount GetSpendAmount(const CTransaction& tx) {
     CAmount sum(0);
-    for (const auto& vin : tx.vin) {
-        sum += GetSpendAmount(vin);
+    for (size_t i = 0; i < tx.vin.size(); i++) {
+        // through the transaction, so the proofs are decoded only once
+        sum += GetSpendAmount(tx.vin[i], [&tx, i]() { return ParseSigmaSpend(tx, i); });
     }
     return sum;
 }
@@ -199,7 +224,7 @@ bool CheckSigmaSpendTransaction(
 
     for (const CTxIn &txin : tx.vin)
     {
-        std::unique_ptr<sigma::CoinSpend> spend;
+        std::shared_ptr<const sigma::CoinSpend> spend;
         uint32_t coinGroupId;
 
         vinIndex++;
@@ -209,7 +234,7 @@ bool CheckSigmaSpendTransaction(
             hasNonSigmaInputs = true;
 
         try {
-            std::tie(spend, coinGroupId) = ParseSigmaSpend(txin);
+            std::tie(spend, coinGroupId) = ParseSigmaSpend(tx, vinIndex);
         }
         catch (CBadTxIn&) {
             return state.DoS(100,
@@ -265,6 +290,7 @@ bool CheckSigmaSpendTransaction(
         // find index for block with hash of accumulatorBlockHash or set index to the coinGroup.firstBlock if not found
         while (index != coinGroup.firstBlock && index->GetBlockHash() != accumulatorBlockHash)
             index = index->pprev;
+        uint256 anonymitySetBlockHash = index->GetBlockHash();
 
         // Build a vector with all the public coins with given denomination and accumulator id before
         // the block on which the spend occured.
@@ -294,15 +320,37 @@ bool CheckSigmaSpendTransaction(
                 return state.DoS(1, error("Incorrect sigma spend transaction version"));
         }
 
+        // everything the proof is verified against, the set is made of the coins up to its last block
+        CHashWriter proofKeyWriter = GetProofCacheKeyWriter(hashTx);
+        proofKeyWriter << vinIndex << (int64_t)targetDenominations[vinIndex] << coinGroupId << anonymitySetBlockHash
+                       << (uint64_t)anonymity_set.size() << fPadding << (nHeight >= params.nStartSigmaBlacklist);
+        uint256 proofKey = proofKeyWriter.GetHash();
+        // it may have been verified when the transaction was accepted to the mempool
+        bool fProofVerified = !isVerifyDB && IsProofVerified(proofKey);
+
         BatchProofContainer* batchProofContainer = BatchProofContainer::get_instance();
+        bool useBatching = batchProofContainer->fCollectProofs && !fProofVerified;
+        // when connecting a block at the tip the proof is verified on the proof threads, see CheckLelantusJoinSplitTransaction
+        bool fDeferVerification = batchProofContainer->fDeferProofs && !useBatching && !fProofVerified && !isVerifyDB && !isCheckWallet &&
+                nHeight != INT_MAX && sigmaTxInfo && !sigmaTxInfo->fInfoIsComplete;
         // if we are collecting proofs, skip verification and collect proofs
-        passVerify = spend->Verify(anonymity_set, newMetaData, fPadding, batchProofContainer->fCollectProofs);
+        passVerify = spend->Verify(anonymity_set, newMetaData, fPadding, useBatching || fProofVerified || fDeferVerification);
+
+        if (passVerify && fDeferVerification) {
+            auto set = std::make_shared<const std::vector<sigma::PublicCoin>>(std::move(anonymity_set));
+            batchProofContainer->defer([spend, set, newMetaData, fPadding]() {
+                return spend->Verify(*set, newMetaData, fPadding);
+            });
+        }
 
         // add proofs into container
-        if(batchProofContainer->fCollectProofs) {
+        if(useBatching) {
             batchProofContainer->add(spend.get(), fPadding, coinGroupId, anonymity_set.size(), nHeight >= params.nStartSigmaBlacklist);
         }
 
+        if (passVerify && nHeight == INT_MAX && !useBatching)
+            SetProofVerified(proofKey);
+
         if (passVerify) {
             Scalar serial = spend->getCoinSerialNumber();
             // do not check for duplicates in case we've seen exact copy of this tx in this block before
@@ -525,11 +573,11 @@ void RemoveSigmaSpendsReferencingBlock(CTxMemPool& pool, CBlockIndex* blockIndex
         if (tx.IsSigmaSpend()) {
             // Run over all the inputs, check if their Accumulator block hash is equal to
             // block removed. If any one is equal, remove txn from mempool.
-            for (const CTxIn& txin : tx.vin) {
-                if (txin.IsSigmaSpend()) {
-                    std::unique_ptr<sigma::CoinSpend> spend;
+            for (size_t i = 0; i < tx.vin.size(); i++) {
+                if (tx.vin[i].IsSigmaSpend()) {
+                    std::shared_ptr<const sigma::CoinSpend> spend;
                     uint32_t pubcoinId;
-                    std::tie(spend, pubcoinId) = ParseSigmaSpend(txin);
+                    std::tie(spend, pubcoinId) = ParseSigmaSpend(tx, i);
                     uint256 accumulatorBlockHash = spend->getAccumulatorBlockHash();
                     if (accumulatorBlockHash == blockIndex->GetBlockHash()) {
                         // Do not remove transaction immediately, that will invalidate iterator mi.
@@ -735,6 +783,37 @@ bool GetOutPoint(COutPoint& outPoint, const uint256 &pubCoinValueHash) {
     return GetOutPoint(outPoint, pubCoinValue);
 }
 
+bool GetOutPoints(std::map<uint256, COutPoint>& outPoints, const std::vector<uint256> &pubCoinValueHashes) {
+    sigma::CSigmaState *sigmaState = sigma::CSigmaState::GetState();
+    std::set<uint256> hashesToFind(pubCoinValueHashes.begin(), pubCoinValueHashes.end());
+
+    // a single pass over the minted coins, grouped by mint height so that every block is read only once
+    std::map<int, std::vector<std::pair<uint256, GroupElement>>> mintsByHeight;
+    for (const auto& mint : sigmaState->GetMints()) {
+        uint256 pubCoinValueHash = mint.first.getValueHash();
+        if (hashesToFind.erase(pubCoinValueHash))
+            mintsByHeight[mint.second.nHeight].emplace_back(pubCoinValueHash, mint.first.getValue());
+        if (hashesToFind.empty())
+            break;
+    }
+
+    for (const auto& heightAndMints : mintsByHeight) {
+        CBlock block;
+        if (!ReadBlockFromDisk(block, chainActive[heightAndMints.first], ::Params().GetConsensus())) {
+            LogPrintf("can't read block from disk.\n");
+            continue;
+        }
+
+        for (const auto& hashAndValue : heightAndMints.second) {
+            COutPoint outPoint;
+            if (GetOutPointFromBlock(outPoint, hashAndValue.second, block))
+                outPoints[hashAndValue.first] = outPoint;
+        }
+    }
+
+    return !outPoints.empty();
+}
+
 bool BuildSigmaStateFromIndex(CChain *chain) {
     for (CBlockIndex *blockIndex = chain->Genesis(); blockIndex; blockIndex=chain->Next(blockIndex))
     {
@@ -808,6 +887,37 @@ void CSigmaState::Containers::RemoveSpend(Scalar const & serial) {
     }
 }
 
+void CSigmaState::Containers::RestoreFromIndex(CChain *chain, std::size_t nMints, std::size_t nSpends) {
+    Reset();
+    mintedPubCoins.reserve(nMints);
+    usedCoinSerials.reserve(nSpends);
+
+    for (CBlockIndex *index = chain->Genesis(); index; index = chain->Next(index)) {
+        for (auto const &pubCoins : index->sigmaMintedPubCoins) {
+            if (pubCoins.second.empty())
+                continue;
+
+            CoinDenomination denomination = pubCoins.first.first;
+            int coinGroupId = pubCoins.first.second;
+            for (auto const &coin : pubCoins.second) {
+                mintedPubCoins.insert(std::make_pair(coin, CMintedCoinInfo::make(denomination, coinGroupId, index->nHeight)));
+            }
+            mintMetaInfo[coinGroupId][denomination] += pubCoins.second.size();
+        }
+
+        for (auto const &serial : index->sigmaSpentSerials) {
+            usedCoinSerials[serial.first] = serial.second;
+            spendMetaInfo[serial.second.coinGroupId][serial.second.denomination] += 1;
+        }
+    }
+
+    // every group is checked, not only the one passed
+    if (!spendMetaInfo.empty()) {
+        auto const &group = *spendMetaInfo.begin();
+        CheckSurgeCondition(group.first, group.second.begin()->first);
+    }
+}
+
 mint_info_container const & CSigmaState::Containers::GetMints() const {
     return mintedPubCoins;
 }
@@ -846,6 +956,91 @@ void CSigmaState::Containers::CheckSurgeCondition(int groupId, CoinDenomination
     surgeCondition = result;
 }
 
+/******************************************************************************/
+// CSigmaState::ConvertedSet
+/******************************************************************************/
+
+CSigmaState::ConvertedSet::ConvertedSet(SigmaCoinGroupInfo const &coinGroup, CoinDenomination denomination, int coinGroupId)
+    : lastBlock(coinGroup.lastBlock), nCoins(coinGroup.nCoins)
+{
+    std::pair<CoinDenomination, int> denomAndId = std::make_pair(denomination, coinGroupId);
+
+    std::vector<CBlockIndex *> groupBlocks;
+    for (CBlockIndex *block = coinGroup.lastBlock; block; block = block->pprev) {
+        auto blockCoins = block->sigmaMintedPubCoins.find(denomAndId);
+        if (blockCoins != block->sigmaMintedPubCoins.end() && !blockCoins->second.empty())
+            groupBlocks.push_back(block);
+        if (block == coinGroup.firstBlock)
+            break;
+    }
+
+    auto const &blacklist = ::Params().GetConsensus().sigmaBlacklist;
+    std::vector<GroupElement> sigmaCoins;
+    sigmaCoins.reserve(std::max(coinGroup.nCoins, 0));
+    std::vector<char> blacklisted;
+    blacklisted.reserve(sigmaCoins.capacity());
+    std::size_t nFiltered = 0;
+
+    blocks.reserve(groupBlocks.size());
+    for (auto block = groupBlocks.rbegin(); block != groupBlocks.rend(); ++block) {
+        auto const &blockCoins = (*block)->sigmaMintedPubCoins[denomAndId];
+        for (auto coin = blockCoins.rbegin(); coin != blockCoins.rend(); ++coin) {
+            sigmaCoins.push_back(coin->getValue());
+            blacklisted.push_back(blacklist.count(coin->getValue()) > 0);
+            if (!blacklisted.back())
+                nFiltered++;
+        }
+        blocks.push_back({*block, sigmaCoins.size(), nFiltered});
+    }
+
+    // every coin is offset by the same point, so the conversion is one addition per coin. The sums are
+    // normalized in one batch per chunk, as the set is hashed and serialized for every proof using it
+    int64_t intDenom;
+    DenominationToInteger(denomination, intDenom);
+    GroupElement denomOffset = lelantus::Params::get_default()->get_h1() * Scalar(uint64_t(intDenom));
+
+    coins.resize(sigmaCoins.size());
+    ProofThreadPool& threadPool = ProofThreadPool::GetInstance();
+    std::size_t nChunks = std::max<std::size_t>(std::min(sigmaCoins.size(), threadPool.GetNumberOfThreads()), 1);
+    std::vector<std::function<void()>> jobs;
+    for (std::size_t i = 0; i < nChunks; i++) {
+        jobs.emplace_back([this, &sigmaCoins, &denomOffset, i, nChunks]() {
+            std::size_t begin = sigmaCoins.size() * i / nChunks, end = sigmaCoins.size() * (i + 1) / nChunks;
+            std::vector<GroupElement> converted;
+            converted.reserve(end - begin);
+            for (std::size_t j = begin; j < end; j++)
+                converted.push_back(sigmaCoins[j] + denomOffset);
+            GroupElement::normalize(converted);
+            for (std::size_t j = begin; j < end; j++)
+                coins[j] = lelantus::PublicCoin(converted[j - begin]);
+        });
+    }
+    threadPool.RunAll(jobs);
+
+    if (nFiltered != coins.size()) {
+        filteredCoins.reserve(nFiltered);
+        for (std::size_t j = 0; j < coins.size(); j++) {
+            if (!blacklisted[j])
+                filteredCoins.push_back(coins[j]);
+        }
+    }
+}
+
+CSigmaState::ConvertedSet::BlockEntry const *CSigmaState::ConvertedSet::GetLastBlock(int maxHeight) const {
+    auto next = std::upper_bound(blocks.begin(), blocks.end(), maxHeight,
+        [](int height, BlockEntry const &entry) { return height < entry.block->nHeight; });
+
+    return next == blocks.begin() ? nullptr : &*(next - 1);
+}
+
+std::pair<CSigmaState::ConvertedSet::const_iterator, CSigmaState::ConvertedSet::const_iterator>
+CSigmaState::ConvertedSet::GetCoins(BlockEntry const &last, bool fSkipBlacklisted) const {
+    if (fSkipBlacklisted && last.filteredCoinsEnd != last.coinsEnd) {
+        return std::make_pair(filteredCoins.rend() - last.filteredCoinsEnd, filteredCoins.rend());
+    }
+    return std::make_pair(coins.rend() - last.coinsEnd, coins.rend());
+}
+
 /******************************************************************************/
 // CSigmaState
 /******************************************************************************/
@@ -1126,6 +1321,46 @@ void CSigmaState::GetAnonymitySet(
     }
 }
 
+std::shared_ptr<const CSigmaState::ConvertedSet> CSigmaState::GetConvertedSet(
+        sigma::CoinDenomination denomination,
+        int coinGroupID) {
+    std::pair<sigma::CoinDenomination, int> denomAndId = std::make_pair(denomination, coinGroupID);
+
+    auto coinGroup = coinGroups.find(denomAndId);
+    if (coinGroup == coinGroups.end())
+        return nullptr;
+
+    LOCK(cs_convertedSets);
+    std::shared_ptr<const ConvertedSet> &convertedSet = convertedSets[denomAndId];
+    if (!convertedSet || convertedSet->lastBlock != coinGroup->second.lastBlock || convertedSet->nCoins != coinGroup->second.nCoins)
+        convertedSet = std::make_shared<const ConvertedSet>(coinGroup->second, denomination, coinGroupID);
+
+    return convertedSet;
+}
+
+void CSigmaState::GetConvertedAnonymitySet(
+        sigma::CoinDenomination denomination,
+        int coinGroupID,
+        bool fStartSigmaBlacklist,
+        std::vector<lelantus::PublicCoin>& coins_out) {
+
+    coins_out.clear();
+
+    std::shared_ptr<const ConvertedSet> convertedSet = GetConvertedSet(denomination, coinGroupID);
+    if (!convertedSet)
+        return;
+
+    const auto &params = ::Params().GetConsensus();
+    int maxHeight = fStartSigmaBlacklist ? (chainActive.Height() - (ZC_MINT_CONFIRMATIONS - 1)) : (params.nStartSigmaBlacklist - 1);
+
+    ConvertedSet::BlockEntry const *lastBlock = convertedSet->GetLastBlock(maxHeight);
+    if (!lastBlock)
+        return;
+
+    auto coins = convertedSet->GetCoins(*lastBlock, fStartSigmaBlacklist && chainActive.Height() >= params.nStartSigmaBlacklist);
+    coins_out.assign(coins.first, coins.second);
+}
+
 std::pair<int, int> CSigmaState::GetMintedCoinHeightAndId(
         const sigma::PublicCoin& pubCoin) {
     auto coinIt = containers.GetMints().find(pubCoin);
@@ -1189,9 +1424,71 @@ void CSigmaState::Reset() {
     latestCoinIds.clear();
     mempoolCoinSerials.clear();
     mempoolMints.clear();
+    {
+        LOCK(cs_convertedSets);
+        convertedSets.clear();
+    }
     containers.Reset();
 }
 
+void CSigmaState::WriteSnapshot(CAutoFile& file) const {
+    file << (uint64_t)GetMints().size();
+    file << (uint64_t)GetSpends().size();
+
+    // blocks are referred to by height, the snapshot is only valid for the chain it was written for
+    file << (uint64_t)coinGroups.size();
+    for (auto const &group : coinGroups) {
+        file << (uint8_t)group.first.first;
+        file << group.first.second;
+        file << (group.second.firstBlock ? group.second.firstBlock->nHeight : -1);
+        file << (group.second.lastBlock ? group.second.lastBlock->nHeight : -1);
+        file << group.second.nCoins;
+    }
+
+    file << (uint64_t)latestCoinIds.size();
+    for (auto const &id : latestCoinIds) {
+        file << (uint8_t)id.first;
+        file << id.second;
+    }
+}
+
+bool CSigmaState::ReadSnapshot(CAutoFile& file, CChain *chain) {
+    Reset();
+
+    uint64_t nMints, nSpends, nGroups;
+    file >> nMints;
+    file >> nSpends;
+
+    file >> nGroups;
+    for (uint64_t i = 0; i < nGroups; i++) {
+        uint8_t denomination;
+        int id, firstHeight, lastHeight;
+        file >> denomination;
+        file >> id;
+        file >> firstHeight;
+        file >> lastHeight;
+
+        SigmaCoinGroupInfo &coinGroup = coinGroups[std::make_pair(CoinDenomination(denomination), id)];
+        file >> coinGroup.nCoins;
+        coinGroup.firstBlock = (*chain)[firstHeight];
+        coinGroup.lastBlock = (*chain)[lastHeight];
+        if (!coinGroup.firstBlock || !coinGroup.lastBlock)
+            return false;
+    }
+
+    uint64_t nIds;
+    file >> nIds;
+    for (uint64_t i = 0; i < nIds; i++) {
+        uint8_t denomination;
+        file >> denomination;
+        file >> latestCoinIds[CoinDenomination(denomination)];
+    }
+
+    containers.RestoreFromIndex(chain, nMints, nSpends);
+
+    return GetMints().size() == nMints && GetSpends().size() == nSpends;
+}
+
 CSigmaState* CSigmaState::GetState() {
     return &sigmaState;
 }
@@ -9,11 +9,16 @@
 #include <secp256k1/include/Scalar.h>
 #include <secp256k1/include/GroupElement.h>
 #include "sigma/params.h"
+#include "liblelantus/coin.h"
+#include "sync.h"
+#include <memory>
 #include <unordered_set>
 #include <unordered_map>
 #include <functional>
 #include "coin_containers.h"
 
+class CAutoFile;
+
 //tests
 namespace sigma_mintspend_many { class sigma_mintspend_many; }
 namespace sigma_mintspend { class sigma_mintspend_test; }
@@ -57,7 +62,9 @@ bool CheckSigmaSpendSerial(
         bool fConnectTip);
 
 secp_primitives::GroupElement ParseSigmaMintScript(const CScript& script);
-std::pair<std::unique_ptr<sigma::CoinSpend>, uint32_t> ParseSigmaSpend(const CTxIn& in);
+std::pair<std::shared_ptr<const sigma::CoinSpend>, uint32_t> ParseSigmaSpend(const CTxIn& in);
+// Same as above for input nIn of the transaction, the parsed spend is kept with the transaction
+std::pair<std::shared_ptr<const sigma::CoinSpend>, uint32_t> ParseSigmaSpend(const CTransaction& tx, size_t nIn);
 CAmount GetSpendAmount(const CTxIn& in);
 CAmount GetSpendAmount(const CTransaction& tx);
 bool CheckSigmaBlock(CValidationState &state, const CBlock& block);
@@ -88,6 +95,8 @@ bool GetOutPointFromBlock(COutPoint& outPoint, const GroupElement &pubCoinValue,
 bool GetOutPoint(COutPoint& outPoint, const sigma::PublicCoin &pubCoin);
 bool GetOutPoint(COutPoint& outPoint, const GroupElement &pubCoinValue);
 bool GetOutPoint(COutPoint& outPoint, const uint256 &pubCoinValueHash);
+// Batch version of the above, found outpoints are stored by pubcoin hash and every block is read once
+bool GetOutPoints(std::map<uint256, COutPoint>& outPoints, const std::vector<uint256> &pubCoinValueHashes);
 
 bool BuildSigmaStateFromIndex(CChain *chain);
 
@@ -119,6 +128,41 @@ public:
             return std::hash<T>()(x.first) ^ std::hash<U>()(x.second);
           }
     };
+
+    // Coins of a coin group turned into Lelantus coins (pubcoin + h1 * denomination), the anonymity sets of
+    // Sigma-to-Lelantus joinsplits. Laid out like lelantus::CLelantusState::AnonymitySet: every block appends its
+    // coins in reverse order, so the set as of any block is the reversed prefix ending at that block.
+    class ConvertedSet {
+    public:
+        typedef std::vector<lelantus::PublicCoin>::const_reverse_iterator const_iterator;
+
+        struct BlockEntry {
+            CBlockIndex *block;
+            // end of the block's coins in the full and the blacklist filtered lists
+            std::size_t coinsEnd;
+            std::size_t filteredCoinsEnd;
+        };
+
+    public:
+        ConvertedSet(SigmaCoinGroupInfo const &coinGroup, CoinDenomination denomination, int coinGroupId);
+
+        // Latest block at or below maxHeight, nullptr if there is none
+        BlockEntry const *GetLastBlock(int maxHeight) const;
+
+        // Coins of the set as of the given block in the anonymity set order, optionally without the
+        // blacklisted ones
+        std::pair<const_iterator, const_iterator> GetCoins(BlockEntry const &last, bool fSkipBlacklisted) const;
+
+        // the group as it was when the set was built
+        CBlockIndex *lastBlock;
+        int nCoins;
+
+    private:
+        std::vector<lelantus::PublicCoin> coins;
+        // only filled if the group has a blacklisted coin, until then it equals coins
+        std::vector<lelantus::PublicCoin> filteredCoins;
+        std::vector<BlockEntry> blocks;
+    };
 public:
     CSigmaState();
 
@@ -165,12 +209,31 @@ public:
             bool fStartSigmaBlacklist,
             std::vector<GroupElement>& coins_out);
 
+    // Coins of the group converted for Sigma-to-Lelantus joinsplits. The set is built once and shared until the
+    // group changes, which no longer happens once Sigma mints are disabled. nullptr if there is no such group
+    std::shared_ptr<const ConvertedSet> GetConvertedSet(sigma::CoinDenomination denomination, int coinGroupID);
+
+    // Same as GetAnonymitySet for Sigma-to-Lelantus joinsplits, taken from the converted set
+    void GetConvertedAnonymitySet(
+            sigma::CoinDenomination denomination,
+            int coinGroupID,
+            bool fStartSigmaBlacklist,
+            std::vector<lelantus::PublicCoin>& coins_out);
+
     // Return height of mint transaction and id of minted coin
     std::pair<int, int> GetMintedCoinHeightAndId(const sigma::PublicCoin& pubCoin);
 
     // Reset to initial values
     void Reset();
 
+    // Write the coin groups of the state. The coins are not written, they are restored from the
+    // block index
+    void WriteSnapshot(CAutoFile& file) const;
+
+    // Restore the state written by WriteSnapshot for the tip of the chain without replaying every
+    // block, returns false if the snapshot doesn't match the block index
+    bool ReadSnapshot(CAutoFile& file, CChain *chain);
+
     // Check if there is a conflicting tx in the blockchain or mempool
     bool CanAddSpendToMempool(const Scalar& coinSerial);
 
@@ -222,6 +285,10 @@ private:
 
     std::unordered_set<GroupElement> mempoolMints;
 
+    // Converted sets built so far
+    CCriticalSection cs_convertedSets;
+    std::unordered_map<std::pair<CoinDenomination, int>, std::shared_ptr<const ConvertedSet>, pairhash> convertedSets;
+
     std::atomic<bool> surgeCondition;
 
     struct Containers {
@@ -235,6 +302,9 @@ private:
 
         void Reset();
 
+        // Add every mint and spend of the chain in one pass, checking the surge condition once
+        void RestoreFromIndex(CChain *chain, std::size_t nMints, std::size_t nSpends);
+
         mint_info_container const & GetMints() const;
         spend_info_container const & GetSpends() const;
         bool IsSurgeCondition() const;
@@ -27,7 +27,8 @@ CoinSpend::CoinSpend(
         params->get_g(),
         params->get_h(),
         params->get_n(),
-        params->get_m());
+        params->get_m(),
+        &params->get_table());
     //compute inverse of g^s
     GroupElement gs = (params->get_g() * coinSerialNumber).inverse();
     std::vector<GroupElement> C_;
@@ -147,11 +148,11 @@ bool CoinSpend::Verify(
     return sigmaVerifier.verify(C_, sigmaProof, fPadding);
 }
 
-const Scalar& CoinSpend::getCoinSerialNumber() {
+const Scalar& CoinSpend::getCoinSerialNumber() const {
     return this->coinSerialNumber;
 }
 
-const SigmaPlusProof<Scalar, GroupElement>& CoinSpend::getProof() {
+const SigmaPlusProof<Scalar, GroupElement>& CoinSpend::getProof() const {
     return this->sigmaProof;
 }
 
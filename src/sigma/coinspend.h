@@ -30,9 +30,9 @@ public:
 
     void updateMetaData(const PrivateCoin& coin, const SpendMetaData& m);
 
-    const Scalar& getCoinSerialNumber();
+    const Scalar& getCoinSerialNumber() const;
 
-    const SigmaPlusProof<Scalar, GroupElement>& getProof();
+    const SigmaPlusProof<Scalar, GroupElement>& getProof() const;
 
     CoinDenomination getDenomination() const;
 
@@ -71,4 +71,15 @@ uint64_t Params::get_m() const{
     return m_;
 }
 
+const FixedBaseTable& Params::get_table() const{
+    std::call_once(table_flag, [this]() {
+        std::vector<GroupElement> generators;
+        generators.reserve(h_.size() + 1);
+        generators.emplace_back(g_);
+        generators.insert(generators.end(), h_.begin(), h_.end());
+        table_.reset(new FixedBaseTable(generators));
+    });
+    return *table_;
+}
+
 } //namespace sigma
@@ -2,8 +2,12 @@
 #define FIRO_SIGMA_PARAMS_H
 #include <secp256k1/include/Scalar.h>
 #include <secp256k1/include/GroupElement.h>
+#include <secp256k1/include/FixedBaseTable.h>
 #include <serialize.h>
 
+#include <memory>
+#include <mutex>
+
 using namespace secp_primitives;
 
 namespace sigma {
@@ -17,6 +21,9 @@ public:
     uint64_t get_n() const;
     uint64_t get_m() const;
 
+    // Precomputed table of [g, h...] for SigmaPlusProver, built on first use
+    const FixedBaseTable& get_table() const;
+
 private:
    Params(const GroupElement& g, int n, int m);
     ~Params();
@@ -27,6 +34,9 @@ private:
     std::vector<GroupElement> h_;
     int m_;
     int n_;
+
+    mutable std::once_flag table_flag;
+    mutable std::unique_ptr<FixedBaseTable> table_;
 };
 
 }//namespace sigma
@@ -10,12 +10,14 @@ template <class Exponent, class GroupElement>
 class R1ProofGenerator{
 
 public:
+    // table is an optional precomputed table of [g, h_gens...]
     R1ProofGenerator(const GroupElement& g,
                      const std::vector<GroupElement>& h_gens,
                      const std::vector<Exponent>& b,
                      const Exponent& r,
                      int n,
-                     int m);
+                     int m,
+                     const secp_primitives::FixedBaseTable* table = nullptr);
 
     // Returns commitment B.
     const GroupElement& get_B() const;
@@ -43,6 +45,9 @@ public:
     void generate_final_response(const std::vector<Exponent>& a,
                                  const Exponent& challenge_x,
                                  R1Proof<Exponent, GroupElement>& proof_out);
+private:
+    void commit(const std::vector<Exponent>& exp, const Exponent& r, GroupElement& result_out) const;
+
 private:
 
     Exponent rA_;
@@ -52,6 +57,7 @@ private:
     // Generators for the commitment. Size of h_ must be n*m.
     const GroupElement& g_;
     const std::vector<GroupElement>& h_;
+    const secp_primitives::FixedBaseTable* table_;
 
     // n*m values of a matrix describing index l of the coin being spent.
     // Each value in this vector is a bit, I.E. 0 or 1.
@@ -7,15 +7,26 @@ R1ProofGenerator<Exponent,GroupElement>::R1ProofGenerator(
         const std::vector<Exponent>& b,
         const Exponent& r,
         int n ,
-        int m)
+        int m,
+        const secp_primitives::FixedBaseTable* table)
     : g_(g)
     , h_(h_gens)
+    , table_(table)
     , b_(b)
     , r(r)
     , n_(n)
     , m_(m)
 {
-    SigmaPrimitives<Exponent, GroupElement>::commit(g_, h_, b_, r, B_Commit);
+    commit(b_, r, B_Commit);
+}
+
+template<class Exponent, class GroupElement>
+void R1ProofGenerator<Exponent,GroupElement>::commit(
+        const std::vector<Exponent>& exp, const Exponent& r, GroupElement& result_out) const {
+    if (table_)
+        SigmaPrimitives<Exponent, GroupElement>::commit(*table_, exp, r, result_out);
+    else
+        SigmaPrimitives<Exponent, GroupElement>::commit(g_, h_, exp, r, result_out);
 }
 
 template<class Exponent, class GroupElement>
@@ -51,7 +62,7 @@ void R1ProofGenerator<Exponent,GroupElement>::proof(
     GroupElement A;
     while(!A.isMember() || A.isInfinity()) {
         rA_.randomize();
-        SigmaPrimitives<Exponent, GroupElement>::commit(g_, h_, a_out, rA_, A);
+        commit(a_out, rA_, A);
     }
     proof_out.A_ = A;
 
@@ -64,7 +75,7 @@ void R1ProofGenerator<Exponent,GroupElement>::proof(
     GroupElement C;
     while(!C.isMember() || C.isInfinity()) {
         rC_.randomize();
-        SigmaPrimitives<Exponent, GroupElement>::commit(g_, h_, c, rC_, C);
+        commit(c, rC_, C);
     }
     proof_out.C_ = C;
 
@@ -77,7 +88,7 @@ void R1ProofGenerator<Exponent,GroupElement>::proof(
     GroupElement D;
     while(!D.isMember() || D.isInfinity()) {
         rD_.randomize();
-        SigmaPrimitives<Exponent, GroupElement>::commit(g_, h_, d, rD_, D);
+        commit(d, rD_, D);
     }
     proof_out.D_ = D;
 
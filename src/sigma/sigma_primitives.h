@@ -2,6 +2,7 @@
 #define FIRO_SIGMA_SIGMA_PRIMITIVES_H
 
 #include "../secp256k1/include/MultiExponent.h"
+#include "../secp256k1/include/FixedBaseTable.h"
 #include "../secp256k1/include/GroupElement.h"
 #include "../secp256k1/include/Scalar.h"
 
@@ -33,6 +34,12 @@ public:
             const Exponent& r,
             GroupElement& result_out);
 
+    // Same commitment with g and h taken from a table of [g, h...]
+    static void commit(const secp_primitives::FixedBaseTable& gens,
+            const std::vector<Exponent>& exp,
+            const Exponent& r,
+            GroupElement& result_out);
+
     static GroupElement commit(const GroupElement& g, const Exponent m, const GroupElement h, const Exponent r);
 
     static void convert_to_sigma(std::size_t num, std::size_t n, std::size_t m, std::vector<Exponent>& out);
@@ -12,6 +12,14 @@ void SigmaPrimitives<Exponent, GroupElement>::commit(const GroupElement& g,
     result_out += g * r + mult.get_multiple();
 }
 
+template<class Exponent, class GroupElement>
+void SigmaPrimitives<Exponent, GroupElement>::commit(const secp_primitives::FixedBaseTable& gens,
+        const std::vector<Exponent>& exp,
+        const Exponent& r,
+        GroupElement& result_out) {
+    result_out += gens.multiply(0, r) + gens.multi_multiply(1, exp);
+}
+
 template<class Exponent, class GroupElement>
 GroupElement SigmaPrimitives<Exponent, GroupElement>::commit(
         const GroupElement& g,
@@ -67,10 +75,7 @@ void SigmaPrimitives<Exponent, GroupElement>::generate_challenge(
         throw std::runtime_error("Group elements empty while generating a challenge.");
     CSHA256 hash;
     std::vector<unsigned char> data(group_elements.size() * group_elements[0].memoryRequired());
-    unsigned char* current = data.data();
-    for (size_t i = 0; i < group_elements.size(); ++i) {
-        current = group_elements[i].serialize(current);
-    }
+    GroupElement::serialize(group_elements, data.data());
     hash.Write(data.data(), data.size());
     unsigned char result_data[CSHA256::OUTPUT_SIZE];
     hash.Finalize(result_data);
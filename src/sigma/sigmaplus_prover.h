@@ -12,8 +12,10 @@ template <class Exponent, class GroupElement>
 class SigmaPlusProver{
 
 public:
+    // table is an optional precomputed table of [g, h_gens...]
     SigmaPlusProver(const GroupElement& g,
-                    const std::vector<GroupElement>& h_gens, std::size_t n, std::size_t m);
+                    const std::vector<GroupElement>& h_gens, std::size_t n, std::size_t m,
+                    const secp_primitives::FixedBaseTable* table = nullptr);
     void proof(const std::vector<GroupElement>& commits,
                std::size_t l,
                const Exponent& r,
@@ -25,6 +27,7 @@ private:
     std::vector<GroupElement> h_;
     std::size_t n_;
     std::size_t m_;
+    const secp_primitives::FixedBaseTable* table_;
 };
 
 } // namespace sigma
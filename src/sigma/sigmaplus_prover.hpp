@@ -6,11 +6,13 @@ SigmaPlusProver<Exponent, GroupElement>::SigmaPlusProver(
         const GroupElement& g,
         const std::vector<GroupElement>& h_gens,
         std::size_t n,
-        std::size_t m)
+        std::size_t m,
+        const secp_primitives::FixedBaseTable* table)
     : g_(g)
     , h_(h_gens)
     , n_(n)
-    , m_(m) {
+    , m_(m)
+    , table_(table) {
 }
 
 template<class Exponent, class GroupElement>
@@ -22,6 +24,7 @@ void SigmaPlusProver<Exponent, GroupElement>::proof(
         SigmaPlusProof<Exponent, GroupElement>& proof_out) {
     std::size_t setSize = commits.size();
     assert(setSize > 0);
+    assert(!table_ || table_->size() == h_.size() + 1);
 
     Exponent rB;
     rB.randomize();
@@ -36,7 +39,7 @@ void SigmaPlusProver<Exponent, GroupElement>::proof(
     for (std::size_t k = 0; k < m_; ++k) {
         Pk[k].randomize();
     }
-    R1ProofGenerator<secp_primitives::Scalar, secp_primitives::GroupElement> r1prover(g_, h_, sigma, rB, n_, m_);
+    R1ProofGenerator<secp_primitives::Scalar, secp_primitives::GroupElement> r1prover(g_, h_, sigma, rB, n_, m_, table_);
     proof_out.B_ = r1prover.get_B();
     std::vector<Exponent> a;
     r1prover.proof(a, proof_out.r1Proof_, true /*Skip generation of final response*/);
@@ -119,7 +122,10 @@ void SigmaPlusProver<Exponent, GroupElement>::proof(
         }
         secp_primitives::MultiExponent mult(commits, P_i);
         GroupElement c_k = mult.get_multiple();
-        c_k += SigmaPrimitives<Exponent, GroupElement>::commit(g_, Exponent(uint64_t(0)), h_[0], Pk[k]);
+        if (table_)
+            c_k += table_->multiply(1, Pk[k]);
+        else
+            c_k += SigmaPrimitives<Exponent, GroupElement>::commit(g_, Exponent(uint64_t(0)), h_[0], Pk[k]);
         Gk.emplace_back(c_k);
     }
     proof_out.Gk_ = Gk;
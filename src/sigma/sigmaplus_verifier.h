@@ -3,6 +3,7 @@
 
 #include "r1_proof_verifier.h"
 #include "util.h"
+#include "../proofthreadpool.h"
 
 namespace sigma {
 template<class Exponent, class GroupElement>
@@ -42,9 +43,23 @@ public:
             typename std::vector<Exponent>::iterator& ptr,
             typename std::vector<Exponent>::iterator start_ptr,
             typename std::vector<Exponent>::iterator end_ptr) const;
+    void compute_batch_fis_range(
+            const Exponent& f_i,
+            int j,
+            const std::vector<Exponent>& f,
+            const Exponent& y,
+            Exponent& e,
+            std::size_t offset,
+            std::size_t begin,
+            std::size_t end,
+            typename std::vector<Exponent>::iterator leaves) const;
 
+    GroupElement parallel_multiexp(const std::vector<GroupElement>& points, const std::vector<Exponent>& scalars) const;
 
 private:
+    // Smallest number of commitments or points worth handing to a separate thread
+    static const std::size_t minParallelRange = 1024;
+
     GroupElement g_;
     std::vector<GroupElement> h_;
     std::size_t n;
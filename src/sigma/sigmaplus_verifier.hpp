@@ -83,6 +83,10 @@ bool SigmaPlusVerifier<Exponent, GroupElement>::batch_verify(
         LogPrintf("Padding vector size is invalid");
         return false;
     }
+    if (setSizes.size() != M) {
+        LogPrintf("Invalid set size vector size");
+        return false;
+    }
     
     // All proof elements must be valid
     for (std::size_t t = 0; t < M; ++t) {
@@ -92,21 +96,79 @@ bool SigmaPlusVerifier<Exponent, GroupElement>::batch_verify(
         }
     }
 
+    // Per-proof challenges, verifier weights and f-matrices, computed up front so the commitment
+    // scalars below can be filled in parallel by index range
+    std::vector<Exponent> challenges(M);
+    std::vector<Scalar> w1s(M), w2s(M), w3s(M);
+    std::vector<std::vector<Exponent>> fs(M);
+    for (std::size_t t = 0; t < M; t++) {
+        const SigmaPlusProof<Exponent, GroupElement>& proof = proofs[t];
+
+        // Compute the challenge
+        std::vector<GroupElement> challenge_elements = {
+            proof.r1Proof_.A_,
+            proof.B_,
+            proof.r1Proof_.C_,
+            proof.r1Proof_.D_,
+        };
+        challenge_elements.insert(challenge_elements.end(), proof.Gk_.begin(), proof.Gk_.end());
+        SigmaPrimitives<Exponent, GroupElement>::generate_challenge(challenge_elements, challenges[t]);
+
+        // Generate random verifier weights
+        w1s[t].randomize();
+        w2s[t].randomize();
+        w3s[t].randomize();
+
+        // Reconstruct f-matrix
+        if (!compute_fs(proof, challenges[t], fs[t])) {
+            LogPrintf("Invalid matrix reconstruction");
+            return false;
+        }
+
+        if (setSizes[t] == 0 || setSizes[t] > commits.size()) {
+            LogPrintf("Invalid set size");
+            return false;
+        }
+    }
+
+    // The anonymity set sized part: every proof contributes f_i * w3 to the commitment scalars of
+    // its set. Split the commitment list into ranges, each task handles its range for all proofs
+    ProofThreadPool& threadPool = ProofThreadPool::GetInstance();
+    std::size_t rangeCount = std::max<std::size_t>(1, std::min(threadPool.GetNumberOfThreads(), commits.size() / minParallelRange));
+    std::size_t rangeSize = (commits.size() + rangeCount - 1) / rangeCount;
+
+    std::vector<Scalar> commit_scalars(commits.size(), Scalar(uint64_t(0))); // associated to commitment list
+    std::vector<std::vector<Exponent>> e_parts(rangeCount, std::vector<Exponent>(M, Exponent(uint64_t(0))));
+    std::vector<std::future<void>> parallelTasks;
+    parallelTasks.reserve(rangeCount);
+    for (std::size_t r = 0; r < rangeCount; r++) {
+        parallelTasks.emplace_back(threadPool.PostTask([&, r]() {
+            std::size_t lo = r * rangeSize;
+            std::size_t hi = std::min(commits.size(), lo + rangeSize);
+            for (std::size_t t = 0; t < M; t++) {
+                // Leaves [0, size - 1) of the proof's tree map to commitments starting at start
+                std::size_t size = setSizes[t];
+                std::size_t start = commits.size() - size;
+                std::size_t begin = std::max(lo, start) - start;
+                std::size_t end = std::min(hi, commits.size() - 1);
+                if (end <= start || begin >= end - start)
+                    continue;
+                compute_batch_fis_range(Exponent(uint64_t(1)), m, fs[t], w3s[t], e_parts[r][t], 0, begin, end - start, commit_scalars.begin() + start);
+            }
+        }));
+    }
+    for (auto& task : parallelTasks)
+        threadPool.WaitFor(task);
+
     // Final batch multiscalar multiplication
     Scalar g_scalar = Scalar(uint64_t(0)); // associated to g_
     Scalar h_scalar = Scalar(uint64_t(0)); // associated to h_
     std::vector<Scalar> h_scalars; // associated to (h_)
-    std::vector<Scalar> commit_scalars; // associated to commitment list
     h_scalars.reserve(n * m);
     h_scalars.resize(n * m);
     for (std::size_t i = 0; i < n * m; i++) {
         h_scalars[i] = Scalar(uint64_t(0));
     }
-    commit_scalars.reserve(commits.size());
-    commit_scalars.resize(commits.size());
-    for (std::size_t i = 0; i < commits.size(); i++) {
-        commit_scalars[i] = Scalar(uint64_t(0));
-    }
 
     // Set up the final batch elements
     std::vector<GroupElement> points;
@@ -118,41 +180,14 @@ bool SigmaPlusVerifier<Exponent, GroupElement>::batch_verify(
     points.reserve(final_size);
     scalars.reserve(final_size);
 
-    // Index decomposition, which is common among all proofs
-    std::vector<std::vector<std::size_t>> I_;
-    I_.reserve(N);
-    I_.resize(N);
-    for (std::size_t i = 0; i < commits.size(); i++) {
-        I_[i] = SigmaPrimitives<Exponent, GroupElement>::convert_to_nal(i, n, m);
-    }
-
     // Process all proofs
     for (std::size_t t = 0; t < M; t++) {
-        SigmaPlusProof<Exponent, GroupElement> proof = proofs[t];
-
-        // Compute the challenge
-        Exponent x;
-        std::vector<GroupElement> challenge_elements = {
-            proof.r1Proof_.A_,
-            proof.B_,
-            proof.r1Proof_.C_,
-            proof.r1Proof_.D_,
-        };
-        challenge_elements.insert(challenge_elements.end(), proof.Gk_.begin(), proof.Gk_.end());
-        SigmaPrimitives<Exponent, GroupElement>::generate_challenge(challenge_elements, x);
-
-        // Generate random verifier weights
-        Scalar w1, w2, w3;
-        w1.randomize();
-        w2.randomize();
-        w3.randomize();
-
-        // Reconstruct f-matrix
-        std::vector<Exponent> f_;
-        if (!compute_fs(proof, x, f_)) {
-            LogPrintf("Invalid matrix reconstruction");
-            return false;
-        }
+        const SigmaPlusProof<Exponent, GroupElement>& proof = proofs[t];
+        const Exponent& x = challenges[t];
+        const Scalar& w1 = w1s[t];
+        const Scalar& w2 = w2s[t];
+        const Scalar& w3 = w3s[t];
+        const std::vector<Exponent>& f_ = fs[t];
 
         // A, B, C, D (and associated commitments)
         points.emplace_back(proof.r1Proof_.A_);
@@ -174,24 +209,25 @@ bool SigmaPlusVerifier<Exponent, GroupElement>::batch_verify(
 
         Scalar f_i(uint64_t(1));
         Scalar e;
-        std::size_t size = setSizes[t];
-        std::size_t start = commits.size() - size;
+        for (std::size_t r = 0; r < rangeCount; r++)
+            e += e_parts[r][t];
 
-        std::vector<Scalar>::iterator ptr = commit_scalars.begin() + start;
-        compute_batch_fis(f_i, m, f_, w3, e, ptr, ptr, ptr + size - 1);
+        // Index decomposition of the last element of the set
+        std::size_t size = setSizes[t];
+        std::vector<std::size_t> I_ = SigmaPrimitives<Exponent, GroupElement>::convert_to_nal(size - 1, n, m);
 
         if(fPadding[t]) {
             Scalar pow(uint64_t(1));
             std::vector <Scalar> f_part_product;
             for (std::ptrdiff_t j = m - 1; j >= 0; j--) {
                 f_part_product.push_back(pow);
-                pow *= f_[j*n + I_[size - 1][j]];
+                pow *= f_[j*n + I_[j]];
             }
 
             NthPower<Exponent> xj(x);
             for (std::size_t j = 0; j < m; j++) {
                 Scalar fi_sum(uint64_t(0));
-                for (std::size_t i = I_[size - 1][j] + 1; i < n; i++)
+                for (std::size_t i = I_[j] + 1; i < n; i++)
                     fi_sum += f_[j*n + i];
                 pow += fi_sum * xj.pow * f_part_product[m - j - 1];
                 xj.go_next();
@@ -203,7 +239,7 @@ bool SigmaPlusVerifier<Exponent, GroupElement>::batch_verify(
             f_i = (uint64_t(1));
             for (std::size_t j = 0; j < m; ++j)
             {
-                f_i *= f_[j*n + I_[size - 1][j]];
+                f_i *= f_[j*n + I_[j]];
             }
 
             commit_scalars[commits.size() - 1] += f_i * w3;
@@ -240,13 +276,28 @@ bool SigmaPlusVerifier<Exponent, GroupElement>::batch_verify(
         LogPrintf("Unexpected final evaluation size");
         return false;
     }
-    secp_primitives::MultiExponent result(points, scalars);
-    if (result.get_multiple().isInfinity()) {
+    if (parallel_multiexp(points, scalars).isInfinity()) {
         return true;
     }
     return false;
 }
 
+// Split a large multiscalar multiplication into chunks evaluated on the proof thread pool
+template<class Exponent, class GroupElement>
+GroupElement SigmaPlusVerifier<Exponent, GroupElement>::parallel_multiexp(
+        const std::vector<GroupElement>& points,
+        const std::vector<Exponent>& scalars) const {
+    ProofThreadPool& threadPool = ProofThreadPool::GetInstance();
+    std::size_t chunks = std::min(threadPool.GetNumberOfThreads(), points.size() / minParallelRange);
+    secp_primitives::MultiExponent mult(points, scalars);
+    if (chunks <= 1)
+        return mult.get_multiple();
+
+    return mult.get_multiple_parallel(chunks, [&threadPool](const std::vector<std::function<void()>>& jobs) {
+        threadPool.RunAll(jobs);
+    });
+}
+
 template<class Exponent, class GroupElement>
 bool SigmaPlusVerifier<Exponent, GroupElement>::membership_checks(const SigmaPlusProof<Exponent, GroupElement>& proof) const {
     if(!(proof.r1Proof_.A_.isMember() &&
@@ -334,6 +385,42 @@ void SigmaPlusVerifier<Exponent, GroupElement>::compute_fis(const Exponent& f_i,
     }
 }
 
+// Same as compute_batch_fis, restricted to the leaves [begin, end) of the subtree whose first leaf is offset
+template<class Exponent, class GroupElement>
+void SigmaPlusVerifier<Exponent, GroupElement>::compute_batch_fis_range(
+        const Exponent& f_i,
+        int j,
+        const std::vector<Exponent>& f,
+        const Exponent& y,
+        Exponent& e,
+        std::size_t offset,
+        std::size_t begin,
+        std::size_t end,
+        typename std::vector<Exponent>::iterator leaves) const {
+    j--;
+    if (j == -1)
+    {
+        *(leaves + offset) += f_i * y;
+        e += f_i;
+        return;
+    }
+
+    std::size_t step = (std::size_t)pow(n, j);
+    Exponent t;
+
+    for (std::size_t i = 0; i < n; i++)
+    {
+        std::size_t child = offset + i * step;
+        if (child >= end)
+            break;
+        if (child + step <= begin)
+            continue;
+        t = f[j * n + i];
+        t *= f_i;
+        compute_batch_fis_range(t, j, f, y, e, child, begin, end, leaves);
+    }
+}
+
 template<class Exponent, class GroupElement>
 void SigmaPlusVerifier<Exponent, GroupElement>::compute_batch_fis(
         const Exponent& f_i,
@@ -161,6 +161,40 @@ BOOST_AUTO_TEST_CASE(one_out_of_n_padding)
     BOOST_CHECK(verifier.verify(commits, proofNew, true));
 }
 
+BOOST_AUTO_TEST_CASE(one_out_of_n_fixed_base_table)
+{
+    auto params = sigma::Params::get_default();
+    int N = 10000;
+    int n = params->get_n();
+    int m = params->get_m();
+    int index = 4321;
+
+    const secp_primitives::GroupElement& g = params->get_g();
+    const std::vector<secp_primitives::GroupElement>& h_gens = params->get_h();
+    secp_primitives::Scalar r;
+    r.randomize();
+    sigma::SigmaPlusProver<secp_primitives::Scalar,secp_primitives::GroupElement> prover(g, h_gens, n, m, &params->get_table());
+
+    std::vector<secp_primitives::GroupElement> commits;
+    for(int i = 0; i < N; ++i){
+        if(i == index){
+            secp_primitives::Scalar zero(uint64_t(0));
+            commits.push_back(sigma::SigmaPrimitives<secp_primitives::Scalar,secp_primitives::GroupElement>::commit(g, zero, h_gens[0], r));
+        }
+        else{
+            commits.push_back(secp_primitives::GroupElement());
+            commits[i].randomize();
+        }
+    }
+    sigma::SigmaPlusProof<secp_primitives::Scalar,secp_primitives::GroupElement> proof(n, m);
+
+    prover.proof(commits, index, r, true, proof);
+
+    sigma::SigmaPlusVerifier<secp_primitives::Scalar,secp_primitives::GroupElement> verifier(g, h_gens, n, m);
+
+    BOOST_CHECK(verifier.verify(commits, proof, true));
+}
+
 BOOST_AUTO_TEST_CASE(prove_and_verify_in_different_set)
 {
     auto params = sigma::Params::get_default();
@@ -42,6 +42,43 @@ BOOST_AUTO_TEST_CASE(group_element_serialize_infinity)
     BOOST_CHECK(initial == resulted);
 }
 
+BOOST_AUTO_TEST_CASE(group_element_serialize_batch)
+{
+    // computed points are in jacobian form, deserialized ones are affine
+    std::vector<secp_primitives::GroupElement> elements(8);
+    secp_primitives::Scalar s;
+    for (auto& e : elements) {
+        e.randomize();
+        s.randomize();
+        e *= s;
+    }
+    elements[3] = secp_primitives::GroupElement();
+    elements[5].deserialize(elements[4].getvch().data());
+
+    std::vector<unsigned char> expected;
+    for (const auto& e : elements) {
+        auto vch = e.getvch();
+        expected.insert(expected.end(), vch.begin(), vch.end());
+    }
+
+    std::vector<unsigned char> buffer(elements.size() * secp_primitives::GroupElement::serialize_size);
+    BOOST_CHECK(secp_primitives::GroupElement::serialize(elements, buffer.data()) == buffer.data() + buffer.size());
+    BOOST_CHECK(expected == buffer);
+
+    // normalized points keep their value
+    std::vector<secp_primitives::GroupElement> normalized(elements);
+    secp_primitives::GroupElement::normalize(normalized);
+    for (std::size_t i = 0; i < elements.size(); ++i) {
+        BOOST_CHECK(elements[i] == normalized[i]);
+        BOOST_CHECK_EQUAL(elements[i].hash(), normalized[i].hash());
+        BOOST_CHECK(elements[i].getvch() == normalized[i].getvch());
+    }
+
+    // arithmetic on affine points gives correct results
+    BOOST_CHECK(normalized[0] + normalized[1] == elements[0] + elements[1]);
+    BOOST_CHECK(normalized[0] * s == elements[0] * s);
+}
+
 BOOST_AUTO_TEST_CASE(scalar_serialize)
 {
     secp_primitives::Scalar initial;
@@ -6,6 +6,11 @@
 #include <crypto/progpow/lib/ethash/ethash-internal.hpp>
 #include <crypto/progpow/include/ethash/progpow.hpp>
 #include <crypto/progpow/helpers.hpp>
+#include <crypto/progpow.h>
+
+#include <boost/filesystem.hpp>
+
+#include <cstring>
 
 BOOST_FIXTURE_TEST_SUITE(firpow_tests, BasicTestingSetup)
 BOOST_AUTO_TEST_CASE(firopow_hash_and_verify) {
@@ -39,4 +44,34 @@ BOOST_AUTO_TEST_CASE(firopow_hash_and_verify) {
     }
 }
 
+BOOST_AUTO_TEST_CASE(firopow_persisted_epoch_context) {
+
+    boost::filesystem::path dir = boost::filesystem::temp_directory_path() / boost::filesystem::unique_path();
+    boost::filesystem::create_directories(dir);
+
+    progpow_set_cache_dir(dir.string());
+    ProgPowEpochContextPtr built = progpow_get_epoch_context(5);
+    BOOST_CHECK(boost::filesystem::exists(dir / "lightcache-5.dat"));
+
+    // Push epoch 5 out of memory without touching its file
+    progpow_set_cache_dir("");
+    for (int epoch = 6; epoch <= 8; epoch++)
+        BOOST_CHECK_EQUAL(progpow_get_epoch_context(epoch)->epoch_number, epoch);
+
+    progpow_set_cache_dir(dir.string());
+    ProgPowEpochContextPtr loaded = progpow_get_epoch_context(5);
+    BOOST_CHECK(loaded != built);
+    BOOST_CHECK_EQUAL(loaded->light_cache_num_items, built->light_cache_num_items);
+    BOOST_CHECK_EQUAL(loaded->full_dataset_num_items, built->full_dataset_num_items);
+    BOOST_CHECK(memcmp(loaded->light_cache, built->light_cache, built->light_cache_num_items * sizeof(ethash::hash512)) == 0);
+
+    const ethash::hash256 header{to_hash256(firopow_hash_test_cases[0].header_hash_hex)};
+    const int height = 5 * ETHASH_EPOCH_LENGTH + 1;
+    BOOST_CHECK(ethash::is_equal(progpow::hash(*loaded, height, header, 42).final_hash,
+                                 progpow::hash(*built, height, header, 42).final_hash));
+
+    progpow_set_cache_dir("");
+    boost::filesystem::remove_all(dir);
+}
+
 BOOST_AUTO_TEST_SUITE_END()
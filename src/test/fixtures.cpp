@@ -306,6 +306,28 @@ CPubKey LelantusTestingSetup::GenerateAddress() {
     return pwalletMain->GenerateNewKey();
 }
 
+CMutableTransaction LelantusTestingSetup::BreakRangeProof(CTransaction const &tx) {
+    CMutableTransaction broken(tx);
+    bool fPayload = broken.vin[0].scriptSig[0] == OP_LELANTUSJOINSPLITPAYLOAD;
+    std::vector<unsigned char> serialized = fPayload ? broken.vExtraPayload
+        : std::vector<unsigned char>(broken.vin[0].scriptSig.begin() + 1, broken.vin[0].scriptSig.end());
+    CDataStream ss(serialized, SER_NETWORK, PROTOCOL_VERSION);
+    lelantus::LelantusProof proof;
+    ss >> proof;
+    proof.bulletproofs.u.randomize();
+    CDataStream tampered(SER_NETWORK, PROTOCOL_VERSION);
+    tampered << proof;
+    tampered.write(&*ss.begin(), ss.size());
+    if (fPayload) {
+        broken.vExtraPayload.assign(tampered.begin(), tampered.end());
+    } else {
+        broken.vin[0].scriptSig = CScript() << OP_LELANTUSJOINSPLIT;
+        broken.vin[0].scriptSig.insert(broken.vin[0].scriptSig.end(), tampered.begin(), tampered.end());
+    }
+
+    return broken;
+}
+
 LelantusTestingSetup::~LelantusTestingSetup() {
     lelantus::CLelantusState::GetState()->Reset();
 }
@@ -92,6 +92,9 @@ public:
 
     CPubKey GenerateAddress();
 
+    // Copy of a JoinSplit with an invalid range proof, it passes every check skipping the proof verification
+    CMutableTransaction BreakRangeProof(CTransaction const &tx);
+
     ~LelantusTestingSetup();
 
 public:
@@ -1,5 +1,6 @@
 #include "../lelantus.h"
 #include "../validation.h"
+#include "../streams.h"
 
 #include "fixtures.h"
 #include "test_bitcoin.h"
@@ -501,6 +502,41 @@ BOOST_AUTO_TEST_CASE(get_coin_group)
     lelantusState->RemoveBlock(indexes[5]);
     verifyGroup(2, 6, indexes[2], indexes[4]);
     verifyGroup(1, 6, indexes[0], indexes[2], 1);
+    BOOST_CHECK(lelantusState->GetCachedAnonymitySet(3) == nullptr);
+
+    // cached set of the second group is rolled back with the block
+    lelantusState->RemoveBlock(indexes[4]);
+    verifyGroup(2, 4, indexes[2], indexes[3]);
+
+    uint256 blockHashOut7;
+    std::vector<PublicCoin> coinOut7;
+    BOOST_CHECK_EQUAL(4, lelantusState->GetCoinSetForSpend(
+        &chainActive,
+        indexes[5]->nHeight,
+        2,
+        blockHashOut7,
+        coinOut7,
+        setHash));
+
+    verifyMints(4, 8, coinOut7);
+    BOOST_CHECK(indexes[3]->GetBlockHash() == blockHashOut7);
+
+    // and extended again when the block is connected back
+    indexes[4]->lelantusMintedPubCoins.clear();
+    addMintsToState(indexes[4], blocks[4]);
+
+    uint256 blockHashOut8;
+    std::vector<PublicCoin> coinOut8;
+    BOOST_CHECK_EQUAL(6, lelantusState->GetCoinSetForSpend(
+        &chainActive,
+        indexes[5]->nHeight,
+        2,
+        blockHashOut8,
+        coinOut8,
+        setHash));
+
+    verifyMints(4, 10, coinOut8);
+    BOOST_CHECK(indexes[4]->GetBlockHash() == blockHashOut8);
 
     lelantusState->Reset();
 }
@@ -589,6 +625,59 @@ BOOST_AUTO_TEST_CASE(surge_condition_detected_and_no_serials_in_early_groups)
     Undetected;
 }
 
+BOOST_AUTO_TEST_CASE(snapshot)
+{
+    size_t maxGroupSize = 6;
+    size_t startGroupSize = 2;
+    CLelantusState state(maxGroupSize, startGroupSize);
+    state.Reset();
+
+    // 6(1), 2 + 4(2), 2 + 4(3)
+    GenerateMintsInBlocks(state, {2, 2, 2, 2, 2, 2, 2});
+    GenerateSpendGroups(state, {{1, 6}, {2, 4}});
+    GenerateSpendGroups(state, {{1, 1}});
+    Detected;
+
+    CAutoFile file(tmpfile(), SER_DISK, CLIENT_VERSION);
+    state.WriteSnapshot(file);
+    rewind(file.Get());
+
+    CLelantusState restored(maxGroupSize, startGroupSize);
+    BOOST_CHECK(restored.ReadSnapshot(file, &chainActive));
+
+    BOOST_CHECK_EQUAL(state.GetLatestCoinID(), restored.GetLatestCoinID());
+    BOOST_CHECK_EQUAL(state.IsSurgeConditionDetected(), restored.IsSurgeConditionDetected());
+    BOOST_CHECK(state.GetSpends() == restored.GetSpends());
+
+    BOOST_CHECK_EQUAL(state.GetMints().size(), restored.GetMints().size());
+    for (auto const &mint : state.GetMints()) {
+        BOOST_CHECK_EQUAL(state.GetMintedCoinHeightAndId(mint.first), restored.GetMintedCoinHeightAndId(mint.first));
+    }
+
+    BOOST_CHECK_EQUAL(state.GetCoinGroups().size(), restored.GetCoinGroups().size());
+    for (auto const &group : state.GetCoinGroups()) {
+        CLelantusState::LelantusCoinGroupInfo restoredGroup;
+        BOOST_CHECK(restored.GetCoinGroupInfo(group.first, restoredGroup));
+        BOOST_CHECK_EQUAL(group.second.firstBlock, restoredGroup.firstBlock);
+        BOOST_CHECK_EQUAL(group.second.lastBlock, restoredGroup.lastBlock);
+        BOOST_CHECK_EQUAL(group.second.nCoins, restoredGroup.nCoins);
+
+        uint256 blockHash, restoredBlockHash;
+        std::vector<PublicCoin> coins, restoredCoins;
+        std::vector<unsigned char> setHash, restoredSetHash;
+        BOOST_CHECK_EQUAL(
+            state.GetCoinSetForSpend(&chainActive, chainActive.Height(), group.first, blockHash, coins, setHash),
+            restored.GetCoinSetForSpend(&chainActive, chainActive.Height(), group.first, restoredBlockHash, restoredCoins, restoredSetHash));
+        BOOST_CHECK(blockHash == restoredBlockHash);
+        BOOST_CHECK(coins == restoredCoins);
+    }
+
+    // mints added after the snapshot was written are detected
+    GenerateMintsInBlocks(state, {2});
+    rewind(file.Get());
+    BOOST_CHECK(!restored.ReadSnapshot(file, &chainActive));
+}
+
 #undef Detected
 #undef Undetected
 
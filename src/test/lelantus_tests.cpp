@@ -1,16 +1,27 @@
+#include "../batchproof_container.h"
 #include "../chainparams.h"
+#include "../core_memusage.h"
 #include "../lelantus.h"
 #include "../script/standard.h"
 #include "../validation.h"
 #include "../wallet/coincontrol.h"
 #include "../wallet/wallet.h"
 #include "../net.h"
+#include "../net_processing.h"
 
 #include "test_bitcoin.h"
 #include "fixtures.h"
 #include <iostream>
 #include <boost/test/unit_test.hpp>
 
+// Tests these internal-to-net_processing.cpp methods:
+extern void AddJoinSplitToBatch(const CTransactionRef& ptx, NodeId peer, int64_t nBatchWindow);
+extern void ProcessJoinSplitBatch(CConnman& connman);
+
+// Tests the anonymity set cache of rpc/misc.cpp:
+extern bool GetLelantusAnonymitySet(int coinGroupId, const uint256& startBlockHash, uint256& blockHash,
+                                    std::vector<unsigned char>& setHash, bool& fDelta, std::string& coins);
+
 static bool CommitToMempool(const CTransaction &tx)
 {
     CWallet *wallet = pwalletMain;
@@ -286,7 +297,8 @@ BOOST_AUTO_TEST_CASE(get_outpoint)
     BOOST_CHECK(ReadBlockFromDisk(block, blockIdx, ::Params().GetConsensus()));
 
     block.lelantusTxInfo = std::make_shared<lelantus::CLelantusTxInfo>();
-    block.lelantusTxInfo->mints.emplace_back(std::make_pair(mint.GetPubcoinValue(), std::make_pair(mint.GetAmount(), uint256())));
+    uint256 mintTag = GetRandHash();
+    block.lelantusTxInfo->mints.emplace_back(std::make_pair(mint.GetPubcoinValue(), std::make_pair(mint.GetAmount(), mintTag)));
 
     lelantusState->AddMintsToStateAndBlockIndex(blockIdx, &block);
     lelantusState->AddBlock(blockIdx);
@@ -322,6 +334,24 @@ BOOST_AUTO_TEST_CASE(get_outpoint)
     BOOST_CHECK(expectedOut == out);
 
     BOOST_CHECK(!GetOutPoint(out, nonCommitted.GetPubCoinHash()));
+
+    // by mint tag
+    out = COutPoint();
+    BOOST_CHECK(GetOutPointFromMintTag(out, mintTag));
+    BOOST_CHECK(expectedOut == out);
+
+    BOOST_CHECK(!GetOutPointFromMintTag(out, GetRandHash()));
+
+    // batch by mint tags
+    std::map<uint256, COutPoint> outPoints;
+    uint256 unknownTag = GetRandHash();
+    BOOST_CHECK(GetOutPointsFromMintTags(outPoints, {unknownTag, mintTag}));
+    BOOST_CHECK_EQUAL(1, outPoints.size());
+    BOOST_CHECK(expectedOut == outPoints[mintTag]);
+
+    outPoints.clear();
+    BOOST_CHECK(!GetOutPointsFromMintTags(outPoints, {unknownTag}));
+    BOOST_CHECK(outPoints.empty());
 }
 
 BOOST_AUTO_TEST_CASE(build_lelantus_state)
@@ -590,6 +620,21 @@ BOOST_AUTO_TEST_CASE(checktransaction)
     CMutableTransaction joinsplitTx(wtx);
     auto joinsplit = ParseLelantusJoinSplit(joinsplitTx);
 
+    // the parsed joinsplit is kept with the transaction, copies parse it again
+    CTransaction parsedTx(joinsplitTx);
+    BOOST_CHECK(!parsedTx.GetParsedJoinSplit());
+    size_t usage = RecursiveDynamicUsage(parsedTx);
+    auto cachedJoinsplit = ParseLelantusJoinSplit(parsedTx);
+    BOOST_CHECK(cachedJoinsplit == parsedTx.GetParsedJoinSplit());
+    BOOST_CHECK(cachedJoinsplit == ParseLelantusJoinSplit(parsedTx));
+    // the kept proof counts towards the memory usage of the transaction, once
+    size_t parsedUsage = RecursiveDynamicUsage(parsedTx);
+    BOOST_CHECK_GT(parsedUsage, usage + parsedTx.vin[0].scriptSig.size());
+    BOOST_CHECK(parsedTx.SetParsedJoinSplit(joinsplit, parsedTx.vin[0].scriptSig.size()) == cachedJoinsplit);
+    BOOST_CHECK_EQUAL(parsedUsage, RecursiveDynamicUsage(parsedTx));
+    BOOST_CHECK(cachedJoinsplit->getCoinSerialNumbers() == joinsplit->getCoinSerialNumbers());
+    BOOST_CHECK(!CTransaction(parsedTx).GetParsedJoinSplit());
+
     // test get join split amounts
     BOOST_CHECK_EQUAL(1, GetSpendInputs(joinsplitTx));
     BOOST_CHECK_EQUAL(1, GetSpendInputs(joinsplitTx, joinsplitTx.vin[0]));
@@ -626,6 +671,144 @@ BOOST_AUTO_TEST_CASE(checktransaction)
         joinsplitTx, state, joinsplitTx.GetHash(), false, chainActive.Height(), false, true, NULL, &info));
 }
 
+BOOST_AUTO_TEST_CASE(batch_verify_joinsplits)
+{
+    GenerateBlocks(400);
+
+    std::vector<CMutableTransaction> txs;
+    GenerateMints({10 * CENT, 11 * CENT, 12 * CENT}, txs);
+    GenerateBlock(txs);
+    GenerateBlocks(10);
+
+    std::vector<CTransactionRef> joinsplits;
+    for (int i = 0; i < 2; i++) {
+        CWalletTx wtx;
+        pwalletMain->JoinSplitLelantus({{script, 5 * CENT, false}}, {}, wtx);
+        joinsplits.push_back(wtx.tx);
+    }
+
+    // transaction failing the other checks is left out of the batch
+    CMutableTransaction invalidTx(*joinsplits[0]);
+    invalidTx.vout[0].nValue += CENT;
+    joinsplits.push_back(MakeTransactionRef(invalidTx));
+
+    LOCK(cs_main);
+    BOOST_CHECK(BatchVerifyJoinSplits(joinsplits));
+
+    CValidationState state;
+    for (size_t i = 0; i < 2; i++) {
+        CLelantusTxInfo info;
+        BOOST_CHECK(CheckLelantusTransaction(
+            *joinsplits[i], state, joinsplits[i]->GetHash(), false, INT_MAX, false, true, NULL, &info));
+    }
+
+    CLelantusTxInfo info;
+    BOOST_CHECK(!CheckLelantusTransaction(
+        *joinsplits[2], state, joinsplits[2]->GetHash(), false, INT_MAX, false, true, NULL, &info));
+
+    ClearBatchVerifiedJoinSplits();
+}
+
+BOOST_AUTO_TEST_CASE(joinsplit_batch_fallback)
+{
+    GenerateBlocks(400);
+
+    std::vector<CMutableTransaction> txs;
+    GenerateMints({10 * CENT, 11 * CENT}, txs);
+    GenerateBlock(txs);
+    GenerateBlocks(10);
+
+    std::vector<CTransactionRef> joinsplits;
+    for (int i = 0; i < 2; i++) {
+        CWalletTx wtx;
+        pwalletMain->JoinSplitLelantus({{script, 5 * CENT, false}}, {}, wtx);
+        joinsplits.push_back(wtx.tx);
+    }
+
+    // range proofs are checked only in the batch, a broken one fails it while the rest of the checks pass
+    CTransactionRef brokenProof = MakeTransactionRef(BreakRangeProof(*joinsplits[1]));
+
+    // and a transaction earning its sender a DoS score
+    CMutableTransaction oversizedTx(*joinsplits[1]);
+    oversizedTx.vout[0].nValue = consensus.nMaxValueLelantusSpendPerTransaction + 1;
+    CTransactionRef oversized = MakeTransactionRef(oversizedTx);
+
+    CAddress addr1(CService(CNetAddr(), 1), NODE_NONE), addr2(CService(CNetAddr(), 2), NODE_NONE);
+    CNode honestNode(1000, NODE_NETWORK, 0, INVALID_SOCKET, addr1, 0, 0, "", true);
+    CNode dishonestNode(1001, NODE_NETWORK, 0, INVALID_SOCKET, addr2, 1, 1, "", true);
+    honestNode.SetSendVersion(PROTOCOL_VERSION);
+    dishonestNode.SetSendVersion(PROTOCOL_VERSION);
+    GetNodeSignals().InitializeNode(&honestNode, *connman);
+    GetNodeSignals().InitializeNode(&dishonestNode, *connman);
+
+    {
+        LOCK(cs_main);
+        BOOST_CHECK(!BatchVerifyJoinSplits({joinsplits[0], brokenProof}));
+
+        AddJoinSplitToBatch(joinsplits[0], honestNode.GetId(), 0);
+        AddJoinSplitToBatch(brokenProof, dishonestNode.GetId(), 0);
+        AddJoinSplitToBatch(oversized, dishonestNode.GetId(), 0);
+        ProcessJoinSplitBatch(*connman);
+
+        // the batch failed, every transaction has been verified on its own
+        BOOST_CHECK(mempool.exists(joinsplits[0]->GetHash()));
+        BOOST_CHECK(!mempool.exists(brokenProof->GetHash()));
+        BOOST_CHECK(!mempool.exists(oversized->GetHash()));
+    }
+
+    CNodeStateStats stats;
+    BOOST_CHECK(GetNodeStateStats(honestNode.GetId(), stats));
+    BOOST_CHECK_EQUAL(stats.nMisbehavior, 0);
+    BOOST_CHECK(GetNodeStateStats(dishonestNode.GetId(), stats));
+    BOOST_CHECK(stats.nMisbehavior > 0);
+
+    bool fUpdateConnectionTime = false;
+    GetNodeSignals().FinalizeNode(honestNode.GetId(), fUpdateConnectionTime);
+    GetNodeSignals().FinalizeNode(dishonestNode.GetId(), fUpdateConnectionTime);
+    mempool.clear();
+}
+
+BOOST_AUTO_TEST_CASE(deferred_proof_failure)
+{
+    GenerateBlocks(400);
+
+    std::vector<CMutableTransaction> txs;
+    GenerateMints({10 * CENT}, txs);
+    GenerateBlock(txs);
+    GenerateBlocks(10);
+
+    CWalletTx wtx;
+    pwalletMain->JoinSplitLelantus({{script, 5 * CENT, false}}, {}, wtx);
+    mempool.clear();
+
+    // a block at the tip has its proofs verified on the proof threads, the broken range proof only fails there
+    BOOST_CHECK(GetBoolArg("-parallelproofs", DEFAULT_PARALLEL_PROOFS));
+    CBlockIndex *tip = chainActive.Tip();
+    CBlock block = CreateAndProcessBlock({BreakRangeProof(*wtx.tx)}, script);
+    BOOST_CHECK(chainActive.Tip() == tip);
+    {
+        LOCK(cs_main);
+        BOOST_CHECK(mapBlockIndex.count(block.GetHash()));
+        BOOST_CHECK(mapBlockIndex[block.GetHash()]->nStatus & BLOCK_FAILED_VALID);
+        for (auto const &serial : ParseLelantusJoinSplit(*wtx.tx)->getCoinSerialNumbers())
+            BOOST_CHECK(!lelantusState->IsUsedCoinSerial(serial));
+    }
+
+    // nothing is left over for the next block
+    BOOST_CHECK(GenerateBlock({CMutableTransaction(*wtx.tx)}));
+    BOOST_CHECK(chainActive.Tip()->pprev == tip);
+
+    // a block failing before its deferred proofs are waited for doesn't leave the deferral armed
+    CMutableTransaction missingInputs;
+    missingInputs.vin.resize(1);
+    missingInputs.vin[0].prevout = COutPoint(GetRandHash(), 0);
+    missingInputs.vout.push_back(CTxOut(CENT, script));
+    tip = chainActive.Tip();
+    CreateAndProcessBlock({missingInputs}, script);
+    BOOST_CHECK(chainActive.Tip() == tip);
+    BOOST_CHECK(!BatchProofContainer::get_instance()->fDeferProofs);
+}
+
 BOOST_AUTO_TEST_CASE(move_to_v3_payload)
 {
     int prevHeight;
@@ -958,6 +1141,76 @@ BOOST_AUTO_TEST_CASE(coingroup)
     lelantusState->Reset();
 }
 
+BOOST_AUTO_TEST_CASE(anonymity_set_cache_reorg)
+{
+    GenerateBlocks(400);
+
+    // the cached set served to light wallets should always match the set used for spends
+    auto checkSet = [&]() {
+        uint256 blockHash;
+        std::vector<unsigned char> setHash;
+        bool fDelta;
+        std::string coins;
+        BOOST_CHECK(GetLelantusAnonymitySet(1, uint256(), blockHash, setHash, fDelta, coins));
+        BOOST_CHECK(!fDelta);
+
+        uint256 expectedBlockHash;
+        std::vector<lelantus::PublicCoin> expectedCoins;
+        std::vector<unsigned char> expectedSetHash;
+        {
+            LOCK(cs_main);
+            lelantusState->GetCoinSetForSpend(
+                &chainActive, chainActive.Height() - (ZC_MINT_CONFIRMATIONS - 1), 1,
+                expectedBlockHash, expectedCoins, expectedSetHash);
+        }
+
+        std::string expected;
+        for (auto const &coin : expectedCoins) {
+            std::vector<unsigned char> buffer(GroupElement::serialize_size);
+            coin.getValue().serialize(buffer.data());
+            expected.append(buffer.begin(), buffer.end());
+        }
+
+        BOOST_CHECK(expectedBlockHash == blockHash);
+        BOOST_CHECK(expectedSetHash == setHash);
+        BOOST_CHECK_EQUAL(expectedCoins.size() * GroupElement::serialize_size, coins.size());
+        BOOST_CHECK(expected == coins);
+    };
+
+    std::vector<CMutableTransaction> txs;
+    GenerateMints({1 * CENT, 2 * CENT}, txs);
+    BOOST_CHECK(GenerateBlock({txs[0]}));
+    BOOST_CHECK(GenerateBlock({txs[1]}));
+    checkSet();
+
+    // extend the cache
+    txs.clear();
+    GenerateMints({3 * CENT}, txs);
+    auto disconnected = GenerateBlock({txs[0]});
+    BOOST_CHECK(disconnected);
+    checkSet();
+
+    // replace the last block, the cache has to drop its coins
+    auto disconnectedHash = disconnected->GetBlockHash();
+    BOOST_CHECK(DisconnectBlocks(1));
+    mempool.clear();
+
+    txs.clear();
+    GenerateMints({4 * CENT, 5 * CENT}, txs);
+    BOOST_CHECK(GenerateBlock({txs[0], txs[1]}));
+    checkSet();
+
+    // a delta against the disconnected block falls back to the full set
+    uint256 blockHash;
+    std::vector<unsigned char> setHash;
+    bool fDelta;
+    std::string coins;
+    BOOST_CHECK(GetLelantusAnonymitySet(1, disconnectedHash, blockHash, setHash, fDelta, coins));
+    BOOST_CHECK(!fDelta);
+
+    mempool.clear();
+}
+
 BOOST_AUTO_TEST_SUITE_END()
 
 };
@@ -18,6 +18,7 @@
 #include "utilstrencodings.h"
 
 #include "test/test_bitcoin.h"
+#include "test/fixtures.h"
 
 #include <memory>
 
@@ -181,6 +182,33 @@ void TestPackageSelection(const CChainParams& chainparams, CScript scriptPubKey,
     pblocktemplate = BlockAssembler(chainparams).CreateNewBlock(scriptPubKey);
     BOOST_CHECK(pblocktemplate->block.vtx[8]->GetHash() == hashLowFeeTx2);
 }
+
+BOOST_FIXTURE_TEST_CASE(CreateNewBlock_resume, LelantusTestingSetup)
+{
+    GenerateBlocks(110);
+
+    std::vector<CMutableTransaction> txs;
+    GenerateMints({1 * CENT, 2 * CENT}, txs);
+    BOOST_CHECK(mempool.size() > 0);
+
+    // The second template on the same tip resumes the selection of the first one,
+    // including the transactions picked for -blockprioritysize
+    std::unique_ptr<CBlockTemplate> pblocktemplate1 = BlockAssembler(Params()).CreateNewBlock(script);
+    std::unique_ptr<CBlockTemplate> pblocktemplate2 = BlockAssembler(Params()).CreateNewBlock(script);
+    BOOST_CHECK_EQUAL(pblocktemplate1->block.vtx.size(), mempool.size() + 1);
+    BOOST_CHECK_EQUAL(pblocktemplate2->block.vtx.size(), mempool.size() + 1);
+    for (size_t i = 1; i < pblocktemplate1->block.vtx.size(); i++)
+        BOOST_CHECK(pblocktemplate1->block.vtx[i]->GetHash() == pblocktemplate2->block.vtx[i]->GetHash());
+
+    // New arrivals are added to the resumed selection
+    GenerateMints({3 * CENT}, txs);
+    std::unique_ptr<CBlockTemplate> pblocktemplate3 = BlockAssembler(Params()).CreateNewBlock(script);
+    BOOST_CHECK(pblocktemplate3->block.vtx.size() > pblocktemplate1->block.vtx.size());
+    BOOST_CHECK_EQUAL(pblocktemplate3->block.vtx.size(), mempool.size() + 1);
+
+    mempool.clear();
+}
+
 /*
 // NOTE: These tests rely on CreateNewBlock doing its own self-validation!
 BOOST_AUTO_TEST_CASE(CreateNewBlock_validity)
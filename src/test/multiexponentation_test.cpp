@@ -1,4 +1,5 @@
 #include "../secp256k1/include/MultiExponent.h"
+#include "../secp256k1/include/FixedBaseTable.h"
 
 #include <boost/filesystem.hpp>
 #include <boost/test/unit_test.hpp>
@@ -30,3 +31,75 @@ BOOST_AUTO_TEST_CASE(multiexponentation_test)
     }
 }
 
+
+BOOST_AUTO_TEST_CASE(multiexponentation_parallel_test)
+{
+    // run every job on its own thread
+    secp_primitives::MultiExponent::TaskRunner runner = [](const std::vector<std::function<void()>>& jobs) {
+        boost::thread_group threads;
+        for (const auto& job : jobs)
+            threads.create_thread(job);
+        threads.join_all();
+    };
+
+    std::vector<int> sizes = {1, 3, 57, 1260, 7880};
+    std::vector<std::size_t> chunks = {1, 2, 3, 8};
+
+    for (int size : sizes) {
+        std::vector<secp_primitives::GroupElement> gens;
+        std::vector<secp_primitives::Scalar> scalars;
+
+        secp_primitives::GroupElement r;
+        gens.resize(size);
+        scalars.resize(size);
+        for (int i = 0; i < size; ++i) {
+            gens[i].randomize();
+            scalars[i].randomize();
+
+            r += gens[i] * scalars[i];
+        }
+
+        secp_primitives::MultiExponent multiexponent(gens, scalars);
+        for (std::size_t n : chunks)
+            BOOST_CHECK_EQUAL(r, multiexponent.get_multiple_parallel(n, runner));
+
+        // partial sums add up to the whole
+        secp_primitives::GroupElement head = multiexponent.get_multiple(0, size / 2);
+        secp_primitives::GroupElement tail = multiexponent.get_multiple(size / 2, size);
+        BOOST_CHECK_EQUAL(r, head + tail);
+
+        // the scratch space reused from the previous calls gives the same result
+        BOOST_CHECK_EQUAL(r, multiexponent.get_multiple());
+    }
+}
+
+BOOST_AUTO_TEST_CASE(fixed_base_table_test)
+{
+    std::vector<secp_primitives::GroupElement> gens(5);
+    for (auto& g : gens)
+        g.randomize();
+
+    secp_primitives::FixedBaseTable table(gens);
+    BOOST_CHECK_EQUAL(table.size(), gens.size());
+
+    secp_primitives::Scalar zero(uint64_t(0)), one(uint64_t(1)), minus_one = one.negate();
+    std::vector<secp_primitives::Scalar> scalars = {zero, one, minus_one, secp_primitives::Scalar(uint64_t(0xf0f0f0f0f0f0f0f0))};
+    for (int i = 0; i < 16; ++i) {
+        scalars.emplace_back();
+        scalars.back().randomize();
+    }
+
+    for (std::size_t i = 0; i < gens.size(); ++i) {
+        BOOST_CHECK_EQUAL(table.get_generator(i), gens[i]);
+        for (const auto& s : scalars)
+            BOOST_CHECK_EQUAL(table.multiply(i, s), gens[i] * s);
+    }
+    BOOST_CHECK(table.multiply(0, zero).isInfinity());
+
+    std::vector<secp_primitives::Scalar> exps(scalars.end() - 3, scalars.end());
+    secp_primitives::GroupElement expected = gens[2] * exps[0] + gens[3] * exps[1] + gens[4] * exps[2];
+    BOOST_CHECK_EQUAL(table.multi_multiply(2, exps), expected);
+
+    BOOST_CHECK_THROW(table.multiply(gens.size(), one), std::out_of_range);
+    BOOST_CHECK_THROW(table.multi_multiply(3, exps), std::out_of_range);
+}
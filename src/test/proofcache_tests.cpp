@@ -0,0 +1,95 @@
+// Copyright (c) 2021 The Firo Core Developers
+// Distributed under the MIT software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#include "proofcache.h"
+
+#include "lelantus.h"
+#include "script/standard.h"
+#include "validation.h"
+#include "wallet/wallet.h"
+
+#include "test/fixtures.h"
+#include "test/test_bitcoin.h"
+
+#include <boost/test/unit_test.hpp>
+
+BOOST_FIXTURE_TEST_SUITE(proofcache_tests, BasicTestingSetup)
+
+BOOST_AUTO_TEST_CASE(proofcache_keys)
+{
+    uint256 txHash = GetRandHash();
+    auto getKey = [&txHash](uint64_t nCoins) {
+        CHashWriter writer = GetProofCacheKeyWriter(txHash);
+        writer << (uint32_t)1 << uint256S("01") << nCoins;
+        return writer.GetHash();
+    };
+
+    // Same transaction and sets, same key
+    uint256 key = getKey(100);
+    BOOST_CHECK(getKey(100) == key);
+
+    // The key is salted
+    BOOST_CHECK(key != (CHashWriter(SER_GETHASH, 0) << txHash << (uint32_t)1 << uint256S("01") << (uint64_t)100).GetHash());
+
+    // A set with one more coin is another set
+    uint256 otherKey = getKey(101);
+    BOOST_CHECK(otherKey != key);
+
+    BOOST_CHECK(!IsProofVerified(key));
+    SetProofVerified(key);
+    BOOST_CHECK(IsProofVerified(key));
+    BOOST_CHECK(IsProofVerified(key));
+    BOOST_CHECK(!IsProofVerified(otherKey));
+}
+
+BOOST_FIXTURE_TEST_CASE(proofcache_joinsplit, LelantusTestingSetup)
+{
+    GenerateBlocks(400);
+
+    std::vector<CMutableTransaction> txs;
+    GenerateMints({10 * CENT}, txs);
+    GenerateBlock(txs);
+    GenerateBlocks(10);
+
+    // key of the proofs of a transaction checked against the sets it refers to, with extra coins in each set
+    auto getKey = [](CTransaction const &tx, uint64_t nExtraCoins) {
+        LOCK(cs_main);
+        std::map<uint32_t, std::pair<uint256, uint64_t>> sets;
+        std::vector<std::vector<unsigned char>> setHashes;
+        for (auto const &idAndHash : lelantus::ParseLelantusJoinSplit(tx)->getIdAndBlockHashes()) {
+            CBlockIndex *index = mapBlockIndex[idAndHash.second];
+            uint256 blockHash;
+            std::vector<lelantus::PublicCoin> coins;
+            std::vector<unsigned char> setHash;
+            lelantus::CLelantusState::GetState()->GetCoinSetForSpend(
+                &chainActive, index->nHeight, idAndHash.first, blockHash, coins, setHash);
+            sets[idAndHash.first] = std::make_pair(idAndHash.second, coins.size() + nExtraCoins);
+            std::vector<unsigned char> anonymitySetHash = lelantus::GetAnonymitySetHash(index, idAndHash.first);
+            if (!anonymitySetHash.empty())
+                setHashes.push_back(anonymitySetHash);
+        }
+        return lelantus::GetJoinSplitProofKey(tx.GetHash(), sets, setHashes, true);
+    };
+
+    // The proofs are verified when the transaction is accepted to the mempool
+    CWalletTx wtx;
+    pwalletMain->JoinSplitLelantus({{script, 5 * CENT, false}}, {}, wtx);
+    BOOST_CHECK(mempool.exists(wtx.GetHash()));
+    BOOST_CHECK(IsProofVerified(getKey(*wtx.tx, 0)));
+    mempool.clear();
+
+    // A broken proof passes for the block only where the cache says it was verified against the very same sets
+    CTransaction brokenTx(BreakRangeProof(*wtx.tx));
+    SetProofVerified(getKey(brokenTx, 1));
+    CBlockIndex *tip = chainActive.Tip();
+    CreateAndProcessBlock({CMutableTransaction(brokenTx)}, GetScriptForDestination(GenerateAddress().GetID()));
+    BOOST_CHECK(chainActive.Tip() == tip);
+
+    SetProofVerified(getKey(brokenTx, 0));
+    CreateAndProcessBlock({CMutableTransaction(brokenTx)}, script);
+    BOOST_CHECK(chainActive.Tip()->pprev == tip);
+    BOOST_CHECK(chainActive.Tip()->lelantusSpentSerials.size() == 1);
+}
+
+BOOST_AUTO_TEST_SUITE_END()
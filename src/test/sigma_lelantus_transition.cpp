@@ -88,6 +88,32 @@ BOOST_AUTO_TEST_CASE(sigma_lelantus_transition_test)
     coins = pwalletMain->GetAvailableCoins(nullptr, false);
     BOOST_CHECK_MESSAGE(coins.size() == denominations.size() * 2 - 2, "Spent sigma coins are not set as used");
 
+    // converted sets are the sigma sets offset by the denomination, built once per group
+    {
+        LOCK(cs_main);
+        sigma::CSigmaState *sigmaState = sigma::CSigmaState::GetState();
+        auto lelantusParams = lelantus::Params::get_default();
+        for (auto denomination : denominations) {
+            sigma::CoinDenomination denom;
+            BOOST_CHECK(StringToDenomination(denomination, denom));
+            int64_t intDenom;
+            BOOST_CHECK(DenominationToInteger(denom, intDenom));
+            int groupId = sigmaState->GetLatestCoinID(denom);
+
+            std::vector<GroupElement> sigmaSet;
+            sigmaState->GetAnonymitySet(denom, groupId, true, sigmaSet);
+            std::vector<lelantus::PublicCoin> convertedSet;
+            sigmaState->GetConvertedAnonymitySet(denom, groupId, true, convertedSet);
+
+            BOOST_CHECK_EQUAL(sigmaSet.size(), 2);
+            BOOST_CHECK_EQUAL(convertedSet.size(), sigmaSet.size());
+            for (size_t i = 0; i < std::min(convertedSet.size(), sigmaSet.size()); i++)
+                BOOST_CHECK(convertedSet[i].getValue() == sigmaSet[i] + lelantusParams->get_h1() * intDenom);
+
+            BOOST_CHECK(sigmaState->GetConvertedSet(denom, groupId) == sigmaState->GetConvertedSet(denom, groupId));
+        }
+    }
+
     for(auto mint : vDMints)
         pwalletMain->zwallet->GetTracker().SetPubcoinNotUsed(primitives::GetPubCoinValueHash(mint.GetPubcoinValue()));
 
@@ -6,6 +6,7 @@
 #include "../sigma.h"
 #include "./test_bitcoin.h"
 #include "../wallet/wallet.h"
+#include "../streams.h"
 
 #include "test/fixtures.h"
 #include "test/testutil.h"
@@ -1040,6 +1041,78 @@ BOOST_AUTO_TEST_CASE(sigma_build_state_no_sigma)
     chainActive.SetTip(NULL);
 }
 
+BOOST_AUTO_TEST_CASE(sigma_snapshot)
+{
+    sigma::CSigmaState *sigmaState = sigma::CSigmaState::GetState();
+    auto params = sigma::Params::get_default();
+    chainActive.SetTip(NULL);
+
+    std::pair<sigma::CoinDenomination, int> denomination1Group1(sigma::CoinDenomination::SIGMA_DENOM_1, 1);
+    std::pair<sigma::CoinDenomination, int> denomination10Group1(sigma::CoinDenomination::SIGMA_DENOM_10, 1);
+
+    std::vector<CBlockIndex> indices;
+    indices.reserve(101);
+    for (int i = 0; i <= 100; i++) {
+        indices.emplace_back(CreateBlockIndex(i));
+        chainActive.SetTip(&indices.back());
+    }
+
+    // mints of two denominations over a few blocks and a spend
+    indices[1].sigmaMintedPubCoins[denomination1Group1] = getPubcoins(generateCoins(params, 10, sigma::CoinDenomination::SIGMA_DENOM_1));
+    indices[2].sigmaMintedPubCoins[denomination1Group1] = getPubcoins(generateCoins(params, 1, sigma::CoinDenomination::SIGMA_DENOM_1));
+    indices[2].sigmaMintedPubCoins[denomination10Group1] = getPubcoins(generateCoins(params, 5, sigma::CoinDenomination::SIGMA_DENOM_10));
+
+    secp_primitives::Scalar serial;
+    serial.randomize();
+    indices[3].sigmaSpentSerials.insert(std::make_pair(serial, sigma::CSpendCoinInfo::make(sigma::CoinDenomination::SIGMA_DENOM_1, 1)));
+
+    sigma::BuildSigmaStateFromIndex(&chainActive);
+
+    CAutoFile file(tmpfile(), SER_DISK, CLIENT_VERSION);
+    sigmaState->WriteSnapshot(file);
+    rewind(file.Get());
+
+    sigma::CSigmaState restored;
+    BOOST_CHECK(restored.ReadSnapshot(file, &chainActive));
+
+    BOOST_CHECK_EQUAL(sigmaState->IsSurgeConditionDetected(), restored.IsSurgeConditionDetected());
+    BOOST_CHECK(restored.IsUsedCoinSerial(serial));
+    BOOST_CHECK_EQUAL(sigmaState->GetSpends().size(), restored.GetSpends().size());
+
+    BOOST_CHECK_EQUAL(sigmaState->GetMints().size(), restored.GetMints().size());
+    for (auto const &mint : sigmaState->GetMints()) {
+        BOOST_CHECK(sigmaState->GetMintedCoinHeightAndId(mint.first) == restored.GetMintedCoinHeightAndId(mint.first));
+    }
+
+    for (auto denomination : {sigma::CoinDenomination::SIGMA_DENOM_1, sigma::CoinDenomination::SIGMA_DENOM_10}) {
+        BOOST_CHECK_EQUAL(sigmaState->GetLatestCoinID(denomination), restored.GetLatestCoinID(denomination));
+    }
+
+    BOOST_CHECK_EQUAL(sigmaState->GetCoinGroups().size(), restored.GetCoinGroups().size());
+    for (auto const &group : sigmaState->GetCoinGroups()) {
+        sigma::CSigmaState::SigmaCoinGroupInfo restoredGroup;
+        BOOST_CHECK(restored.GetCoinGroupInfo(group.first.first, group.first.second, restoredGroup));
+        BOOST_CHECK_EQUAL(group.second.firstBlock, restoredGroup.firstBlock);
+        BOOST_CHECK_EQUAL(group.second.lastBlock, restoredGroup.lastBlock);
+        BOOST_CHECK_EQUAL(group.second.nCoins, restoredGroup.nCoins);
+
+        uint256 blockHash, restoredBlockHash;
+        std::vector<sigma::PublicCoin> coins, restoredCoins;
+        BOOST_CHECK_EQUAL(
+            sigmaState->GetCoinSetForSpend(&chainActive, chainActive.Height(), group.first.first, group.first.second, blockHash, coins),
+            restored.GetCoinSetForSpend(&chainActive, chainActive.Height(), group.first.first, group.first.second, restoredBlockHash, restoredCoins));
+        BOOST_CHECK(blockHash == restoredBlockHash);
+        BOOST_CHECK(coins == restoredCoins);
+    }
+
+    // mints added to the chain after the snapshot was written are detected
+    indices[4].sigmaMintedPubCoins[denomination1Group1] = getPubcoins(generateCoins(params, 1, sigma::CoinDenomination::SIGMA_DENOM_1));
+    rewind(file.Get());
+    BOOST_CHECK(!restored.ReadSnapshot(file, &chainActive));
+
+    sigmaState->Reset();
+    chainActive.SetTip(NULL);
+}
 
 BOOST_AUTO_TEST_CASE(sigma_getcoinsetforspend)
 {
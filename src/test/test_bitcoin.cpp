@@ -13,6 +13,7 @@
 #include "util.h"
 #include "chainparams.h"
 #include "consensus/consensus.h"
+#include "crypto/sha256.h"
 #include "consensus/validation.h"
 #include "key.h"
 #include "validation.h"
@@ -25,6 +26,7 @@
 #include "ui_interface.h"
 #include "rpc/server.h"
 #include "rpc/register.h"
+#include "proofcache.h"
 #include "script/sigcache.h"
 #include "stacktraces.h"
 
@@ -58,10 +60,12 @@ extern CEvoDB* evoDb;
 
 BasicTestingSetup::BasicTestingSetup(const std::string& chainName)
 {
+    SHA256AutoDetect();
     ECC_Start();
     SetupEnvironment();
     SetupNetworking();
     InitSignatureCache();
+    InitProofCache();
     fPrintToDebugLog = false; // don't want to write to debug.log file
     fCheckBlockIndex = true;
     SelectParams(chainName);
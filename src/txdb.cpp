@@ -12,6 +12,7 @@
 #include "validation.h"
 #include "consensus/consensus.h"
 #include "base58.h"
+#include "proofthreadpool.h"
 
 #include <stdint.h>
 
@@ -33,6 +34,9 @@ static const char DB_REINDEX_FLAG = 'R';
 static const char DB_LAST_BLOCK = 'l';
 static const char DB_TOTAL_SUPPLY = 'S';
 
+// number of block index records decoded together when loading the index
+static const size_t BLOCK_INDEX_LOAD_BATCH_SIZE = 4096;
+
 namespace {
 
 struct CoinEntry {
@@ -355,63 +359,102 @@ bool CBlockTreeDB::LoadBlockIndexGuts(boost::function<CBlockIndex*(const uint256
 
     pcursor->Seek(std::make_pair(DB_BLOCK_INDEX, uint256()));
 
+    // Records are read from the db in order, decoding them (which decompresses every minted
+    // pubcoin) is done in batches on the proof threads
+    ProofThreadPool& threadPool = ProofThreadPool::GetInstance();
+    size_t nRecords = 0;
+    int64_t nTimeRead = 0, nTimeDecode = 0, nTimeIndex = 0;
+    bool fDone = false;
+
     // Load mapBlockIndex
-    while (pcursor->Valid()) {
-        boost::this_thread::interruption_point();
-        std::pair<char, uint256> key;
-        if (pcursor->GetKey(key) && key.first == DB_BLOCK_INDEX) {
-            CDiskBlockIndex diskindex;
-            if (pcursor->GetValue(diskindex)) {
-                // Construct block index object
-                CBlockIndex* pindexNew = insertBlockIndex(diskindex.GetBlockHash());
-                pindexNew->pprev          = insertBlockIndex(diskindex.hashPrev);
-                pindexNew->nHeight        = diskindex.nHeight;
-                pindexNew->nFile          = diskindex.nFile;
-                pindexNew->nDataPos       = diskindex.nDataPos;
-                pindexNew->nUndoPos       = diskindex.nUndoPos;
-                pindexNew->nVersion       = diskindex.nVersion;
-                pindexNew->hashMerkleRoot = diskindex.hashMerkleRoot;
-                pindexNew->nTime          = diskindex.nTime;
-                pindexNew->nBits          = diskindex.nBits;
-                pindexNew->nNonce         = diskindex.nNonce;
-                pindexNew->nStatus        = diskindex.nStatus;
-                pindexNew->nTx            = diskindex.nTx;
-
-                // Firo - ProgPoW
-                if (diskindex.nTime > ZC_GENESIS_BLOCK_TIME && diskindex.nTime >= consensusParams.nPPSwitchTime) {
-                    pindexNew->nNonce64 = diskindex.nNonce64;
-                    pindexNew->mix_hash = diskindex.mix_hash;
+    while (!fDone) {
+        int64_t nTimeStart = GetTimeMicros();
+        std::vector<CDataStream> values;
+        while (values.size() < BLOCK_INDEX_LOAD_BATCH_SIZE) {
+            boost::this_thread::interruption_point();
+            std::pair<char, uint256> key;
+            if (!pcursor->Valid() || !pcursor->GetKey(key) || key.first != DB_BLOCK_INDEX) {
+                fDone = true;
+                break;
+            }
+            values.push_back(pcursor->GetValueStream());
+            pcursor->Next();
+        }
+        int64_t nTimeRead1 = GetTimeMicros();
+        nTimeRead += nTimeRead1 - nTimeStart;
+
+        std::vector<CDiskBlockIndex> diskindexes(values.size());
+        std::vector<char> decoded(values.size(), 0);
+        size_t nChunks = std::min(values.size(), threadPool.GetNumberOfThreads());
+        std::vector<std::function<void()>> jobs;
+        for (size_t i = 0; i < nChunks; i++) {
+            jobs.emplace_back([&values, &diskindexes, &decoded, i, nChunks]() {
+                for (size_t j = values.size() * i / nChunks; j < values.size() * (i + 1) / nChunks; j++) {
+                    try {
+                        values[j] >> diskindexes[j];
+                        decoded[j] = 1;
+                    } catch (const std::exception&) {
+                    }
                 }
+            });
+        }
+        threadPool.RunAll(jobs);
+        int64_t nTimeDecode1 = GetTimeMicros();
+        nTimeDecode += nTimeDecode1 - nTimeRead1;
 
-                // Firo - MTP
-                else if (diskindex.nTime > ZC_GENESIS_BLOCK_TIME && diskindex.nTime >= consensusParams.nMTPSwitchTime) {
-                    pindexNew->nVersionMTP = diskindex.nVersionMTP;
-                    pindexNew->mtpHashValue = diskindex.mtpHashValue;
-                    pindexNew->reserved[0] = diskindex.reserved[0];
-                    pindexNew->reserved[1] = diskindex.reserved[1];
-                }
+        for (size_t i = 0; i < diskindexes.size(); i++) {
+            if (!decoded[i])
+                return error("LoadBlockIndex() : failed to read value");
 
-                pindexNew->sigmaMintedPubCoins   = diskindex.sigmaMintedPubCoins;
-                pindexNew->sigmaSpentSerials     = diskindex.sigmaSpentSerials;
+            const CDiskBlockIndex& diskindex = diskindexes[i];
+
+            // Construct block index object
+            CBlockIndex* pindexNew = insertBlockIndex(diskindex.GetBlockHash());
+            pindexNew->pprev          = insertBlockIndex(diskindex.hashPrev);
+            pindexNew->nHeight        = diskindex.nHeight;
+            pindexNew->nFile          = diskindex.nFile;
+            pindexNew->nDataPos       = diskindex.nDataPos;
+            pindexNew->nUndoPos       = diskindex.nUndoPos;
+            pindexNew->nVersion       = diskindex.nVersion;
+            pindexNew->hashMerkleRoot = diskindex.hashMerkleRoot;
+            pindexNew->nTime          = diskindex.nTime;
+            pindexNew->nBits          = diskindex.nBits;
+            pindexNew->nNonce         = diskindex.nNonce;
+            pindexNew->nStatus        = diskindex.nStatus;
+            pindexNew->nTx            = diskindex.nTx;
+
+            // Firo - ProgPoW
+            if (diskindex.nTime > ZC_GENESIS_BLOCK_TIME && diskindex.nTime >= consensusParams.nPPSwitchTime) {
+                pindexNew->nNonce64 = diskindex.nNonce64;
+                pindexNew->mix_hash = diskindex.mix_hash;
+            }
 
-                pindexNew->lelantusMintedPubCoins   = diskindex.lelantusMintedPubCoins;
-                pindexNew->lelantusSpentSerials     = diskindex.lelantusSpentSerials;
-                pindexNew->anonymitySetHash         = diskindex.anonymitySetHash;
+            // Firo - MTP
+            else if (diskindex.nTime > ZC_GENESIS_BLOCK_TIME && diskindex.nTime >= consensusParams.nMTPSwitchTime) {
+                pindexNew->nVersionMTP = diskindex.nVersionMTP;
+                pindexNew->mtpHashValue = diskindex.mtpHashValue;
+                pindexNew->reserved[0] = diskindex.reserved[0];
+                pindexNew->reserved[1] = diskindex.reserved[1];
+            }
 
-                pindexNew->activeDisablingSporks = diskindex.activeDisablingSporks;
+            pindexNew->sigmaMintedPubCoins   = std::move(diskindexes[i].sigmaMintedPubCoins);
+            pindexNew->sigmaSpentSerials     = std::move(diskindexes[i].sigmaSpentSerials);
 
-                if (!CheckProofOfWork(pindexNew->GetBlockPoWHash(), pindexNew->nBits, consensusParams))
-                    return error("LoadBlockIndex(): CheckProofOfWork failed: %s", pindexNew->ToString());
+            pindexNew->lelantusMintedPubCoins   = std::move(diskindexes[i].lelantusMintedPubCoins);
+            pindexNew->lelantusSpentSerials     = std::move(diskindexes[i].lelantusSpentSerials);
+            pindexNew->anonymitySetHash         = std::move(diskindexes[i].anonymitySetHash);
 
-                pcursor->Next();
-            } else {
-                return error("LoadBlockIndex() : failed to read value");
-            }
-        } else {
-            break;
+            pindexNew->activeDisablingSporks = diskindex.activeDisablingSporks;
+
+            if (!CheckProofOfWork(pindexNew->GetBlockPoWHash(), pindexNew->nBits, consensusParams))
+                return error("LoadBlockIndex(): CheckProofOfWork failed: %s", pindexNew->ToString());
         }
+        nTimeIndex += GetTimeMicros() - nTimeDecode1;
+        nRecords += diskindexes.size();
     }
 
+    LogPrintf("%s: %u records, read %.2fs, decode %.2fs (%u threads), index %.2fs\n", __func__, nRecords,
+        nTimeRead * 0.000001, nTimeDecode * 0.000001, threadPool.GetNumberOfThreads(), nTimeIndex * 0.000001);
     return true;
 }
 
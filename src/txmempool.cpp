@@ -346,7 +346,7 @@ void CTxMemPoolEntry::UpdateAncestorState(int64_t modifySize, CAmount modifyFee,
 }
 
 CTxMemPool::CTxMemPool(const CFeeRate& _minReasonableRelayFee) :
-    nTransactionsUpdated(0)
+    nTransactionsUpdated(0), nTransactionsRemoved(0)
 {
     _clear(); //lock free clear
 
@@ -389,6 +389,12 @@ void CTxMemPool::AddTransactionsUpdated(unsigned int n)
     nTransactionsUpdated += n;
 }
 
+unsigned int CTxMemPool::GetTransactionsRemoved() const
+{
+    LOCK(cs);
+    return nTransactionsRemoved;
+}
+
 bool CTxMemPool::addUnchecked(const uint256& hash, const CTxMemPoolEntry &entry, setEntries &setAncestors, bool validFeeEstimate)
 {
     NotifyEntryAdded(entry.GetSharedTx());
@@ -618,6 +624,7 @@ void CTxMemPool::removeUnchecked(txiter it, MemPoolRemovalReason reason)
     mapLinks.erase(it);
     mapTx.erase(it);
     nTransactionsUpdated++;
+    nTransactionsRemoved++;
     minerPolicyEstimator->removeTx(hash);
 }
 
@@ -1076,6 +1083,7 @@ void CTxMemPool::_clear()
     rollingMinimumFeeRate = 0;
     lelantusState.Reset();
     ++nTransactionsUpdated;
+    ++nTransactionsRemoved;
 }
 
 void CTxMemPool::clear()
@@ -1482,6 +1490,7 @@ void CTxMemPool::PrioritiseTransaction(const uint256 hash, const std::string str
                 mapTx.modify(descendantIt, update_ancestor_state(0, nFeeDelta, 0, 0));
             }
             ++nTransactionsUpdated;
+            ++nTransactionsRemoved;
         }
     }
     LogPrintf("PrioritiseTransaction: %s priority += %f, fee += %d\n", strHash, dPriorityDelta, FormatMoney(nFeeDelta));
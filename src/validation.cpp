@@ -40,6 +40,7 @@
 #include "wallet/wallet.h"
 #include "wallet/walletdb.h"
 #include "batchproof_container.h"
+#include "proofthreadpool.h"
 #include "sigma.h"
 #include "lelantus.h"
 #include "utilmoneystr.h"
@@ -823,7 +824,7 @@ bool AcceptToMemoryPoolWorker(CTxMemPool& pool, CValidationState& state, const C
             if (tx.vin.size() > 1) {
                 return state.Invalid(false, REJECT_CONFLICT, "txn-invalid-lelantus-joinsplit");
             }
-            std::unique_ptr<lelantus::JoinSplit> joinsplit;
+            std::shared_ptr<const lelantus::JoinSplit> joinsplit;
 
             try {
                 joinsplit = lelantus::ParseLelantusJoinSplit(tx);
@@ -2746,6 +2747,13 @@ bool ConnectBlock(const CBlock& block, CValidationState& state, CBlockIndex* pin
     // batch verify Lelantus/Sigma if block is older than a day, that means we are syncing or reindexing
     BatchProofContainer* batchProofContainer = BatchProofContainer::get_instance();
     batchProofContainer->fCollectProofs = ((GetSystemTimeInSeconds() - pindex->GetBlockTime()) > 86400) && GetBoolArg("-batching", true);
+    // otherwise verify the privacy proofs on the proof threads while the rest of the block is checked
+    batchProofContainer->fDeferProofs = !batchProofContainer->fCollectProofs && GetBoolArg("-parallelproofs", DEFAULT_PARALLEL_PROOFS);
+    // disarm on every way out, other CheckTransaction callers must not have their proofs deferred
+    struct DeferProofsReset {
+        BatchProofContainer* container;
+        ~DeferProofsReset() { container->fDeferProofs = false; }
+    } deferProofsReset{batchProofContainer};
     batchProofContainer->init();
 
     block.sigmaTxInfo = std::make_shared<sigma::CSigmaTxInfo>();
@@ -2863,6 +2871,12 @@ bool ConnectBlock(const CBlock& block, CValidationState& state, CBlockIndex* pin
     int64_t nTime3 = GetTimeMicros(); nTimeConnect += nTime3 - nTime2;
     LogPrint("bench", "      - Connect %u transactions: %.2fms (%.3fms/tx, %.3fms/txin) [%.2fs]\n", (unsigned)block.vtx.size(), 0.001 * (nTime3 - nTime2), 0.001 * (nTime3 - nTime2) / block.vtx.size(), nInputs <= 1 ? 0 : 0.001 * (nTime3 - nTime2) / (nInputs-1), nTimeConnect * 0.000001);
 
+    bool fProofsValid = batchProofContainer->wait_deferred();
+    batchProofContainer->fDeferProofs = false;
+    if (!fProofsValid)
+        return state.DoS(100, error("ConnectBlock(): privacy proof verification failed"),
+                         REJECT_INVALID, "bad-txns-zerocoin");
+
     if (!control.Wait())
         return state.DoS(100, false);
     int64_t nTime4 = GetTimeMicros(); nTimeVerify += nTime4 - nTime2;
@@ -3317,7 +3331,7 @@ bool static DisconnectTip(CValidationState& state, const CChainParams& chainpara
             false, false, block.sigmaTxInfo.get(), block.lelantusTxInfo.get());
         if(GetBoolArg("-batching", true)) {
             if (tx->IsLelantusJoinSplit()) {
-                std::unique_ptr<lelantus::JoinSplit> joinsplit;
+                std::shared_ptr<const lelantus::JoinSplit> joinsplit;
 
                 try {
                     joinsplit = lelantus::ParseLelantusJoinSplit(*tx);
@@ -3339,12 +3353,12 @@ bool static DisconnectTip(CValidationState& state, const CChainParams& chainpara
 
                 rangeProofsToRemove.push_back(joinsplit->getLelantusProof().bulletproofs);
             } else if (tx->IsSigmaSpend()) {
-                for (const CTxIn &txin : tx->vin) {
-                    std::unique_ptr<sigma::CoinSpend> spend;
+                for (size_t i = 0; i < tx->vin.size(); i++) {
+                    std::shared_ptr<const sigma::CoinSpend> spend;
                     uint32_t coinGroupId;
 
                     try {
-                        std::tie(spend, coinGroupId) = sigma::ParseSigmaSpend(txin);
+                        std::tie(spend, coinGroupId) = sigma::ParseSigmaSpend(*tx, i);
                     }
                     catch (CBadTxIn &) {
                         continue;
@@ -4293,18 +4307,10 @@ bool CheckBlockHeader(const CBlockHeader& block, CValidationState& state, const
 
     if (fCheckPOW)
     {
-        uint256 final_hash;
-        if (block.IsProgPow())
-        {
-            // If we use GetProgPowHashFull user may experience very slow header sync
-            // We use simplified function for header check and then will use full check in ConnectBlock()
-            // This won't make sync faster but it will give user a better experience
-            final_hash = block.GetProgPowHashLight();
-        }
-        else
-        {
-            final_hash = block.GetPoWHash(nHeight);
-        }
+        // For ProgPoW this is the light hash: if we use GetProgPowHashFull user may experience very slow
+        // header sync. We use simplified function for header check and then will use full check in ConnectBlock()
+        // The hash may have been computed already by PrecomputeHeadersPoW()
+        uint256 final_hash = block.GetPoWHash(nHeight);
         if (!CheckProofOfWork(final_hash, block.nBits, consensusParams))
         {
             return state.DoS(50, false, REJECT_INVALID, "high-hash", false, "proof of work failed");
@@ -4739,9 +4745,53 @@ static bool AcceptBlockHeader(const CBlockHeader& block, CValidationState& state
     return true;
 }
 
+/**
+ * Compute the PoW hashes of a run of connected headers on the proof threads, ahead of
+ * AcceptBlockHeader. The hashes land in cachedPoWHash so CheckBlockHeader doesn't do the memory-hard
+ * hashing one header at a time under cs_main. Headers that are already known are skipped, and
+ * nothing is done unless the parent of the first header is known, as the heights are needed.
+ */
+static void PrecomputeHeadersPoW(const std::vector<CBlockHeader>& headers)
+{
+    std::vector<std::pair<const CBlockHeader*, int>> toHash;
+    {
+        LOCK(cs_main);
+        BlockMap::iterator mi = mapBlockIndex.find(headers[0].hashPrevBlock);
+        if (mi == mapBlockIndex.end())
+            return;
+        int nHeight = mi->second->nHeight;
+        uint256 hashPrev = headers[0].hashPrevBlock;
+        for (const CBlockHeader& header : headers) {
+            if (header.hashPrevBlock != hashPrev)
+                break;
+            hashPrev = header.GetHash();
+            ++nHeight;
+            if (header.cachedPoWHash.IsNull() && mapBlockIndex.count(hashPrev) == 0)
+                toHash.emplace_back(&header, nHeight);
+        }
+    }
+
+    ProofThreadPool& threadPool = ProofThreadPool::GetInstance();
+    size_t nChunks = std::min(toHash.size(), threadPool.GetNumberOfThreads());
+    if (nChunks < 2)
+        return;
+
+    std::vector<std::function<void()>> jobs;
+    for (size_t i = 0; i < nChunks; i++) {
+        jobs.emplace_back([&toHash, i, nChunks]() {
+            for (size_t j = toHash.size() * i / nChunks; j < toHash.size() * (i + 1) / nChunks; j++)
+                toHash[j].first->GetPoWHash(toHash[j].second);
+        });
+    }
+    threadPool.RunAll(jobs);
+}
+
 // Exposed wrapper for AcceptBlockHeader
 bool ProcessNewBlockHeaders(const std::vector<CBlockHeader>& headers, CValidationState& state, const CChainParams& chainparams, const CBlockIndex** ppindex)
 {
+    if (headers.size() > 1)
+        PrecomputeHeadersPoW(headers);
+
     {
         LOCK(cs_main);
         for (const CBlockHeader& header : headers) {
@@ -5106,10 +5156,12 @@ CBlockIndex * InsertBlockIndex(uint256 hash)
 bool static LoadBlockIndexDB(const CChainParams& chainparams)
 {
     LogPrintf("LoadBlockIndexDB\n");
+    int64_t nStart = GetTimeMillis();
     if (!pblocktree->LoadBlockIndexGuts(InsertBlockIndex))
         return false;
 
     boost::this_thread::interruption_point();
+    int64_t nTimeGuts = GetTimeMillis();
 
     // Calculate nChainWork
     std::vector<std::pair<int, CBlockIndex*> > vSortedByHeight;
@@ -5153,6 +5205,7 @@ bool static LoadBlockIndexDB(const CChainParams& chainparams)
         if (pindex->IsValid(BLOCK_VALID_TREE) && (pindexBestHeader == NULL || CBlockIndexWorkComparator()(pindexBestHeader, pindex)))
             pindexBestHeader = pindex;
     }
+    LogPrintf("%s: block index records loaded in %dms, chain work computed in %dms\n", __func__, nTimeGuts - nStart, GetTimeMillis() - nTimeGuts);
 
     // Load block file info
     pblocktree->ReadLastBlockFile(nLastBlockFile);
@@ -5224,8 +5277,12 @@ bool static LoadBlockIndexDB(const CChainParams& chainparams)
 
     PruneBlockIndexCandidates();
 
-    sigma::BuildSigmaStateFromIndex(&chainActive);
-    lelantus::BuildLelantusStateFromIndex(&chainActive);
+    if (!LoadPrivacyState()) {
+        sigma::CSigmaState::GetState()->Reset();
+        lelantus::CLelantusState::GetState()->Reset();
+        sigma::BuildSigmaStateFromIndex(&chainActive);
+        lelantus::BuildLelantusStateFromIndex(&chainActive);
+    }
 
     // Initialize MTP state
     MTPState::GetMTPState()->InitializeFromChain(&chainActive, chainparams.GetConsensus());
@@ -5957,6 +6014,77 @@ void DumpMempool(void)
     }
 }
 
+static const uint64_t PRIVACY_STATE_DUMP_VERSION = 1;
+
+bool LoadPrivacyState()
+{
+    FILE* filestr = fopen((GetDataDir() / "privacystate.dat").string().c_str(), "rb");
+    CAutoFile file(filestr, SER_DISK, CLIENT_VERSION);
+    if (file.IsNull() || chainActive.Tip() == NULL) {
+        return false;
+    }
+
+    int64_t nStart = GetTimeMillis();
+
+    try {
+        uint64_t version;
+        int nClientVersion;
+        uint256 hashTip;
+        file >> version;
+        file >> nClientVersion;
+        file >> hashTip;
+        if (version != PRIVACY_STATE_DUMP_VERSION || nClientVersion != CLIENT_VERSION || hashTip != chainActive.Tip()->GetBlockHash()) {
+            LogPrintf("Privacy state on disk is stale, rebuilding it from the block index\n");
+            return false;
+        }
+
+        if (!sigma::CSigmaState::GetState()->ReadSnapshot(file, &chainActive)
+                || !lelantus::CLelantusState::GetState()->ReadSnapshot(file, &chainActive)) {
+            LogPrintf("Privacy state on disk does not match the block index, rebuilding it\n");
+            return false;
+        }
+    } catch (const std::exception& e) {
+        LogPrintf("Failed to deserialize privacy state on disk: %s. Rebuilding it from the block index.\n", e.what());
+        return false;
+    }
+
+    LogPrintf("Loaded privacy state from disk: %dms\n", GetTimeMillis() - nStart);
+    return true;
+}
+
+void DumpPrivacyState()
+{
+    AssertLockHeld(cs_main);
+
+    if (chainActive.Tip() == NULL) {
+        return;
+    }
+
+    int64_t nStart = GetTimeMillis();
+
+    try {
+        FILE* filestr = fopen((GetDataDir() / "privacystate.dat.new").string().c_str(), "wb");
+        if (!filestr) {
+            return;
+        }
+
+        CAutoFile file(filestr, SER_DISK, CLIENT_VERSION);
+
+        file << PRIVACY_STATE_DUMP_VERSION;
+        file << CLIENT_VERSION;
+        file << chainActive.Tip()->GetBlockHash();
+        sigma::CSigmaState::GetState()->WriteSnapshot(file);
+        lelantus::CLelantusState::GetState()->WriteSnapshot(file);
+
+        FileCommit(file.Get());
+        file.fclose();
+        RenameOver(GetDataDir() / "privacystate.dat.new", GetDataDir() / "privacystate.dat");
+        LogPrintf("Dumped privacy state: %dms\n", GetTimeMillis() - nStart);
+    } catch (const std::exception& e) {
+        LogPrintf("Failed to dump privacy state: %s. Continuing anyway.\n", e.what());
+    }
+}
+
 //! Guess how far we are in the verification process at the given block index
 double GuessVerificationProgress(const ChainTxData& data, CBlockIndex *pindex) {
     if (pindex == NULL)
@@ -90,6 +90,12 @@ static const unsigned int UNDOFILE_CHUNK_SIZE = 0x100000; // 1 MiB
 static const int MAX_SCRIPTCHECK_THREADS = 16;
 /** -par default (number of script-checking threads, 0 = auto) */
 static const int DEFAULT_SCRIPTCHECK_THREADS = 0;
+/** Maximum number of privacy proof verification threads allowed */
+static const int MAX_PROOF_THREADS = 64;
+/** -proofthreads default (number of privacy proof verification threads, 0 = auto) */
+static const int DEFAULT_PROOF_THREADS = 0;
+/** -parallelproofs default (verify the privacy proofs of a block at the tip on the proof threads) */
+static const bool DEFAULT_PARALLEL_PROOFS = true;
 /** Number of blocks that can be requested at any given time from a single peer. */
 static const int MAX_BLOCKS_IN_TRANSIT_PER_PEER = 16;
 /** Timeout in seconds during which a peer must stall block download progress before being disconnected. */
@@ -647,4 +653,10 @@ void DumpMempool();
 /** Load the mempool from disk. */
 bool LoadMempool();
 
+/** Dump the sigma and Lelantus state of the chain tip to disk. */
+void DumpPrivacyState();
+
+/** Load the sigma and Lelantus state of the chain tip from disk, false if it is missing or stale. */
+bool LoadPrivacyState();
+
 #endif // BITCOIN_VALIDATION_H
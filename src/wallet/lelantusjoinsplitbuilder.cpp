@@ -524,24 +524,17 @@ void LelantusJoinSplitBuilder::CreateJoinSplit(
 
 
         if (anonymity_sets.count(denom / 1000 + groupId) == 0) {
-            std::vector<sigma::PublicCoin> group;
-            uint256 blockHash;
-            if (sigmaState->GetCoinSetForSpend(
-                    &chainActive,
-                    chainActive.Height() - (ZC_MINT_CONFIRMATIONS - 1), // required 1 confirmation for mint to spend
-                    spend.get_denomination(),
-                    groupId,
-                    blockHash,
-                    group) < 2)
+            // the coins of the group are converted once and shared with validation
+            auto convertedSet = sigmaState->GetConvertedSet(spend.get_denomination(), groupId);
+            auto lastBlock = convertedSet ? convertedSet->GetLastBlock(chainActive.Height() - (ZC_MINT_CONFIRMATIONS - 1)) : nullptr; // required 1 confirmation for mint to spend
+            sigma::CSigmaState::ConvertedSet::const_iterator setBegin, setEnd;
+            if (lastBlock)
+                std::tie(setBegin, setEnd) = convertedSet->GetCoins(*lastBlock, chainActive.Height() >= ::Params().GetConsensus().nStartSigmaBlacklist);
+            if (!lastBlock || setEnd - setBegin < 2)
                 throw std::runtime_error(
                         _("Has to have at least two mint coins with at least 1 confirmation in order to spend a coin"));
-            std::vector<lelantus::PublicCoin> set;
-            set.reserve(group.size());
-            for(auto& coin : group) {
-                set.push_back(coin.getValue() + params->get_h1() * denom);
-            }
-            groupBlockHashes[denom / 1000 + groupId] = blockHash;
-            anonymity_sets[denom / 1000 + groupId] = set;
+            groupBlockHashes[denom / 1000 + groupId] = lastBlock->block->GetBlockHash();
+            anonymity_sets[denom / 1000 + groupId].assign(setBegin, setEnd);
         }
 
     }
@@ -4103,7 +4103,7 @@ UniValue listlelantusjoinsplits(const JSONRPCRequest& request) {
         entry.push_back(Pair("abandoned", pwtx->isAbandoned()));
 
         UniValue spends(UniValue::VARR);
-        std::unique_ptr<lelantus::JoinSplit> joinsplit;
+        std::shared_ptr<const lelantus::JoinSplit> joinsplit;
         try {
             joinsplit = lelantus::ParseLelantusJoinSplit(*pwtx->tx);
         } catch (...) {
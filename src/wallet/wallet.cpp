@@ -1425,7 +1425,7 @@ bool CWallet::AbandonTransaction(const uint256& hashTx)
             // find out coin serial number
             assert(wtx.tx->vin.size() == 1);
 
-            std::unique_ptr<lelantus::JoinSplit> joinsplit;
+            std::shared_ptr<const lelantus::JoinSplit> joinsplit;
             try {
                 joinsplit = lelantus::ParseLelantusJoinSplit(*wtx.tx);
             }
@@ -1590,7 +1590,7 @@ isminetype CWallet::IsMine(const CTxIn &txin, const CTransaction& tx) const
         }
     } else if (txin.IsLelantusJoinSplit()) {
         CWalletDB db(strWalletFile);
-        std::unique_ptr<lelantus::JoinSplit> joinsplit;
+        std::shared_ptr<const lelantus::JoinSplit> joinsplit;
         try {
             joinsplit = lelantus::ParseLelantusJoinSplit(tx);
         }
@@ -1632,10 +1632,18 @@ CAmount CWallet::GetDebit(const CTxIn &txin, const CTransaction& tx, const ismin
         }
 
         CWalletDB db(strWalletFile);
-        std::unique_ptr<sigma::CoinSpend> spend;
+        std::shared_ptr<const sigma::CoinSpend> spend;
+
+        // txin is one of the inputs of tx, parse it through tx so the proof is decoded only once
+        size_t nIn = 0;
+        while (nIn < tx.vin.size() && &tx.vin[nIn] != &txin)
+            nIn++;
 
         try {
-            std::tie(spend, std::ignore) = sigma::ParseSigmaSpend(txin);
+            if (nIn < tx.vin.size())
+                std::tie(spend, std::ignore) = sigma::ParseSigmaSpend(tx, nIn);
+            else
+                std::tie(spend, std::ignore) = sigma::ParseSigmaSpend(txin);
         } catch (CBadTxIn&) {
             goto end;
         }
@@ -1651,7 +1659,7 @@ CAmount CWallet::GetDebit(const CTxIn &txin, const CTransaction& tx, const ismin
         }
 
         CWalletDB db(strWalletFile);
-        std::unique_ptr<lelantus::JoinSplit> joinsplit;
+        std::shared_ptr<const lelantus::JoinSplit> joinsplit;
         try {
             joinsplit = lelantus::ParseLelantusJoinSplit(tx);
         }